@@ -1916,3 +1916,44 @@ gnc_parse_time_to_time64 (const gchar *s, const gchar *format)
     return gnc_mktime(&tm);
 }
 
+
+static gint
+time64_compare (gconstpointer a, gconstpointer b)
+{
+    time64 ta = *(const time64*)a, tb = *(const time64*)b;
+    return (ta > tb) - (ta < tb);
+}
+
+SCM
+gnc_account_get_balances_at_dates (Account *acc, SCM dates_scm,
+                                   gboolean ignore_closing,
+                                   gnc_commodity *report_commodity,
+                                   gboolean include_children)
+{
+    SCM result = SCM_EOL;
+    long n_dates = scm_ilength (dates_scm);
+    time64 *dates;
+    gnc_numeric *balances;
+    long i;
+
+    if (n_dates <= 0)
+        return SCM_EOL;
+
+    dates = g_new (time64, n_dates);
+    balances = g_new (gnc_numeric, n_dates);
+
+    for (i = 0; i < n_dates; i++, dates_scm = SCM_CDR (dates_scm))
+        dates[i] = scm_to_int64 (SCM_CAR (dates_scm));
+    qsort (dates, n_dates, sizeof (time64), time64_compare);
+
+    xaccAccountGetBalancesAsOfDates (acc, dates, n_dates, ignore_closing,
+                                     report_commodity, include_children,
+                                     balances);
+
+    for (i = n_dates - 1; i >= 0; i--)
+        result = scm_cons (gnc_numeric_to_scm (balances[i]), result);
+
+    g_free (balances);
+    g_free (dates);
+    return result;
+}
@@ -59,6 +59,14 @@ SCM gnc_book_to_scm (const QofBook *book);
 GncAccountValue * gnc_scm_to_account_value_ptr (SCM valuearg);
 SCM gnc_account_value_ptr_to_scm (GncAccountValue *);
 
+/** Get the balances of an account at each of a list of dates, see
+ *  xaccAccountGetBalancesAsOfDates(). The dates are sorted first and the
+ *  result is a list of numbers in the order of the sorted dates. */
+SCM gnc_account_get_balances_at_dates (Account *acc, SCM dates,
+                                       gboolean ignore_closing,
+                                       gnc_commodity *report_commodity,
+                                       gboolean include_children);
+
 /**
  * add Scheme-style danglers from a hook
  */
@@ -519,6 +519,9 @@ search_update_query (GNCSearchWindow *sw)
         active_params = NULL;
     }
 
+    /* Let an SQL backend preselect the matches in the database. */
+    qof_query_set_backend_search (new_q, TRUE);
+
     /* Destroy the old query */
     if (sw->q)
         qof_query_destroy (sw->q);
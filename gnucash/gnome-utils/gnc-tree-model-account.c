@@ -39,6 +39,7 @@
 #include "gnc-engine.h"
 #include "gnc-event.h"
 #include "gnc-gobject-utils.h"
+#include "gnc-pricedb.h"
 #include "gnc-ui-balances.h"
 #include "gnc-ui-util.h"
 
@@ -103,9 +104,34 @@ typedef struct GncTreeModelAccountPrivate
 
 } GncTreeModelAccountPrivate;
 
+/** The string values of the columns of one account that have been
+ *  computed since the account or its prices last changed. */
+typedef struct
+{
+    gboolean cached[GNC_TREE_MODEL_ACCOUNT_NUM_COLUMNS];
+    gchar *values[GNC_TREE_MODEL_ACCOUNT_NUM_COLUMNS];
+} AccountValues;
+
 #define GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(o)  \
    ((GncTreeModelAccountPrivate*)g_type_instance_get_private ((GTypeInstance*)o, GNC_TYPE_TREE_MODEL_ACCOUNT))
 
+static void
+account_values_free (AccountValues *values)
+{
+    for (gint col = 0; col < GNC_TREE_MODEL_ACCOUNT_NUM_COLUMNS; col++)
+        g_free (values->values[col]);
+    g_free (values);
+}
+
+/** Create the cache of column values, keyed by account guid. */
+static GHashTable *
+account_values_hash_new (void)
+{
+    return g_hash_table_new_full (guid_hash_to_guint, guid_g_hash_table_equal,
+                                  (GDestroyNotify) guid_free,
+                                  (GDestroyNotify) account_values_free);
+}
+
 
 /************************************************************/
 /*           Account Tree Model - Misc Functions            */
@@ -131,8 +157,7 @@ gnc_tree_model_account_update_color (gpointer gsettings, gchar *key, gpointer us
 
     // destroy/recreate the cached account value hash to force update
     g_hash_table_destroy (priv->account_values_hash);
-    priv->account_values_hash = g_hash_table_new_full (g_str_hash, g_str_equal,
-                                                       g_free, g_free);
+    priv->account_values_hash = account_values_hash_new ();
 
     use_red = gnc_prefs_get_bool (GNC_PREFS_GROUP_GENERAL, GNC_PREF_NEGATIVE_IN_RED);
 
@@ -198,8 +223,7 @@ gnc_tree_model_account_init (GncTreeModelAccount *model)
         priv->negative_color = NULL;
 
     // create the account values cache hash
-    priv->account_values_hash = g_hash_table_new_full (g_str_hash, g_str_equal,
-                                                       g_free, g_free);
+    priv->account_values_hash = account_values_hash_new ();
 
     gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_NEGATIVE_IN_RED,
                            gnc_tree_model_account_update_color,
@@ -603,8 +627,7 @@ gnc_tree_model_account_clear_cache (GncTreeModelAccount *model)
 
         // destroy the cached account values and recreate
         g_hash_table_destroy (priv->account_values_hash);
-        priv->account_values_hash = g_hash_table_new_full (g_str_hash, g_str_equal,
-                                                           g_free, g_free);
+        priv->account_values_hash = account_values_hash_new ();
 
         gtk_tree_model_foreach (GTK_TREE_MODEL(model), row_changed_foreach_func, NULL);
     }
@@ -614,7 +637,6 @@ static void
 clear_account_cached_values (GncTreeModelAccount *model, GHashTable *hash, Account *account)
 {
     GtkTreeIter iter;
-    gchar acct_guid_str[GUID_ENCODING_LENGTH + 1];
 
     if (!account)
         return;
@@ -628,16 +650,7 @@ clear_account_cached_values (GncTreeModelAccount *model, GHashTable *hash, Accou
         gtk_tree_path_free (path);
     }
 
-    guid_to_string_buff (xaccAccountGetGUID (account), acct_guid_str);
-
-    // loop over the columns and remove any found
-    for (gint col = 0; col <= GNC_TREE_MODEL_ACCOUNT_NUM_COLUMNS; col++)
-    {
-        gchar *key = g_strdup_printf ("%s,%d", acct_guid_str, col);
-
-        g_hash_table_remove (hash, key);
-        g_free (key);
-    }
+    g_hash_table_remove (hash, xaccAccountGetGUID (account));
 }
 
 static void
@@ -661,54 +674,105 @@ gnc_tree_model_account_clear_cached_values (GncTreeModelAccount *model, Account
     }
 }
 
+/** A price change alters the balances in currency of the accounts in
+ *  either of its commodities and the totals of all their ancestors, so
+ *  clear the cached values of those. Each ancestor is cleared once
+ *  however many of its descendants are affected. */
+static void
+gnc_tree_model_account_clear_price_cached_values (GncTreeModelAccount *model,
+                                                  GNCPrice *price)
+{
+    GncTreeModelAccountPrivate *priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+    gnc_commodity *commodity = gnc_price_get_commodity (price);
+    gnc_commodity *currency = gnc_price_get_currency (price);
+    GHashTable *cleared = g_hash_table_new (g_direct_hash, g_direct_equal);
+    GList *accounts = gnc_account_get_descendants (priv->root);
+
+    for (GList *node = accounts; node; node = g_list_next (node))
+    {
+        Account *account = node->data;
+        gnc_commodity *acct_comm = xaccAccountGetCommodity (account);
+
+        if (!gnc_commodity_equal (acct_comm, commodity) &&
+            !gnc_commodity_equal (acct_comm, currency))
+            continue;
+
+        for (; account && !g_hash_table_contains (cleared, account);
+             account = gnc_account_get_parent (account))
+        {
+            g_hash_table_add (cleared, account);
+            clear_account_cached_values (model, priv->account_values_hash, account);
+        }
+    }
+    g_list_free (accounts);
+    g_hash_table_destroy (cleared);
+}
+
 static gboolean
 gnc_tree_model_account_get_cached_value (GncTreeModelAccount *model, Account *account,
                                          gint column, gchar **cached_string)
 {
     GncTreeModelAccountPrivate *priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
-    gchar acct_guid_str[GUID_ENCODING_LENGTH + 1];
-    gchar *key = NULL;
-    gpointer value;
-    gboolean found;
+    AccountValues *values;
 
     if ((!priv->account_values_hash) || (!account))
         return FALSE;
 
-    guid_to_string_buff (xaccAccountGetGUID (account), acct_guid_str);
-    key = g_strdup_printf ("%s,%d", acct_guid_str, column);
-
-    found = g_hash_table_lookup_extended (priv->account_values_hash, key,
-                                          NULL, &value);
-
-     if (found)
-         *cached_string = g_strdup (value);
-
-    g_free (key);
+    values = g_hash_table_lookup (priv->account_values_hash,
+                                  xaccAccountGetGUID (account));
+    if (!values || !values->cached[column])
+        return FALSE;
 
-    return found;
+    *cached_string = g_strdup (values->values[column]);
+    return TRUE;
 }
 
 static void
-gnc_tree_model_account_set_cached_value (GncTreeModelAccount *model, Account *account,
-                                         gint column, GValue *value)
+gnc_tree_model_account_set_cached_string (GncTreeModelAccount *model, Account *account,
+                                          gint column, const gchar *str)
 {
     GncTreeModelAccountPrivate *priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+    const GncGUID *guid;
+    AccountValues *values;
 
     if ((!priv->account_values_hash) || (!account))
         return;
 
+    guid = xaccAccountGetGUID (account);
+    values = g_hash_table_lookup (priv->account_values_hash, guid);
+    if (!values)
+    {
+        values = g_new0 (AccountValues, 1);
+        g_hash_table_insert (priv->account_values_hash, guid_copy (guid), values);
+    }
+
+    g_free (values->values[column]);
+    values->values[column] = g_strdup (str);
+    values->cached[column] = TRUE;
+}
+
+static void
+gnc_tree_model_account_set_cached_value (GncTreeModelAccount *model, Account *account,
+                                         gint column, GValue *value)
+{
     // only interested in string values
     if (G_VALUE_HOLDS_STRING(value))
-    {
-        gchar acct_guid_str[GUID_ENCODING_LENGTH + 1];
-        const gchar *str = g_value_get_string (value);
-        gchar *key = NULL;
+        gnc_tree_model_account_set_cached_string (model, account, column,
+                                                  g_value_get_string (value));
+}
 
-        guid_to_string_buff (xaccAccountGetGUID (account), acct_guid_str);
-        key = g_strdup_printf ("%s,%d", acct_guid_str, column);
+/** A balance column and its color column are computed from the same
+ *  balance, so whichever of them is asked for first fills in both. */
+static void
+gnc_tree_model_account_cache_balance (GncTreeModelAccount *model, Account *account,
+                                      gint column, gint color_column,
+                                      const gchar *string, gboolean negative)
+{
+    GncTreeModelAccountPrivate *priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
 
-        g_hash_table_insert (priv->account_values_hash, key, g_strdup (str));
-    }
+    gnc_tree_model_account_set_cached_string (model, account, column, string);
+    gnc_tree_model_account_set_cached_string (model, account, color_column,
+                                              negative ? priv->negative_color : NULL);
 }
 
 static void
@@ -778,6 +842,10 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
         g_value_init (value, G_TYPE_STRING);
         string = gnc_ui_account_get_print_balance (xaccAccountGetPresentBalanceInCurrency,
                  account, TRUE, &negative);
+        gnc_tree_model_account_cache_balance (model, account,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_PRESENT,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_COLOR_PRESENT,
+                                              string, negative);
         g_value_take_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_PRESENT_REPORT:
@@ -790,6 +858,10 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
         g_value_init (value, G_TYPE_STRING);
         string = gnc_ui_account_get_print_balance (xaccAccountGetPresentBalanceInCurrency,
                  account, TRUE, &negative);
+        gnc_tree_model_account_cache_balance (model, account,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_PRESENT,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_COLOR_PRESENT,
+                                              string, negative);
         gnc_tree_model_account_set_color (model, negative, value);
         g_free (string);
         break;
@@ -798,6 +870,10 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
         g_value_init (value, G_TYPE_STRING);
         string = gnc_ui_account_get_print_balance (xaccAccountGetBalanceInCurrency,
                  account, FALSE, &negative);
+        gnc_tree_model_account_cache_balance (model, account,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_BALANCE,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_COLOR_BALANCE,
+                                              string, negative);
         g_value_take_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_BALANCE_REPORT:
@@ -810,17 +886,29 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
         g_value_init (value, G_TYPE_STRING);
         string = gnc_ui_account_get_print_balance (xaccAccountGetBalanceInCurrency,
                  account, FALSE, &negative);
+        gnc_tree_model_account_cache_balance (model, account,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_BALANCE,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_COLOR_BALANCE,
+                                              string, negative);
         gnc_tree_model_account_set_color (model, negative, value);
         g_free (string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_BALANCE_PERIOD:
         g_value_init (value, G_TYPE_STRING);
         string = gnc_tree_model_account_compute_period_balance (model, account, FALSE, &negative);
+        gnc_tree_model_account_cache_balance (model, account,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_BALANCE_PERIOD,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_COLOR_BALANCE_PERIOD,
+                                              string, negative);
         g_value_take_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_BALANCE_PERIOD:
         g_value_init (value, G_TYPE_STRING);
         string = gnc_tree_model_account_compute_period_balance (model, account, FALSE, &negative);
+        gnc_tree_model_account_cache_balance (model, account,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_BALANCE_PERIOD,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_COLOR_BALANCE_PERIOD,
+                                              string, negative);
         gnc_tree_model_account_set_color (model, negative, value);
         g_free (string);
         break;
@@ -829,6 +917,10 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
         g_value_init (value, G_TYPE_STRING);
         string = gnc_ui_account_get_print_balance (xaccAccountGetClearedBalanceInCurrency,
                  account, TRUE, &negative);
+        gnc_tree_model_account_cache_balance (model, account,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_CLEARED,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_COLOR_CLEARED,
+                                              string, negative);
         g_value_take_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_CLEARED_REPORT:
@@ -841,6 +933,10 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
         g_value_init (value, G_TYPE_STRING);
         string = gnc_ui_account_get_print_balance (xaccAccountGetClearedBalanceInCurrency,
                  account, TRUE, &negative);
+        gnc_tree_model_account_cache_balance (model, account,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_CLEARED,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_COLOR_CLEARED,
+                                              string, negative);
         gnc_tree_model_account_set_color (model, negative, value);
         g_free (string);
         break;
@@ -849,6 +945,10 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
         g_value_init (value, G_TYPE_STRING);
         string = gnc_ui_account_get_print_balance (xaccAccountGetReconciledBalanceInCurrency,
                  account, TRUE, &negative);
+        gnc_tree_model_account_cache_balance (model, account,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_RECONCILED,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_COLOR_RECONCILED,
+                                              string, negative);
         g_value_take_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_RECONCILED_REPORT:
@@ -867,6 +967,10 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
         g_value_init (value, G_TYPE_STRING);
         string = gnc_ui_account_get_print_balance (xaccAccountGetReconciledBalanceInCurrency,
                  account, TRUE, &negative);
+        gnc_tree_model_account_cache_balance (model, account,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_RECONCILED,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_COLOR_RECONCILED,
+                                              string, negative);
         gnc_tree_model_account_set_color (model, negative, value);
         g_free (string);
         break;
@@ -875,6 +979,10 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
         g_value_init (value, G_TYPE_STRING);
         string = gnc_ui_account_get_print_balance (xaccAccountGetProjectedMinimumBalanceInCurrency,
                  account, TRUE, &negative);
+        gnc_tree_model_account_cache_balance (model, account,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_FUTURE_MIN,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_COLOR_FUTURE_MIN,
+                                              string, negative);
         g_value_take_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_FUTURE_MIN_REPORT:
@@ -887,6 +995,10 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
         g_value_init (value, G_TYPE_STRING);
         string = gnc_ui_account_get_print_balance (xaccAccountGetProjectedMinimumBalanceInCurrency,
                  account, TRUE, &negative);
+        gnc_tree_model_account_cache_balance (model, account,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_FUTURE_MIN,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_COLOR_FUTURE_MIN,
+                                              string, negative);
         gnc_tree_model_account_set_color (model, negative, value);
         g_free (string);
         break;
@@ -895,6 +1007,10 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
         g_value_init (value, G_TYPE_STRING);
         string = gnc_ui_account_get_print_balance (xaccAccountGetBalanceInCurrency,
                  account, TRUE, &negative);
+        gnc_tree_model_account_cache_balance (model, account,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_TOTAL,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_COLOR_TOTAL,
+                                              string, negative);
         g_value_take_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_TOTAL_REPORT:
@@ -907,17 +1023,29 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
         g_value_init (value, G_TYPE_STRING);
         string = gnc_ui_account_get_print_balance (xaccAccountGetBalanceInCurrency,
                  account, TRUE, &negative);
+        gnc_tree_model_account_cache_balance (model, account,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_TOTAL,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_COLOR_TOTAL,
+                                              string, negative);
         gnc_tree_model_account_set_color (model, negative, value);
         g_free (string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_TOTAL_PERIOD:
         g_value_init (value, G_TYPE_STRING);
         string = gnc_tree_model_account_compute_period_balance (model, account, TRUE, &negative);
+        gnc_tree_model_account_cache_balance (model, account,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_TOTAL_PERIOD,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_COLOR_TOTAL_PERIOD,
+                                              string, negative);
         g_value_take_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_TOTAL_PERIOD:
         g_value_init (value, G_TYPE_STRING);
         string = gnc_tree_model_account_compute_period_balance (model, account, TRUE, &negative);
+        gnc_tree_model_account_cache_balance (model, account,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_TOTAL_PERIOD,
+                                              GNC_TREE_MODEL_ACCOUNT_COL_COLOR_TOTAL_PERIOD,
+                                              string, negative);
         gnc_tree_model_account_set_color (model, negative, value);
         g_free (string);
         break;
@@ -1438,6 +1566,15 @@ gnc_tree_model_account_event_handler (QofInstance *entity,
 
     g_return_if_fail (model);    /* Required */
 
+    if (GNC_IS_PRICE(entity))
+    {
+        priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+        if (qof_instance_get_book (entity) == priv->book &&
+            (event_type & (QOF_EVENT_ADD | QOF_EVENT_MODIFY | QOF_EVENT_REMOVE)))
+            gnc_tree_model_account_clear_price_cached_values (model, GNC_PRICE(entity));
+        return;
+    }
+
     if (!GNC_IS_ACCOUNT(entity))
         return;
 
@@ -39,11 +39,16 @@ extern "C" {
 #include <gnc-report.h>
 #include <gnc-session.h>
 #include <qoflog.h>
+#include <csv-transactions-export.h>
 }
 
 #include <boost/locale.hpp>
+#include <gnc-datetime.hpp>
+#include <chrono>
 #include <fstream>
 #include <iostream>
+#include <regex>
+#include <vector>
 
 namespace bl = boost::locale;
 
@@ -161,6 +166,74 @@ write_report_file (const char *html, const char* file)
     // ofs destructor will close the file
 }
 
+/* Run one report, or export it when type is a string, and write the
+ * result to output_file or to stdout if output_file is empty. Returns
+ * false if the report couldn't be run. */
+static bool
+render_report (SCM report, SCM type, const std::string& output_file)
+{
+    if (scm_is_string (type))
+    {
+        auto run_export_cmd = scm_c_eval_string ("gnc:cmdline-template-export");
+        SCM retval = scm_call_2 (run_export_cmd, report, type);
+        SCM query_result = scm_c_eval_string ("gnc:html-document?");
+        SCM get_export_string = scm_c_eval_string ("gnc:html-document-export-string");
+        SCM get_export_error = scm_c_eval_string ("gnc:html-document-export-error");
+
+        if (scm_is_false (scm_call_1 (query_result, retval)))
+        {
+            std::cerr << _("This report must be upgraded to \
+return a document object with export-string or export-error.") << std::endl;
+            return false;
+        }
+
+        SCM export_string = scm_call_1 (get_export_string, retval);
+        SCM export_error = scm_call_1 (get_export_error, retval);
+
+        if (scm_is_string (export_string))
+        {
+            auto output = scm_to_utf8_string (export_string);
+            if (!output_file.empty())
+                write_report_file (output, output_file.c_str());
+            else
+                std::cout << output << std::endl;
+            free (output);
+        }
+        else if (scm_is_string (export_error))
+        {
+            auto err = scm_to_utf8_string (export_error);
+            std::cerr << err << std::endl;
+            free (err);
+            return false;
+        }
+        else
+        {
+            std::cerr << _("This report must be upgraded to \
+return a document object with export-string or export-error.") << std::endl;
+            return false;
+        }
+    }
+    else
+    {
+        auto get_report_cmd = scm_c_eval_string ("gnc:cmdline-get-report-id");
+        SCM id = scm_call_1 (get_report_cmd, report);
+
+        if (scm_is_false (id))
+            return false;
+        char* html;
+        gnc_run_report (scm_to_int (id), &html);
+        if (html && *html)
+        {
+            if (!output_file.empty())
+                write_report_file (html, output_file.c_str());
+            else
+                std::cout << html << std::endl;
+        }
+        g_free (html);
+    }
+    return true;
+}
+
 static void
 scm_run_report (void *data,
                 [[maybe_unused]] int argc, [[maybe_unused]] char **argv)
@@ -180,8 +253,6 @@ scm_run_report (void *data,
 
     auto datafile = args->file_to_load.c_str();
     auto check_report_cmd = scm_c_eval_string ("gnc:cmdline-check-report");
-    auto get_report_cmd = scm_c_eval_string ("gnc:cmdline-get-report-id");
-    auto run_export_cmd = scm_c_eval_string ("gnc:cmdline-template-export");
     /* We generally insist on using scm_from_utf8_string() throughout GnuCash
      * because all GUI-sourced strings and all file-sourced strings are encoded
      * that way. In this case, though, the input is coming from a shell window
@@ -210,78 +281,128 @@ scm_run_report (void *data,
     if (qof_session_get_error (session) != ERR_BACKEND_NO_ERR)
         scm_cleanup_and_exit_with_failure (session);
 
-    char *output;
+    if (!render_report (report, type, args->output_file))
+        scm_cleanup_and_exit_with_failure (nullptr);
 
-    if (!args->export_type.empty())
-    {
-        SCM retval = scm_call_2 (run_export_cmd, report, type);
-        SCM query_result = scm_c_eval_string ("gnc:html-document?");
-        SCM get_export_string = scm_c_eval_string ("gnc:html-document-export-string");
-        SCM get_export_error = scm_c_eval_string ("gnc:html-document-export-error");
+    qof_session_destroy (session);
 
-        if (scm_is_false (scm_call_1 (query_result, retval)))
-        {
-            std::cerr << _("This report must be upgraded to \
-return a document object with export-string or export-error.") << std::endl;
-            scm_cleanup_and_exit_with_failure (nullptr);
-        }
+    qof_event_resume ();
+    gnc_shutdown (0);
+    return;
+}
 
-        SCM export_string = scm_call_1 (get_export_string, retval);
-        SCM export_error = scm_call_1 (get_export_error, retval);
 
-        if (scm_is_string (export_string))
-        {
-            output = scm_to_utf8_string (export_string);
-            if (!args->output_file.empty())
-            {
-                write_report_file(output, args->output_file.c_str());
-            }
-            else
-            {
-                std::cout << output << std::endl;
-            }
-        }
-        else if (scm_is_string (export_error))
-        {
-            auto err = scm_to_utf8_string (export_error);
-            std::cerr << err << std::endl;
-            scm_cleanup_and_exit_with_failure (nullptr);
-        }
-        else
-        {
-            std::cerr << _("This report must be upgraded to \
-return a document object with export-string or export-error.") << std::endl;
+/* One line of a report batch file: the report name and the file to
+ * write its output to. */
+struct report_job {
+    std::string name;
+    std::string output_file;
+};
+
+struct run_report_batch_args {
+    const std::string& file_to_load;
+    const std::vector<report_job>& jobs;
+    const std::string& export_type;
+};
+
+static void
+scm_run_report_batch (void *data,
+                      [[maybe_unused]] int argc, [[maybe_unused]] char **argv)
+{
+    auto args = static_cast<run_report_batch_args*>(data);
+
+    scm_c_eval_string("(debug-set! stack 200000)");
+    scm_c_use_module ("gnucash utilities");
+    scm_c_use_module ("gnucash app-utils");
+    scm_c_use_module ("gnucash reports");
+
+    gnc_report_init ();
+    gnc_prefs_init ();
+    qof_event_suspend ();
+
+    auto datafile = args->file_to_load.c_str();
+    auto check_report_cmd = scm_c_eval_string ("gnc:cmdline-check-report");
+    auto type = !args->export_type.empty() ?
+                scm_from_locale_string (args->export_type.c_str()) : SCM_BOOL_F;
+
+    /* Check all the reports before loading the book, so that a typo in
+     * the batch file doesn't surface only after a long load. The batch
+     * file is read as UTF-8 like every other file GnuCash reads. */
+    std::vector<SCM> reports;
+    for (const auto& job : args->jobs)
+    {
+        auto report = scm_from_utf8_string (job.name.c_str());
+        if (scm_is_false (scm_call_2 (check_report_cmd, report, type)))
             scm_cleanup_and_exit_with_failure (nullptr);
-        }
+        reports.push_back (report);
     }
-    else
-    {
-        SCM id = scm_call_1(get_report_cmd, report);
 
-        if (scm_is_false (id))
-            scm_cleanup_and_exit_with_failure (nullptr);
-        char* html;
-        gnc_run_report (scm_to_int(id), &html);
-        if (html && *html)
-        {
-            if (!args->output_file.empty())
-            {
-                write_report_file(html, args->output_file.c_str());
-            }
-            else
-            {
-                std::cout << html << std::endl;
-            }
-        }
+    PINFO ("Loading datafile %s...\n", datafile);
+
+    auto session = gnc_get_current_session ();
+    if (!session)
+        scm_cleanup_and_exit_with_failure (session);
+
+    qof_session_begin (session, datafile, SESSION_READ_ONLY);
+    if (qof_session_get_error (session) != ERR_BACKEND_NO_ERR)
+        scm_cleanup_and_exit_with_failure (session);
+
+    qof_session_load (session, report_session_percentage);
+    if (qof_session_get_error (session) != ERR_BACKEND_NO_ERR)
+        scm_cleanup_and_exit_with_failure (session);
+
+    auto failures = 0;
+    for (size_t i = 0; i < reports.size(); ++i)
+    {
+        const auto& job = args->jobs[i];
+        auto start = std::chrono::steady_clock::now();
+        auto ok = render_report (reports[i], type, job.output_file);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        if (!ok)
+            ++failures;
+        std::cerr << bl::format (ok ? bl::translate ("Report '{1}' finished in {2} seconds.")
+                                    : bl::translate ("Report '{1}' failed after {2} seconds."))
+                     % job.name % elapsed.count() << "\n";
     }
 
     qof_session_destroy (session);
 
     qof_event_resume ();
-    gnc_shutdown (0);
+    gnc_shutdown (failures ? 1 : 0);
     return;
 }
 
+/* Read a report batch file. Each line holds a report name, optionally
+ * followed by a tab and the output file; without an output file the
+ * report is written to stdout. Empty lines and lines starting with '#'
+ * are ignored. */
+static bool
+read_report_batch_file (const std::string& batch_file, std::vector<report_job>& jobs)
+{
+    std::ifstream ifs{batch_file};
+    if (!ifs)
+    {
+        std::cerr << "Failed to open file " << batch_file << " for reading\n";
+        return false;
+    }
+
+    std::string line;
+    while (std::getline (ifs, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (line.empty() || line.front() == '#')
+            continue;
+
+        auto tab = line.find ('\t');
+        if (tab == std::string::npos)
+            jobs.push_back ({line, empty_string});
+        else
+            jobs.push_back ({line.substr (0, tab), line.substr (tab + 1)});
+    }
+    return true;
+}
 
 struct show_report_args {
     const std::string& file_to_load;
@@ -362,6 +483,24 @@ Gnucash::run_report (const bo_str& file_to_load,
     return 0;
 }
 
+int
+Gnucash::run_report_batch (const bo_str& file_to_load,
+                           const bo_str& batch_file,
+                           const bo_str& export_type)
+{
+    std::vector<report_job> jobs;
+    if (!batch_file || !read_report_batch_file (*batch_file, jobs))
+        return 1;
+
+    auto args = run_report_batch_args { file_to_load ? *file_to_load : empty_string,
+                                        jobs,
+                                        export_type ? *export_type : empty_string };
+    if (!jobs.empty())
+        scm_boot_guile (0, nullptr, scm_run_report_batch, &args);
+
+    return 0;
+}
+
 int
 Gnucash::report_show (const bo_str& file_to_load,
                       const bo_str& show_report)
@@ -380,3 +519,137 @@ Gnucash::report_list (void)
     scm_boot_guile (0, nullptr, scm_report_list, NULL);
     return 0;
 }
+
+int
+Gnucash::convert_file (const bo_str& file_to_load, const bo_str& convert_to)
+{
+    if (!convert_to || convert_to->empty())
+        return 1;
+
+    auto from = qof_session_new (qof_book_new ());
+    auto to = qof_session_new (qof_book_new ());
+    auto success = false;
+
+    qof_event_suspend ();
+    qof_session_begin (from, file_to_load->c_str (), SESSION_READ_ONLY);
+    if (qof_session_get_error (from) != ERR_BACKEND_NO_ERR)
+        PERR ("Can't open %s: %s", file_to_load->c_str (),
+              qof_session_get_error_message (from));
+    else
+    {
+        qof_session_begin (to, convert_to->c_str (), SESSION_NEW_STORE);
+        if (qof_session_get_error (to) != ERR_BACKEND_NO_ERR)
+            PERR ("Can't create %s: %s", convert_to->c_str (),
+                  qof_session_get_error_message (to));
+        else
+            success = qof_session_stream_to (from, to, report_session_percentage);
+        if (!success && qof_session_get_error (from) != ERR_BACKEND_NO_ERR)
+            PERR ("Failed to read %s: %s", file_to_load->c_str (),
+                  qof_session_get_error_message (from));
+        else if (!success)
+            PERR ("Failed to write %s: %s", convert_to->c_str (),
+                  qof_session_get_error_message (to));
+    }
+
+    /* The source book may be missing the transactions that were streamed,
+     * don't let anything save it. */
+    qof_session_destroy (to);
+    qof_session_destroy (from);
+    qof_event_resume ();
+    return success ? 0 : 1;
+}
+
+/* Parse a YYYY-MM-DD command line date to the start or end of that day,
+ * or fall back to the given time if it's missing. */
+static bool
+parse_cli_date (const bo_str& date, DayPart part, time64 fallback, time64& result)
+{
+    if (!date || date->empty())
+    {
+        result = fallback;
+        return true;
+    }
+    try
+    {
+        result = static_cast<time64>(GncDateTime (GncDate (*date, "y-m-d"), part));
+        return true;
+    }
+    catch (const std::exception&)
+    {
+        std::cerr << bl::format (bl::translate ("Invalid date '{1}', expected YYYY-MM-DD")) % *date
+                  << std::endl;
+        return false;
+    }
+}
+
+int
+Gnucash::export_transactions (const bo_str& file_to_load, const bo_str& csv_file,
+                              const bo_str& accounts, const bo_str& start_date,
+                              const bo_str& end_date, bool simple_layout)
+{
+    if (!csv_file || csv_file->empty())
+        return 1;
+
+    time64 start_time, end_time;
+    if (!parse_cli_date (start_date, DayPart::start, INT64_MIN, start_time) ||
+        !parse_cli_date (end_date, DayPart::end, INT64_MAX, end_time))
+        return 1;
+
+    std::regex account_re;
+    try
+    {
+        if (accounts && !accounts->empty())
+            account_re = std::regex (*accounts);
+    }
+    catch (const std::regex_error&)
+    {
+        std::cerr << bl::format (bl::translate ("Invalid account expression '{1}'")) % *accounts
+                  << std::endl;
+        return 1;
+    }
+
+    gnc_prefs_init ();
+    qof_event_suspend ();
+
+    auto session = gnc_get_current_session ();
+    qof_session_begin (session, file_to_load->c_str (), SESSION_READ_ONLY);
+    if (qof_session_get_error (session) == ERR_BACKEND_NO_ERR)
+        qof_session_load (session, nullptr);
+    if (qof_session_get_error (session) != ERR_BACKEND_NO_ERR)
+    {
+        PERR ("Can't load %s: %s", file_to_load->c_str (),
+              qof_session_get_error_message (session));
+        gnc_clear_current_session ();
+        qof_event_resume ();
+        return 1;
+    }
+
+    auto root = gnc_book_get_root_account (qof_session_get_book (session));
+    auto descendants = gnc_account_get_descendants_sorted (root);
+    GList *selected = nullptr;
+    for (auto node = descendants; node; node = node->next)
+    {
+        auto acc = static_cast<Account*>(node->data);
+        if (accounts && !accounts->empty())
+        {
+            auto name = gnc_account_get_full_name (acc);
+            auto match = std::regex_search (name, account_re);
+            g_free (name);
+            if (!match)
+                continue;
+        }
+        selected = g_list_prepend (selected, acc);
+    }
+    g_list_free (descendants);
+    selected = g_list_reverse (selected);
+
+    auto success = csv_transactions_export_accounts (selected, start_time, end_time,
+                                                     simple_layout, csv_file->c_str ());
+    if (!success)
+        PERR ("Failed to export the transactions to %s.", csv_file->c_str ());
+
+    g_list_free (selected);
+    gnc_clear_current_session ();
+    qof_event_resume ();
+    return success ? 0 : 1;
+}
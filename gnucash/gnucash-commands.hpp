@@ -37,7 +37,18 @@ namespace Gnucash {
                     const bo_str& run_report,
                     const bo_str& export_type,
                     const bo_str& output_file);
+    int run_report_batch (const bo_str& file_to_load,
+                          const bo_str& batch_file,
+                          const bo_str& export_type);
     int report_list (void);
+    int convert_file (const bo_str& file_to_load,
+                      const bo_str& convert_to);
+    int export_transactions (const bo_str& file_to_load,
+                             const bo_str& csv_file,
+                             const bo_str& accounts,
+                             const bo_str& start_date,
+                             const bo_str& end_date,
+                             bool simple_layout);
     int report_show (const bo_str& file_to_load,
                      const bo_str& run_report);
 }
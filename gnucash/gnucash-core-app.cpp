@@ -535,6 +535,8 @@ Gnucash::CoreApp::add_common_program_options (void)
          _("Log level overrides, of the form \"modulename={debug,info,warn,crit,error}\"\nExamples: \"--log qof=debug\" or \"--log gnc.backend.file.sx=info\"\nThis can be invoked multiple times."))
         ("logto", bpo::value (&m_log_to_filename),
          _("File to log into; defaults to \"/tmp/gnucash.trace\"; can be \"stderr\" or \"stdout\"."))
+        ("trace-to", bpo::value (&m_trace_to_filename),
+         _("Record timed spans of loading, saving, queries, commits, scrubbing and reports, and write them to this file in Chrome trace-event format on exit."))
         ("gsettings-prefix", bpo::value (&m_gsettings_prefix),
          _("Set the prefix for gsettings schemas for gsettings queries. This can be useful to have a different settings tree while debugging."));
 
@@ -564,6 +566,8 @@ Gnucash::CoreApp::start (void)
         g_print("\n\n%s\n", userdata_migration_msg);
 
     gnc_log_init (m_log_flags, m_log_to_filename);
+    if (m_trace_to_filename && !m_trace_to_filename->empty())
+        qof_trace_init_filename (m_trace_to_filename->c_str());
     gnc_engine_init (0, NULL);
 
     /* Write some locale details to the log to simplify debugging */
@@ -66,6 +66,7 @@ private:
     bool m_extra = false;
     boost::optional <std::string> m_gsettings_prefix;
     std::vector <std::string> m_log_flags;
+    boost::optional <std::string> m_trace_to_filename;
 
     char *sys_locale = nullptr;
 };
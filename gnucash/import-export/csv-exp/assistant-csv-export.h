@@ -71,7 +71,7 @@ typedef struct
     CsvExportType   export_type;
     CsvExportDate   csvd;
     CsvExportAcc    csva;
-    GList          *trans_list;
+    GHashTable     *trans_set;
 
     Query          *query;
     Account        *account;
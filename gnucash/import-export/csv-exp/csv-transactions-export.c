@@ -60,326 +60,225 @@ static QofLogModule log_module = GNC_MOD_ASSISTANT;
  * successful.
  *******************************************************/
 static
-gboolean write_line_to_file (FILE *fh, char * line)
+gboolean write_line_to_file (FILE *fh, GString *line)
 {
-    int len, written;
-    DEBUG("Account String: %s", line);
+    DEBUG("Account String: %s", line->str);
 
     /* Write account line */
-    len = strlen (line);
-    written = fwrite (line, 1, len, fh);
-
-    if (written != len)
-        return FALSE;
-    else
-        return TRUE;
+    return fwrite (line->str, 1, line->len, fh) == line->len;
 }
 
 
 /*******************************************************
  * csv_txn_test_field_string
  *
- * Test the field string for ," and new lines
+ * Append a field to the line, doubling any " and quoting
+ * the field if it holds a separator, new line or "
  *******************************************************/
 static
-gchar *csv_txn_test_field_string (CsvExportInfo *info, const gchar *string_in)
+void csv_txn_test_field_string (GString *line, CsvExportInfo *info, const gchar *string_in)
 {
-    gboolean need_quote = FALSE;
-    gchar **parts;
-    gchar *string_parts;
-    gchar *string_out;
+    gsize start = line->len;
+    const gchar *quote;
+    const gchar *field;
+
+    if (!string_in)
+        string_in = "";
 
     /* Check for " and then "" them */
-    parts = g_strsplit (string_in, "\"", -1);
-    string_parts = g_strjoinv ("\"\"", parts);
-    g_strfreev (parts);
+    while ((quote = strchr (string_in, '"')) != NULL)
+    {
+        g_string_append_len (line, string_in, quote - string_in + 1);
+        g_string_append_c (line, '"');
+        string_in = quote + 1;
+    }
+    g_string_append (line, string_in);
 
     /* Check for separator string and \n and " in field,
        if so quote field if not already quoted */
-    if (g_strrstr (string_parts, info->separator_str) != NULL)
-        need_quote = TRUE;
-    if (g_strrstr (string_parts, "\n") != NULL)
-        need_quote = TRUE;
-    if (g_strrstr (string_parts, "\"") != NULL)
-        need_quote = TRUE;
-
-    if (!info->use_quotes && need_quote)
-        string_out = g_strconcat ("\"", string_parts, "\"", NULL);
-    else
-        string_out = g_strdup (string_parts);
-
-    g_free (string_parts);
-    return string_out;
+    field = line->str + start;
+    if (!info->use_quotes &&
+        (strstr (field, info->separator_str) != NULL ||
+         strchr (field, '\n') != NULL || strchr (field, '"') != NULL))
+    {
+        g_string_insert_c (line, start, '"');
+        g_string_append_c (line, '"');
+    }
 }
 
 /******************** Helper functions *********************/
 
+// Field followed by a separator
+static void
+add_field (GString *line, const gchar *field, CsvExportInfo *info)
+{
+    csv_txn_test_field_string (line, info, field);
+    g_string_append (line, info->mid_sep);
+}
+
 // Transaction Date
-static gchar*
-add_date (gchar *so_far, Transaction *trans, CsvExportInfo *info)
+static void
+add_date (GString *line, Transaction *trans, CsvExportInfo *info)
 {
-    gchar *date = qof_print_date (xaccTransGetDate (trans));
-    gchar *result = g_strconcat (so_far, info->end_sep, date, info->mid_sep, NULL);
-    g_free (date);
-    g_free (so_far);
-    return result;
+    char date[MAX_DATE_LENGTH + 1];
+    memset (date, 0, sizeof(date));
+    qof_print_date_buff (date, MAX_DATE_LENGTH, xaccTransGetDate (trans));
+    g_string_append (line, info->end_sep);
+    g_string_append (line, date);
+    g_string_append (line, info->mid_sep);
 }
 
 
 // Transaction GUID
-static gchar*
-add_guid (gchar *so_far, Transaction *trans, CsvExportInfo *info)
+static void
+add_guid (GString *line, Transaction *trans, CsvExportInfo *info)
 {
-    gchar *result;
-    gchar *guid;
-
-    guid = guid_to_string (xaccTransGetGUID (trans));
-    result = g_strconcat (so_far, guid, info->mid_sep, NULL);
-    g_free (guid);
-    g_free (so_far);
-    return result;
+    gchar guid[GUID_ENCODING_LENGTH + 1];
+
+    guid_to_string_buff (xaccTransGetGUID (trans), guid);
+    g_string_append (line, guid);
+    g_string_append (line, info->mid_sep);
 }
 
 // Reconcile Date
-static gchar*
-add_reconcile_date (gchar *so_far, Split *split, CsvExportInfo *info)
+static void
+add_reconcile_date (GString *line, Split *split, CsvExportInfo *info)
 {
-    gchar *result;
-
     if (xaccSplitGetReconcile (split) == YREC)
     {
         time64 t = xaccSplitGetDateReconciled (split);
         char str_rec_date[MAX_DATE_LENGTH + 1];
         memset (str_rec_date, 0, sizeof(str_rec_date));
         qof_print_date_buff (str_rec_date, MAX_DATE_LENGTH, t);
-        result = g_strconcat (so_far, str_rec_date, info->mid_sep, NULL);
+        g_string_append (line, str_rec_date);
     }
-    else
-        result = g_strconcat (so_far, info->mid_sep, NULL);
-
-    g_free (so_far);
-    return result;
+    g_string_append (line, info->mid_sep);
 }
 
 // Account Name short or Long
-static gchar*
-add_account_name (gchar *so_far, Split *split, gboolean full, CsvExportInfo *info)
+static void
+add_account_name (GString *line, Split *split, gboolean full, CsvExportInfo *info)
 {
-    gchar       *name = NULL;
-    gchar       *conv;
-    gchar       *result;
-
-    Account     *account = xaccSplitGetAccount (split);
+    Account *account = xaccSplitGetAccount (split);
     if (full)
-        name = gnc_account_get_full_name (account);
+    {
+        gchar *name = gnc_account_get_full_name (account);
+        add_field (line, name, info);
+        g_free (name);
+    }
     else
-        name = g_strdup (xaccAccountGetName (account));
-    conv = csv_txn_test_field_string (info, name);
-    result = g_strconcat (so_far, conv, info->mid_sep, NULL);
-    g_free (name);
-    g_free (conv);
-    g_free (so_far);
-    return result;
+        add_field (line, xaccAccountGetName (account), info);
 }
 
 // Number
-static gchar*
-add_number (gchar *so_far, Transaction *trans, CsvExportInfo *info)
+static void
+add_number (GString *line, Transaction *trans, CsvExportInfo *info)
 {
-    const gchar *num;
-    gchar       *conv;
-    gchar       *result;
-
-    num = xaccTransGetNum (trans) ? xaccTransGetNum (trans) : "" ;
-    conv = csv_txn_test_field_string (info, num);
-    result = g_strconcat (so_far, conv, info->mid_sep, NULL);
-    g_free (conv);
-    g_free (so_far);
-    return result;
+    add_field (line, xaccTransGetNum (trans), info);
 }
 
 // Description
-static gchar*
-add_description (gchar *so_far, Transaction *trans, CsvExportInfo *info)
+static void
+add_description (GString *line, Transaction *trans, CsvExportInfo *info)
 {
-    const gchar *desc;
-    gchar       *conv;
-    gchar       *result;
-
-    desc = xaccTransGetDescription (trans) ? xaccTransGetDescription (trans) : "" ;
-    conv = csv_txn_test_field_string (info, desc);
-    result = g_strconcat (so_far, conv, info->mid_sep, NULL);
-    g_free (conv);
-    g_free (so_far);
-    return result;
+    add_field (line, xaccTransGetDescription (trans), info);
 }
 
 // Notes
-static gchar*
-add_notes (gchar *so_far, Transaction *trans, CsvExportInfo *info)
+static void
+add_notes (GString *line, Transaction *trans, CsvExportInfo *info)
 {
-    const gchar *notes;
-    gchar       *conv;
-    gchar       *result;
-
-    notes = xaccTransGetNotes (trans) ? xaccTransGetNotes (trans) : "" ;
-    conv = csv_txn_test_field_string (info, notes);
-    result = g_strconcat (so_far, conv, info->mid_sep, NULL);
-    g_free (conv);
-    g_free (so_far);
-    return result;
+    add_field (line, xaccTransGetNotes (trans), info);
 }
 
 // Void reason
-static gchar*
-add_void_reason (gchar *so_far, Transaction *trans, CsvExportInfo *info)
+static void
+add_void_reason (GString *line, Transaction *trans, CsvExportInfo *info)
 {
-    gchar       *result;
-
     if (xaccTransGetVoidStatus (trans))
-    {
-        const gchar *void_reason = xaccTransGetVoidReason (trans);
-        gchar *conv = csv_txn_test_field_string (info, void_reason);
-        result = g_strconcat (so_far, conv, info->mid_sep, NULL);
-        g_free (conv);
-    }
+        add_field (line, xaccTransGetVoidReason (trans), info);
     else
-        result = g_strconcat (so_far, info->mid_sep, NULL);
-
-    g_free (so_far);
-    return result;
+        g_string_append (line, info->mid_sep);
 }
 
 // Memo
-static gchar*
-add_memo (gchar *so_far, Split *split, CsvExportInfo *info)
+static void
+add_memo (GString *line, Split *split, CsvExportInfo *info)
 {
-    const gchar *memo;
-    gchar       *conv;
-    gchar       *result;
-
-    memo = xaccSplitGetMemo (split) ? xaccSplitGetMemo (split) : "" ;
-    conv = csv_txn_test_field_string (info, memo);
-    result = g_strconcat (so_far, conv, info->mid_sep, NULL);
-    g_free (conv);
-    g_free (so_far);
-    return result;
+    add_field (line, xaccSplitGetMemo (split), info);
 }
 
 // Full Category Path or Not
-static gchar*
-add_category (gchar *so_far, Split *split, gboolean full, CsvExportInfo *info)
+static void
+add_category (GString *line, Split *split, gboolean full, CsvExportInfo *info)
 {
-    gchar       *cat;
-    gchar       *conv;
-    gchar       *result;
-
     if (full)
-        cat = xaccSplitGetCorrAccountFullName (split);
+    {
+        gchar *cat = xaccSplitGetCorrAccountFullName (split);
+        add_field (line, cat, info);
+        g_free (cat);
+    }
     else
-        cat = g_strdup(xaccSplitGetCorrAccountName (split));
-
-    conv = csv_txn_test_field_string (info, cat);
-    result = g_strconcat (so_far, conv, info->mid_sep, NULL);
-    g_free (cat);
-    g_free (conv);
-    g_free (so_far);
-    return result;
+        add_field (line, xaccSplitGetCorrAccountName (split), info);
 }
 
 // Action
-static gchar*
-add_action (gchar *so_far, Split *split, CsvExportInfo *info)
+static void
+add_action (GString *line, Split *split, CsvExportInfo *info)
 {
-    const gchar *action = xaccSplitGetAction (split);
-    gchar *conv = csv_txn_test_field_string (info, action);
-    gchar *result = g_strconcat (so_far, conv, info->mid_sep, NULL);
-    g_free (conv);
-    g_free (so_far);
-    return result;
+    add_field (line, xaccSplitGetAction (split), info);
 }
 
 // Reconcile
-static gchar*
-add_reconcile (gchar *so_far, Split *split, CsvExportInfo *info)
+static void
+add_reconcile (GString *line, Split *split, CsvExportInfo *info)
 {
-    const gchar *recon;
-    gchar       *conv;
-    gchar       *result;
-
-    recon = gnc_get_reconcile_str (xaccSplitGetReconcile (split));
-    conv = csv_txn_test_field_string (info, recon);
-    result = g_strconcat (so_far, conv, info->mid_sep, NULL);
-    g_free (conv);
-    g_free (so_far);
-    return result;
+    add_field (line, gnc_get_reconcile_str (xaccSplitGetReconcile (split)), info);
 }
 
 // Transaction commodity
-static gchar*
-add_commodity (gchar *so_far, Transaction *trans, CsvExportInfo *info)
+static void
+add_commodity (GString *line, Transaction *trans, CsvExportInfo *info)
 {
-    const gchar *comm_m;
-    gchar       *conv;
-    gchar       *result;
-
-    comm_m = gnc_commodity_get_unique_name (xaccTransGetCurrency (trans));
-
-    conv = csv_txn_test_field_string (info, comm_m);
-    result = g_strconcat (so_far, conv, info->mid_sep, NULL);
-    g_free (conv);
-    g_free (so_far);
-    return result;
+    add_field (line, gnc_commodity_get_unique_name (xaccTransGetCurrency (trans)), info);
 }
 
 // Amount with Symbol or not
-static gchar*
-add_amount (gchar *so_far, Split *split, gboolean t_void, gboolean symbol, CsvExportInfo *info)
+static void
+add_amount (GString *line, Split *split, gboolean t_void, gboolean symbol, CsvExportInfo *info)
 {
     const gchar *amt;
-    gchar       *conv;
-    gchar       *result;
 
     if (t_void)
         amt = xaccPrintAmount (xaccSplitVoidFormerAmount (split), gnc_split_amount_print_info (split, symbol));
     else
         amt = xaccPrintAmount (xaccSplitGetAmount (split), gnc_split_amount_print_info (split, symbol));
-    conv = csv_txn_test_field_string (info, amt);
-    result = g_strconcat (so_far, conv, info->mid_sep, NULL);
-    g_free (conv);
-    g_free (so_far);
-    return result;
+    add_field (line, amt, info);
 }
 
 // Share Price / Conversion factor
-static gchar*
-add_rate (gchar *so_far, Split *split, gboolean t_void, CsvExportInfo *info)
+static void
+add_rate (GString *line, Split *split, gboolean t_void, CsvExportInfo *info)
 {
     const gchar *amt;
     gnc_commodity *curr = xaccAccountGetCommodity (xaccSplitGetAccount (split));
-    gchar       *conv;
-    gchar       *result;
 
     if (t_void)
         amt = xaccPrintAmount (gnc_numeric_zero(), gnc_default_price_print_info (curr));
     else
         amt = xaccPrintAmount (xaccSplitGetSharePrice (split), gnc_default_price_print_info (curr));
 
-    conv = csv_txn_test_field_string (info, amt);
-    result = g_strconcat (so_far, conv, info->end_sep, EOLSTR, NULL);
-    g_free (conv);
-    g_free (so_far);
-    return result;
+    csv_txn_test_field_string (line, info, amt);
+    g_string_append (line, info->end_sep);
+    g_string_append (line, EOLSTR);
 }
 
 // Share Price / Conversion factor
-static gchar*
-add_price (gchar *so_far, Split *split, gboolean t_void, CsvExportInfo *info)
+static void
+add_price (GString *line, Split *split, gboolean t_void, CsvExportInfo *info)
 {
     const gchar *string_amount;
     gnc_commodity *curr = xaccAccountGetCommodity (xaccSplitGetAccount (split));
-    gchar       *conv;
-    gchar       *result;
 
     if (t_void)
     {
@@ -390,70 +289,70 @@ add_price (gchar *so_far, Split *split, gboolean t_void, CsvExportInfo *info)
     else
         string_amount = xaccPrintAmount (xaccSplitGetSharePrice (split), gnc_default_price_print_info (curr));
 
-    conv = csv_txn_test_field_string (info, string_amount);
-    result = g_strconcat (so_far, conv, info->end_sep, EOLSTR, NULL);
-    g_free (conv);
-    return result;
+    csv_txn_test_field_string (line, info, string_amount);
+    g_string_append (line, info->end_sep);
+    g_string_append (line, EOLSTR);
 }
 
 /******************************************************************************/
 
-static gchar*
-make_simple_trans_line (Account *acc, Transaction *trans, Split *split, CsvExportInfo *info)
+static void
+make_simple_trans_line (GString *line, Transaction *trans, Split *split, CsvExportInfo *info)
 {
     gboolean t_void = xaccTransGetVoidStatus (trans);
 
-    gchar *exp_line = g_strdup("");
-    exp_line = add_date (exp_line, trans, info);
-    exp_line = add_account_name (exp_line, split, TRUE, info);
-    exp_line = add_number (exp_line, trans, info);
-    exp_line = add_description (exp_line, trans, info);
-    exp_line = add_category (exp_line, split, TRUE, info);
-    exp_line = add_reconcile (exp_line, split, info);
-    exp_line = add_amount (exp_line, split, t_void, TRUE, info);
-    exp_line = add_amount (exp_line, split, t_void, FALSE, info);
-    exp_line = add_rate (exp_line, split, t_void, info);
-    return exp_line;
+    g_string_truncate (line, 0);
+    add_date (line, trans, info);
+    add_account_name (line, split, TRUE, info);
+    add_number (line, trans, info);
+    add_description (line, trans, info);
+    add_category (line, split, TRUE, info);
+    add_reconcile (line, split, info);
+    add_amount (line, split, t_void, TRUE, info);
+    add_amount (line, split, t_void, FALSE, info);
+    add_rate (line, split, t_void, info);
 }
 
-static gchar*
-make_split_part (gchar* exp_line, Split *split, gboolean t_void, CsvExportInfo *info)
+static void
+make_split_part (GString *line, Split *split, gboolean t_void, CsvExportInfo *info)
 {
-    exp_line = add_action (exp_line, split, info);
-    exp_line = add_memo (exp_line, split, info);
-    exp_line = add_account_name (exp_line, split, TRUE, info);
-    exp_line = add_account_name (exp_line, split, FALSE, info);
-    exp_line = add_amount (exp_line, split, t_void, TRUE, info);
-    exp_line = add_amount (exp_line, split, t_void, FALSE, info);
-    exp_line = add_reconcile (exp_line, split, info);
-    exp_line = add_reconcile_date (exp_line, split, info);
-    exp_line = add_price (exp_line, split, t_void, info);
-    return exp_line;
+    add_action (line, split, info);
+    add_memo (line, split, info);
+    add_account_name (line, split, TRUE, info);
+    add_account_name (line, split, FALSE, info);
+    add_amount (line, split, t_void, TRUE, info);
+    add_amount (line, split, t_void, FALSE, info);
+    add_reconcile (line, split, info);
+    add_reconcile_date (line, split, info);
+    add_price (line, split, t_void, info);
 }
 
-static gchar*
-make_complex_trans_line (Account *acc, Transaction *trans, Split *split, CsvExportInfo *info)
+static void
+make_complex_trans_line (GString *line, Transaction *trans, Split *split, CsvExportInfo *info)
 {
-    gchar *exp_line = g_strdup("");
-    exp_line = add_date (exp_line, trans, info);
-    exp_line = add_guid (exp_line, trans, info);
-    exp_line = add_number (exp_line, trans, info);
-    exp_line = add_description (exp_line, trans, info);
-    exp_line = add_notes (exp_line, trans, info);
-    exp_line = add_commodity (exp_line, trans, info);
-    exp_line = add_void_reason (exp_line, trans, info);
-    return make_split_part (exp_line, split, xaccTransGetVoidStatus (trans), info);
+    g_string_truncate (line, 0);
+    add_date (line, trans, info);
+    add_guid (line, trans, info);
+    add_number (line, trans, info);
+    add_description (line, trans, info);
+    add_notes (line, trans, info);
+    add_commodity (line, trans, info);
+    add_void_reason (line, trans, info);
+    make_split_part (line, split, xaccTransGetVoidStatus (trans), info);
 }
 
-static gchar*
-make_complex_split_line (Transaction *trans, Split *split, CsvExportInfo *info)
+static void
+make_complex_split_line (GString *line, Transaction *trans, Split *split, CsvExportInfo *info)
 {
+    int i;
+
     /* Pure split lines don't have any transaction information,
      * so start with empty fields for all transaction columns.
      */
-    gchar *result = g_strconcat (info->end_sep, info->mid_sep, info->mid_sep, info->mid_sep,
-            info->mid_sep, info->mid_sep, info->mid_sep, info->mid_sep, NULL);
-    return make_split_part (result, split, xaccTransGetVoidStatus (trans), info);
+    g_string_assign (line, info->end_sep);
+    for (i = 0; i < 7; i++)
+        g_string_append (line, info->mid_sep);
+    make_split_part (line, split, xaccTransGetVoidStatus (trans), info);
 }
 
 
@@ -464,48 +363,34 @@ make_complex_split_line (Transaction *trans, Split *split, CsvExportInfo *info)
  * send them to a file
  *******************************************************/
 static
-void account_splits (CsvExportInfo *info, Account *acc, FILE *fh )
+void account_splits (CsvExportInfo *info, Account *acc, FILE *fh, GString *line)
 {
-    GSList  *p1, *p2;
-    GList   *splits;
-    QofBook *book;
+    GList *splits, *node;
 
-    // Setup the query for normal transaction export
+    /* The account's own split list is already in date order, which saves
+     * running a query over the whole book for every account. */
     if (info->export_type == XML_EXPORT_TRANS)
-    {
-        info->query = qof_query_create_for (GNC_ID_SPLIT);
-        book = gnc_get_current_book();
-        qof_query_set_book (info->query, book);
-
-        /* Sort by transaction date */
-        p1 = g_slist_prepend (NULL, TRANS_DATE_POSTED);
-        p1 = g_slist_prepend (p1, SPLIT_TRANS);
-        p2 = g_slist_prepend (NULL, QUERY_DEFAULT_SORT);
-        qof_query_set_sort_order (info->query, p1, p2, NULL);
-
-        xaccQueryAddSingleAccountMatch (info->query, acc, QOF_QUERY_AND);
-        xaccQueryAddDateMatchTT (info->query, TRUE, info->csvd.start_time, TRUE, info->csvd.end_time, QOF_QUERY_AND);
-    }
+        splits = xaccAccountGetSplitList (acc);
+    else
+        splits = qof_query_run (info->query);
 
-    /* Run the query */
-    for (splits = qof_query_run (info->query); splits; splits = splits->next)
+    for (node = splits; node && !info->failed; node = node->next)
     {
-        Split       *split;
-        Transaction *trans;
-        SplitList   *s_list;
-        GList       *node;
-        Split       *t_split;
-        int          nSplits;
-        int          cnt;
-        gchar       *line;
-
-        split = splits->data;
-        trans = xaccSplitGetParent (split);
-        nSplits = xaccTransCountSplits (trans);
-        s_list = xaccTransGetSplitList (trans);
-
-        // Look for trans already exported in trans_list
-        if (g_list_find (info->trans_list, trans) != NULL)
+        Split       *split = node->data;
+        Transaction *trans = xaccSplitGetParent (split);
+        GList       *s_node;
+
+        if (info->export_type == XML_EXPORT_TRANS)
+        {
+            time64 date = xaccTransGetDate (trans);
+            if (date < info->csvd.start_time)
+                continue;
+            if (date > info->csvd.end_time)
+                break;
+        }
+
+        // Look for trans already exported in trans_set
+        if (g_hash_table_contains (info->trans_set, trans))
             continue;
 
         // Look for blank split
@@ -515,20 +400,16 @@ void account_splits (CsvExportInfo *info, Account *acc, FILE *fh )
         // This will be a simple layout equivalent to a single line register view.
         if (info->simple_layout)
         {
-            line = make_simple_trans_line (acc, trans, split, info);
+            make_simple_trans_line (line, trans, split, info);
 
             /* Write to file */
             if (!write_line_to_file (fh, line))
-            {
                 info->failed = TRUE;
-                break;
-            }
-            g_free (line);
             continue;
         }
 
         // Complex Transaction Line.
-        line = make_complex_trans_line (acc, trans, split, info);
+        make_complex_trans_line (line, trans, split, info);
 
         /* Write to file */
         if (!write_line_to_file (fh, line))
@@ -536,35 +417,25 @@ void account_splits (CsvExportInfo *info, Account *acc, FILE *fh )
             info->failed = TRUE;
             break;
         }
-        g_free (line);
 
         /* Loop through the list of splits for the Transaction */
-        node = s_list;
-        cnt = 0;
-        while ((cnt < nSplits) && (info->failed == FALSE))
+        for (s_node = xaccTransGetSplitList (trans); s_node && !info->failed;
+             s_node = s_node->next)
         {
-            t_split = node->data;
+            Split *t_split = s_node->data;
 
             // base split is already written on the trans_line
-            if (split != t_split)
-            {
-            // Complex Split Line.
-                line = make_complex_split_line (trans, t_split, info);
+            if (split == t_split)
+                continue;
 
-                if (!write_line_to_file (fh, line))
-                    info->failed = TRUE;
-
-                g_free (line);
-            }
+            // Complex Split Line.
+            make_complex_split_line (line, trans, t_split, info);
 
-            cnt++;
-            node = node->next;
+            if (!write_line_to_file (fh, line))
+                info->failed = TRUE;
         }
-        info->trans_list = g_list_prepend (info->trans_list, trans); // add trans to trans_list
+        g_hash_table_add (info->trans_set, trans); // add trans to trans_set
     }
-    if (info->export_type == XML_EXPORT_TRANS)
-        qof_query_destroy (info->query);
-    g_list_free (splits);
 }
 
 
@@ -601,9 +472,13 @@ void csv_transactions_export (CsvExportInfo *info)
     fh = g_fopen (info->file_name, "w" );
     if (fh != NULL)
     {
+        GString *line;
         gchar *header;
         int i;
 
+        /* Lines are small, let stdio gather them into large writes. */
+        setvbuf (fh, NULL, _IOFBF, 1 << 20);
+
         /* Header string */
         if (info->simple_layout)
         {
@@ -632,33 +507,71 @@ void csv_transactions_export (CsvExportInfo *info)
         DEBUG("Header String: %s", header);
 
         /* Write header line */
-        if (!write_line_to_file (fh, header))
+        line = g_string_new (header);
+        g_free (header);
+        if (!write_line_to_file (fh, line))
         {
             info->failed = TRUE;
-            g_free (header);
+            g_string_free (line, TRUE);
+            fclose (fh);
+            LEAVE("");
             return;
         }
-        g_free (header);
+
+        info->trans_set = g_hash_table_new (NULL, NULL);
 
         if (info->export_type == XML_EXPORT_TRANS)
         {
             /* Go through list of accounts */
-            for (ptr = info->csva.account_list, i = 0; ptr; ptr = g_list_next(ptr), i++)
+            for (ptr = info->csva.account_list, i = 0; ptr && !info->failed;
+                 ptr = g_list_next(ptr), i++)
             {
                 acc = ptr->data;
                 DEBUG("Account being processed is : %s", xaccAccountGetName (acc));
-                account_splits (info, acc, fh);
+                account_splits (info, acc, fh, line);
             }
         }
         else
-            account_splits (info, info->account, fh);
+            account_splits (info, info->account, fh, line);
 
-        g_list_free (info->trans_list); // free trans_list
+        g_hash_table_destroy (info->trans_set); // free trans_set
+        info->trans_set = NULL;
+        g_string_free (line, TRUE);
     }
     else
         info->failed = TRUE;
-    if (fh)
-        fclose (fh);
+    if (fh && fclose (fh) != 0)
+        info->failed = TRUE;
     LEAVE("");
 }
 
+
+/*******************************************************
+ * csv_transactions_export_accounts
+ *
+ * export the transactions of a list of accounts without
+ * the assistant
+ *******************************************************/
+gboolean
+csv_transactions_export_accounts (GList *accounts, time64 start_time,
+                                  time64 end_time, gboolean simple_layout,
+                                  const gchar *file_name)
+{
+    CsvExportInfo info;
+
+    g_return_val_if_fail (file_name != NULL, FALSE);
+
+    memset (&info, 0, sizeof (info));
+    info.export_type = XML_EXPORT_TRANS;
+    info.csva.account_list = accounts;
+    info.csvd.start_time = start_time;
+    info.csvd.end_time = end_time;
+    info.simple_layout = simple_layout;
+    info.separator_str = ",";
+    info.file_name = (gchar *)file_name;
+
+    csv_transactions_export (&info);
+    g_free (info.mid_sep);
+
+    return !info.failed;
+}
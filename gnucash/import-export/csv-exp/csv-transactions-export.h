@@ -35,5 +35,16 @@
  */
 void csv_transactions_export (CsvExportInfo *info);
 
+/** The csv_transactions_export_accounts() exports the transactions of
+ *  the given accounts posted between start_time and end_time, inclusive,
+ *  to file_name without any user interface. The file uses the default
+ *  comma separator.
+ *
+ *  @return TRUE if the file was written successfully.
+ */
+gboolean csv_transactions_export_accounts (GList *accounts, time64 start_time,
+                                           time64 end_time, gboolean simple_layout,
+                                           const gchar *file_name);
+
 #endif
 
@@ -62,10 +62,11 @@ std::map<GncPricePropType, const char*> gnc_price_col_type_strs = {
 GncNumeric parse_amount_price (const std::string &str, int currency_format)
 {
     /* If a cell is empty or just spaces return invalid amount */
-    if(!boost::regex_search(str, boost::regex("[0-9]")))
+    static const boost::regex digit_re("[0-9]");
+    if(!boost::regex_search(str, digit_re))
         throw std::invalid_argument (_("Value doesn't appear to contain a valid number."));
 
-    auto expr = boost::make_u32regex("[[:Sc:]]");
+    static const auto expr = boost::make_u32regex("[[:Sc:]]");
     std::string str_no_symbols = boost::u32regex_replace(str, expr, "");
 
     /* Convert based on user chosen currency format */
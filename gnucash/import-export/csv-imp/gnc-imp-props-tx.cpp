@@ -113,10 +113,11 @@ GncNumeric parse_amount (const std::string &str, int currency_format)
         return GncNumeric{};
 
     /* Strings otherwise containing not digits will be considered invalid */
-    if(!boost::regex_search(str, boost::regex("[0-9]")))
+    static const boost::regex digit_re("[0-9]");
+    if(!boost::regex_search(str, digit_re))
         throw std::invalid_argument (_("Value doesn't appear to contain a valid number."));
 
-    auto expr = boost::make_u32regex("[[:Sc:]]");
+    static const auto expr = boost::make_u32regex("[[:Sc:]]");
     std::string str_no_symbols = boost::u32regex_replace(str, expr, "");
 
     /* Convert based on user chosen currency format */
@@ -207,10 +208,11 @@ static GncNumeric parse_price (const std::string &str)
         return GncNumeric{};
 
     /* Strings otherwise containing not digits will be considered invalid */
-    if(!boost::regex_search(str, boost::regex("[0-9]")))
+    static const boost::regex digit_re("[0-9]");
+    if(!boost::regex_search(str, digit_re))
         throw std::invalid_argument (_("Value doesn't appear to contain a valid number."));
 
-    auto expr = boost::make_u32regex("[[:Sc:]]");
+    static const auto expr = boost::make_u32regex("[[:Sc:]]");
     std::string str_no_symbols = boost::u32regex_replace(str, expr, "");
 
     /* Convert based on user chosen currency format */
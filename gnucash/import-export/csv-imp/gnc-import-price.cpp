@@ -33,6 +33,7 @@ extern "C" {
 #include "gnc-ui-util.h" //get book
 #include "gnc-commodity.h"
 #include "gnc-pricedb.h"
+#include "gnc-locale-utils.h"
 }
 
 #include <algorithm>
@@ -47,6 +48,8 @@ extern "C" {
 #include <boost/regex/icu.hpp>
 #include <boost/optional.hpp>
 
+#include <gnc-parallel.hpp>
+
 #include "gnc-import-price.hpp"
 #include "gnc-imp-props-price.hpp"
 #include "gnc-tokenizer-csv.hpp"
@@ -382,11 +385,11 @@ void GncPriceImport::tokenize (bool guessColTypes)
     uint32_t max_cols = 0;
     m_tokenizer->tokenize();
     m_parsed_lines.clear();
-    for (auto tokenized_line : m_tokenizer->get_tokens())
+    for (size_t line_no = 0; line_no < m_tokenizer->num_lines(); ++line_no)
     {
-        auto length = tokenized_line.size();
+        auto length = m_tokenizer->num_fields (line_no);
         if (length > 0)
-            m_parsed_lines.push_back (std::make_tuple (tokenized_line, std::string(),
+            m_parsed_lines.push_back (std::make_tuple (m_tokenizer->line (line_no), std::string(),
                     std::make_shared<GncImportPrice>(date_format(), currency_format()),
                     false));
         if (length > max_cols)
@@ -745,24 +748,22 @@ GncPriceImport::set_column_type_price (uint32_t position, GncPricePropType type,
         to_currency (nullptr);
 
     /* Update the preparsed data */
-    for (auto parsed_lines_it = m_parsed_lines.begin();
-            parsed_lines_it != m_parsed_lines.end();
-            ++parsed_lines_it)
+    auto update_line = [this, position, type, old_type](uint32_t row)
     {
+        auto& parsed_line = m_parsed_lines[row];
+
         /* Reset date and currency formats for each price props object
          * to ensure column updates use the most recent one
          */
-        std::get<PL_PREPRICE>(*parsed_lines_it)->set_date_format (m_settings.m_date_format);
-        std::get<PL_PREPRICE>(*parsed_lines_it)->set_currency_format (m_settings.m_currency_format);
-
-        uint32_t row = parsed_lines_it - m_parsed_lines.begin();
+        std::get<PL_PREPRICE>(parsed_line)->set_date_format (m_settings.m_date_format);
+        std::get<PL_PREPRICE>(parsed_line)->set_currency_format (m_settings.m_currency_format);
 
         /* If the column type actually changed, first reset the property
          * represented by the old column type
          */
         if (old_type != type)
         {
-            auto old_col = std::get<PL_INPUT>(*parsed_lines_it).size(); // Deliberately out of bounds to trigger a reset!
+            auto old_col = std::get<PL_INPUT>(parsed_line).size(); // Deliberately out of bounds to trigger a reset!
             if ((old_type > GncPricePropType::NONE)
                     && (old_type <= GncPricePropType::PRICE_PROPS))
                 update_price_props (row, old_col, old_type);
@@ -773,10 +774,28 @@ GncPriceImport::set_column_type_price (uint32_t position, GncPricePropType type,
             update_price_props (row, position, type);
 
         /* Report errors if there are any */
-        auto price_errors = std::get<PL_PREPRICE>(*parsed_lines_it)->errors();
-        std::get<PL_ERROR>(*parsed_lines_it) =
+        auto price_errors = std::get<PL_PREPRICE>(parsed_line)->errors();
+        std::get<PL_ERROR>(parsed_line) =
                 price_errors +
                 (price_errors.empty() ? std::string() : "\n");
+    };
+
+    /* Each line is parsed independently, so spread the lines over several
+     * threads, except for the columns that look up commodities in the book.
+     */
+    auto uses_commodity_table = [](GncPricePropType prop)
+        { return (prop == GncPricePropType::FROM_SYMBOL) ||
+                 (prop == GncPricePropType::FROM_NAMESPACE) ||
+                 (prop == GncPricePropType::TO_CURRENCY); };
+    if (uses_commodity_table (type) || uses_commodity_table (old_type))
+    {
+        for (uint32_t row = 0; row < m_parsed_lines.size(); row++)
+            update_line (row);
+    }
+    else
+    {
+        gnc_localeconv (); // Initialize the cached locale before the threads use it
+        gnc_parallel_for (m_parsed_lines.size(), update_line);
     }
 }
 
@@ -30,6 +30,8 @@ extern "C" {
 #endif
 
 #include <glib/gi18n.h>
+
+#include <gnc-locale-utils.h>
 }
 
 #include <algorithm>
@@ -44,6 +46,8 @@ extern "C" {
 #include <boost/regex.hpp>
 #include <boost/regex/icu.hpp>
 
+#include <gnc-parallel.hpp>
+
 #include "gnc-import-tx.hpp"
 #include "gnc-imp-props-tx.hpp"
 #include "gnc-tokenizer-csv.hpp"
@@ -399,11 +403,11 @@ void GncTxImport::tokenize (bool guessColTypes)
     uint32_t max_cols = 0;
     m_tokenizer->tokenize();
     m_parsed_lines.clear();
-    for (auto tokenized_line : m_tokenizer->get_tokens())
+    for (size_t line_no = 0; line_no < m_tokenizer->num_lines(); ++line_no)
     {
-        auto length = tokenized_line.size();
+        auto length = m_tokenizer->num_fields (line_no);
         if (length > 0)
-            m_parsed_lines.push_back (std::make_tuple (tokenized_line, std::string(),
+            m_parsed_lines.push_back (std::make_tuple (m_tokenizer->line (line_no), std::string(),
                     std::make_shared<GncPreTrans>(date_format()),
                     std::make_shared<GncPreSplit>(date_format(), currency_format()),
                     false));
@@ -864,25 +868,23 @@ GncTxImport::set_column_type (uint32_t position, GncTransPropType type, bool for
 
     /* Update the preparsed data */
     m_parent = nullptr;
-    for (auto parsed_lines_it = m_parsed_lines.begin();
-            parsed_lines_it != m_parsed_lines.end();
-            ++parsed_lines_it)
+    auto update_line = [this, position, type, old_type](uint32_t row)
     {
+        auto& parsed_line = m_parsed_lines[row];
+
         /* Reset date and currency formats for each trans/split props object
          * to ensure column updates use the most recent one
          */
-        std::get<PL_PRETRANS>(*parsed_lines_it)->set_date_format (m_settings.m_date_format);
-        std::get<PL_PRESPLIT>(*parsed_lines_it)->set_date_format (m_settings.m_date_format);
-        std::get<PL_PRESPLIT>(*parsed_lines_it)->set_currency_format (m_settings.m_currency_format);
-
-        uint32_t row = parsed_lines_it - m_parsed_lines.begin();
+        std::get<PL_PRETRANS>(parsed_line)->set_date_format (m_settings.m_date_format);
+        std::get<PL_PRESPLIT>(parsed_line)->set_date_format (m_settings.m_date_format);
+        std::get<PL_PRESPLIT>(parsed_line)->set_currency_format (m_settings.m_currency_format);
 
         /* If the column type actually changed, first reset the property
          * represented by the old column type
          */
         if (old_type != type)
         {
-            auto old_col = std::get<PL_INPUT>(*parsed_lines_it).size(); // Deliberately out of bounds to trigger a reset!
+            auto old_col = std::get<PL_INPUT>(parsed_line).size(); // Deliberately out of bounds to trigger a reset!
             if ((old_type > GncTransPropType::NONE)
                     && (old_type <= GncTransPropType::TRANS_PROPS))
                 update_pre_trans_props (row, old_col, old_type);
@@ -900,13 +902,41 @@ GncTxImport::set_column_type (uint32_t position, GncTransPropType type, bool for
             update_pre_split_props (row, position, type);
 
         /* Report errors if there are any */
-        auto trans_errors = std::get<PL_PRETRANS>(*parsed_lines_it)->errors();
-        auto split_errors = std::get<PL_PRESPLIT>(*parsed_lines_it)->errors(m_req_mapped_accts);
-        std::get<PL_ERROR>(*parsed_lines_it) =
+        auto trans_errors = std::get<PL_PRETRANS>(parsed_line)->errors();
+        auto split_errors = std::get<PL_PRESPLIT>(parsed_line)->errors(m_req_mapped_accts);
+        std::get<PL_ERROR>(parsed_line) =
                 trans_errors +
                 (trans_errors.empty() && split_errors.empty() ? std::string() : "\n") +
                 split_errors;
+    };
 
+    /* Lines can be parsed independently of each other, and hence in parallel,
+     * unless lines of a multi-split transaction share their transaction
+     * properties or the column needs the engine to map account names or
+     * look up commodities, neither of which is thread-safe.
+     */
+    auto uses_engine_lookup = [](GncTransPropType prop)
+        { return (prop == GncTransPropType::ACCOUNT) ||
+                 (prop == GncTransPropType::TACCOUNT) ||
+                 (prop == GncTransPropType::COMMODITY); };
+    if (m_settings.m_multi_split || uses_engine_lookup (type) ||
+        uses_engine_lookup (old_type))
+    {
+        for (uint32_t row = 0; row < m_parsed_lines.size(); row++)
+            update_line (row);
+    }
+    else
+    {
+        /* Lines may still share the transaction properties they got in
+         * multi-split mode, give each its own before the threads modify them. */
+        for (auto& parsed_line : m_parsed_lines)
+        {
+            auto& trans_props = std::get<PL_PRETRANS>(parsed_line);
+            if (trans_props.use_count() > 1)
+                trans_props = std::make_shared<GncPreTrans> (*trans_props);
+        }
+        gnc_localeconv (); // Initialize the cached locale before the threads use it
+        gnc_parallel_for (m_parsed_lines.size(), update_line);
     }
 }
 
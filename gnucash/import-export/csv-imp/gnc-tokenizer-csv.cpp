@@ -6,14 +6,10 @@
 #include <string>
 #include <algorithm>    // copy
 #include <iterator>     // ostream_operator
-
-#include <boost/tokenizer.hpp>
-#include <boost/locale.hpp>
-#include <boost/algorithm/string.hpp>
-
-extern "C" {
-    #include <glib/gi18n.h>
-}
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <string_view>
 
 void
 GncCsvTokenizer::set_separators(const std::string& separators)
@@ -22,91 +18,172 @@ GncCsvTokenizer::set_separators(const std::string& separators)
 }
 
 
+/* The tokenizer makes a single pass over the utf8 contents. Lines are
+ * located with memchr and within a line a lookup table tells which
+ * characters need attention (separators, quotes and backslashes), so the
+ * runs of ordinary characters in between are copied into the field as a
+ * whole. The rules are the ones the file format has always been parsed
+ * with:
+ * - leading and trailing white space is stripped from each line;
+ * - a line that ends inside a quoted field continues on the next line,
+ *   joined with a space;
+ * - a double quote toggles quoting, unless it is escaped;
+ * - \" \\ and \n are escapes, any other backslash is taken literally;
+ * - "" is an escaped double quote, unless it makes up an empty field.
+ */
 int GncCsvTokenizer::tokenize()
 {
-    using Tokenizer = boost::tokenizer< boost::escaped_list_separator<char>>;
-
-    boost::escaped_list_separator<char> sep("\\", m_sep_str, "\"");
-
-    StrVec vec;
-    std::string line;
-    std::string buffer;
-
-    bool inside_quotes(false);
-    size_t last_quote(0);
-
-    m_tokenized_contents.clear();
-    std::istringstream in_stream(m_utf8_contents);
-
-    try
+    std::array<bool, 256> special{};
+    for (unsigned char c : m_sep_str)
+        special[c] = true;
+    special[static_cast<unsigned char>('"')] = true;
+    special[static_cast<unsigned char>('\\')] = true;
+
+    auto is_sep = [this](char c) { return m_sep_str.find (c) != std::string::npos; };
+    auto is_trimmable = [&is_sep](char c)
+        { return std::isspace (static_cast<unsigned char>(c)) && !is_sep (c); };
+
+    clear_tokens();
+
+    /* A field is kept as a range of the contents for as long as everything
+     * appended to it is the next verbatim part of the line. Only when that
+     * no longer holds, its text is built in scratch. */
+    const char *view = nullptr;
+    size_t view_len = 0;
+    std::string scratch;
+    bool use_scratch = false;
+    bool inside_quotes = false;
+    bool field_start = true;
+
+    auto to_scratch = [&]()
     {
-        while (std::getline (in_stream, buffer))
+        if (!use_scratch)
         {
-            // --- deal with line breaks in quoted strings
-            buffer = boost::trim_copy (buffer); // Removes trailing newline and spaces
-            last_quote = buffer.find_first_of('"');
-            while (last_quote != std::string::npos)
+            scratch.assign (view ? view : "", view_len);
+            use_scratch = true;
+        }
+    };
+    auto append_source = [&](const char *src, size_t len)
+    {
+        if (!use_scratch && (view_len == 0 || view + view_len == src))
+        {
+            if (view_len == 0)
+                view = src;
+            view_len += len;
+        }
+        else
+        {
+            to_scratch();
+            scratch.append (src, len);
+        }
+    };
+    auto append_char = [&](char c)
+    {
+        to_scratch();
+        scratch.push_back (c);
+    };
+    auto end_field = [&]()
+    {
+        if (use_scratch)
+            add_own_field (scratch);
+        else
+            add_field (view ? view : m_utf8_contents.data(), view_len);
+        view = nullptr;
+        view_len = 0;
+        scratch.clear();
+        use_scratch = false;
+        field_start = true;
+    };
+
+    const char *pos = m_utf8_contents.data();
+    const char *contents_end = pos + m_utf8_contents.size();
+    while (pos < contents_end)
+    {
+        auto eol = static_cast<const char*>(memchr (pos, '\n', contents_end - pos));
+        if (!eol)
+            eol = contents_end;
+        std::string_view line (pos, eol - pos);
+        pos = eol + 1;
+
+        while (!line.empty() && is_trimmable (line.front()))
+            line.remove_prefix (1);
+        while (!line.empty() && is_trimmable (line.back()))
+            line.remove_suffix (1);
+
+        size_t i = 0;
+        while (i < line.size())
+        {
+            auto run = i;
+            while (run < line.size() &&
+                   !special[static_cast<unsigned char>(line[run])])
+                ++run;
+            if (run > i)
             {
-                if (last_quote == 0) // Test separately because last_quote - 1 would be out of range
-                    inside_quotes = !inside_quotes;
-                else if (buffer[ last_quote - 1 ] != '\\')
-                    inside_quotes = !inside_quotes;
-
-                last_quote = buffer.find_first_of('"',last_quote+1);
+                append_source (line.data() + i, run - i);
+                field_start = false;
+                i = run;
+                continue;
             }
 
-            line.append(buffer);
-            if (inside_quotes)
+            auto c = line[i];
+            if (c == '\\')
             {
-                line.append(" ");
-                continue;
+                auto next = (i + 1 < line.size()) ? line[i + 1] : '\0';
+                if (next == '"' || next == '\\')
+                {
+                    append_source (line.data() + i + 1, 1);
+                    i += 2;
+                }
+                else if (next == 'n')
+                {
+                    append_char ('\n');
+                    i += 2;
+                }
+                else
+                {
+                    append_source (line.data() + i, 1);
+                    ++i;
+                }
+                field_start = false;
             }
-            // ---
-
-            // Deal with backslashes that are not meant to be escapes
-            // The boost::tokenizer with escaped_list_separator as we use
-            // it would choke on this.
-            auto bs_pos = line.find ('\\');
-            while (bs_pos != std::string::npos)
+            else if (c == '"')
+            {
+                if (i + 1 < line.size() && line[i + 1] == '"')
+                {
+                    // Either an empty quoted field or an escaped double quote
+                    if (!(field_start &&
+                          (i + 2 >= line.size() || is_sep (line[i + 2]))))
+                        append_source (line.data() + i, 1);
+                    i += 2;
+                }
+                else
+                {
+                    inside_quotes = !inside_quotes;
+                    ++i;
+                }
+                field_start = false;
+            }
+            else if (inside_quotes)
             {
-                if ((bs_pos == line.size()) ||                                 // got trailing single backslash
-                    (line.find_first_of ("\"\\n", bs_pos + 1) != bs_pos + 1))  // backslash is not part of known escapes \\, \" or \n
-                    line = line.substr(0, bs_pos) + "\\\\" + line.substr(bs_pos + 1);
-                bs_pos += 2;
-                bs_pos = line.find ('\\', bs_pos);
+                append_source (line.data() + i, 1);
+                ++i;
             }
-
-            // Deal with repeated " ("") in strings.
-            // This is commonly used as escape mechanism for double quotes in csv files.
-            // However boost just eats them.
-            bs_pos = line.find ("\"\"");
-            while (bs_pos != std::string::npos)
+            else
             {
-                // Only make changes in case the double quotes are part of a larger field
-                // In other words a field which only contains two double quotes represent an
-                // empty field. We don't need to touch those.
-                // The way to determine whether the double quotes represent an empty string
-                // is by checking whether the character in front or after are either
-                // a field separator or the beginning or end of of the string.
-                if (!(((bs_pos == 0) ||                                          // quotes are at start of line
-                       (m_sep_str.find (line[bs_pos-1]) != std::string::npos))    // quotes preceded by field separator
-                      &&
-                      ((bs_pos + 2 >= line.length()) ||                          // quotes are at end of line
-                       (m_sep_str.find (line[bs_pos+2]) != std::string::npos))))   // quotes followed by field separator
-                    // Only make changes in case the double quotes are not an empty field
-                    line.replace (bs_pos, 2, "\\\"");
-                bs_pos = line.find ("\"\"", bs_pos + 2);
+                end_field();
+                ++i;
             }
+        }
 
-            Tokenizer tok(line, sep);
-            vec.assign(tok.begin(),tok.end());
-            m_tokenized_contents.push_back(vec);
-            line.clear();
+        if (inside_quotes && pos < contents_end)
+        {
+            append_char (' ');
+            continue;
         }
-    }
-    catch (boost::escaped_list_error &e)
-    {
-        throw (std::range_error N_("There was an error parsing the file."));
+
+        end_field();
+        end_line();
+        inside_quotes = false;
     }
 
     return 0;
@@ -24,6 +24,8 @@
      @brief Class to convert a csv file into vector of string vectors.
      One can define the separator characters to use to split each line
      into multiple fields. Quote characters will be removed.
+     The contents are tokenized in a single pass without building
+     intermediate per-line strings.
      However, no gnucash specific interpretation is done yet, that's up
      to the code using this class.
      *
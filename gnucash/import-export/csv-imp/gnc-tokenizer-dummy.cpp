@@ -12,19 +12,19 @@
 
 int GncDummyTokenizer::tokenize()
 {
-    StrVec vec;
-    std::string line;
+    clear_tokens();
 
-    m_tokenized_contents.clear();
-    std::istringstream in_stream(m_utf8_contents);
-
-    while (std::getline (in_stream, line))
+    /* Each line becomes a single field, a final line break doesn't
+     * start another line. */
+    size_t start = 0;
+    while (start < m_utf8_contents.size())
     {
-        vec.push_back (line);
-        m_tokenized_contents.push_back(vec);
-
-        line.clear();
-        vec.clear();
+        auto eol = m_utf8_contents.find ('\n', start);
+        if (eol == std::string::npos)
+            eol = m_utf8_contents.size();
+        add_field (m_utf8_contents.data() + start, eol - start);
+        end_line();
+        start = eol + 1;
     }
 
     return 0;
@@ -170,24 +170,22 @@ int GncFwTokenizer::tokenize()
     std::wstring wchar_contents = utf_to_utf<wchar_t>(m_utf8_contents.c_str(),
         m_utf8_contents.c_str() + m_utf8_contents.size());
 
-    StrVec vec;
     std::wstring line;
 
-    m_tokenized_contents.clear();
+    clear_tokens();
     std::wistringstream in_stream(wchar_contents);
 
     while (std::getline (in_stream, line))
     {
         Tokenizer tok(line, sep);
-        vec.clear();
         for (auto token : tok)
         {
             auto stripped = boost::trim_copy(token); // strips newlines as well as whitespace
             auto narrow = utf_to_utf<char>(stripped.c_str(), stripped.c_str()
                 + stripped.size());
-            vec.push_back (narrow);
+            add_own_field (narrow);
         }
-        m_tokenized_contents.push_back(vec);
+        end_line();
         line.clear(); // clear here, next check could fail
     }
 
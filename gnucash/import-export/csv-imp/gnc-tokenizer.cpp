@@ -85,6 +85,9 @@ GncTokenizer::encoding(const std::string& encoding)
     // That's what STL expects by default
     boost::replace_all (m_utf8_contents, "\r\n", "\n");
     boost::replace_all (m_utf8_contents, "\r", "\n");
+
+    // Tokens refer to the previous contents
+    clear_tokens();
 }
 
 const std::string&
@@ -94,8 +97,71 @@ GncTokenizer::encoding()
 }
 
 
-const std::vector<StrVec>&
-GncTokenizer::get_tokens()
+void
+GncTokenizer::clear_tokens()
+{
+    m_fields.clear();
+    m_line_starts.assign (1, 0);
+    m_field_text.clear();
+}
+
+void
+GncTokenizer::add_field(const char *begin, size_t length)
+{
+    m_fields.push_back ({static_cast<size_t>(begin - m_utf8_contents.data()),
+                         static_cast<uint32_t>(length), false});
+}
+
+void
+GncTokenizer::add_own_field(std::string_view text)
+{
+    m_fields.push_back ({m_field_text.size(), static_cast<uint32_t>(text.size()), true});
+    m_field_text.append (text);
+}
+
+void
+GncTokenizer::end_line()
+{
+    m_line_starts.push_back (m_fields.size());
+}
+
+size_t
+GncTokenizer::num_lines() const noexcept
+{
+    return m_line_starts.size() - 1;
+}
+
+size_t
+GncTokenizer::num_fields(size_t line_no) const noexcept
+{
+    return m_line_starts[line_no + 1] - m_line_starts[line_no];
+}
+
+std::string_view
+GncTokenizer::field(size_t line_no, size_t col) const noexcept
+{
+    auto& fld = m_fields[m_line_starts[line_no] + col];
+    auto& text = fld.own_text ? m_field_text : m_utf8_contents;
+    return std::string_view (text.data() + fld.offset, fld.length);
+}
+
+StrVec
+GncTokenizer::line(size_t line_no) const
+{
+    StrVec vec;
+    vec.reserve (num_fields (line_no));
+    for (size_t col = 0; col < num_fields (line_no); ++col)
+        vec.emplace_back (field (line_no, col));
+    return vec;
+}
+
+/* Copies all tokens, prefer line() for large files. */
+std::vector<StrVec>
+GncTokenizer::get_tokens() const
 {
-    return m_tokenized_contents;
+    std::vector<StrVec> tokens;
+    tokens.reserve (num_lines());
+    for (size_t line_no = 0; line_no < num_lines(); ++line_no)
+        tokens.push_back (line (line_no));
+    return tokens;
 }
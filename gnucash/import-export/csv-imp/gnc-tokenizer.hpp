@@ -43,7 +43,9 @@ extern "C" {
 #include <fstream>      // fstream
 #include <vector>
 #include <string>
+#include <string_view>
 #include <memory>
+#include <cstdint>
 
 using StrVec = std::vector<std::string>;
 
@@ -72,13 +74,36 @@ public:
     void encoding(const std::string& encoding);
     const std::string& encoding();
     virtual int  tokenize() = 0;
-    const std::vector<StrVec>& get_tokens();
+    std::vector<StrVec> get_tokens() const;
+    size_t num_lines() const noexcept;
+    size_t num_fields(size_t line_no) const noexcept;
+    std::string_view field(size_t line_no, size_t col) const noexcept;
+    StrVec line(size_t line_no) const;
 
 protected:
+    void clear_tokens();
+    void add_field(const char *begin, size_t length);
+    void add_own_field(std::string_view text);
+    void end_line();
+
     std::string m_utf8_contents;
-    std::vector<StrVec> m_tokenized_contents;
 
 private:
+    /* Tokenized fields are kept as ranges rather than as separate strings.
+     * Most fields are a verbatim part of the utf8 contents, only the ones
+     * that had to be rewritten (unescaped, joined or converted) get their
+     * text stored in m_field_text.
+     */
+    struct TokenField
+    {
+        size_t offset;
+        uint32_t length;
+        bool own_text;
+    };
+    std::vector<TokenField> m_fields;
+    std::vector<size_t> m_line_starts{0};   // index of each line's first field
+    std::string m_field_text;
+
     std::string m_imp_file_str;
     std::string m_raw_contents;
     std::string m_enc_str;
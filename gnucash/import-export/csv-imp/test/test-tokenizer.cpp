@@ -127,6 +127,13 @@ TEST_F (GncTokenizerTest, tokenize_from_csv_file)
     EXPECT_EQ(8ul, tokens[1].size());
     EXPECT_EQ(std::string("Date"), tokens.at(0).at(0));
     EXPECT_EQ(std::string("1,100.00"), tokens.at(1).at(6));
+
+    /* The same fields without copying the whole table */
+    EXPECT_EQ(2ul, csv_tok->num_lines());
+    EXPECT_EQ(8ul, csv_tok->num_fields(1));
+    EXPECT_EQ("Acme Inc.", csv_tok->field(1, 2));
+    EXPECT_EQ("1,100.00", csv_tok->field(1, 6));
+    EXPECT_EQ(tokens.at(1), csv_tok->line(1));
 }
 
 /* Test parsing for several different prepared strings
@@ -179,6 +186,8 @@ static tokenize_csv_test_data comma_separated [] = {
         { "Test with \\\" escaped quote,nextfield", 2, { "Test with \" escaped quote","nextfield",NULL,NULL,NULL,NULL,NULL,NULL } },
         { "Test with \"\" escaped quote,nextfield", 2, { "Test with \" escaped quote","nextfield",NULL,NULL,NULL,NULL,NULL,NULL } },
         { "\"Unescaped quote test\",nextfield", 2, { "Unescaped quote test","nextfield",NULL,NULL,NULL,NULL,NULL,NULL } },
+        { "\"Quoted field\n  spanning lines\",nextfield", 2, { "Quoted field spanning lines","nextfield",NULL,NULL,NULL,NULL,NULL,NULL } },
+        { "\"Quoted \"\"word\"\" and separator,\",nextfield", 2, { "Quoted \"word\" and separator,","nextfield",NULL,NULL,NULL,NULL,NULL,NULL } },
         { NULL, 0, { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL } },
 };
 
@@ -40,6 +40,7 @@
 #include "Account.h"
 #include "Query.h"
 #include "gnc-engine.h"
+#include "gnc-event.h"
 #include "engine-helpers.h"
 #include "gnc-prefs.h"
 #include "gnc-ui-util.h"
@@ -618,11 +619,19 @@ matchmap_store_destination (GncImportMatchMap *matchmap,
 
 
 /** @brief The transaction matching heuristics are here.
+ *
+ * The amounts and dates of both splits are passed in so that the match
+ * index only has to compute them once per split.
  */
-void split_find_match (GNCImportTransInfo * trans_info,
-                              Split * split,
-                              gint display_threshold,
-                              double fuzzy_amount_difference)
+static void
+score_candidate (GNCImportTransInfo * trans_info,
+                 Split * split,
+                 double downloaded_split_amount,
+                 double match_split_amount,
+                 time64 download_time,
+                 time64 match_time,
+                 gint display_threshold,
+                 double fuzzy_amount_difference)
 {
     /* DEBUG("Begin"); */
 
@@ -633,8 +642,6 @@ void split_find_match (GNCImportTransInfo * trans_info,
         GNCImportMatchInfo * match_info;
         gint prob = 0;
         gboolean update_proposed;
-        double downloaded_split_amount, match_split_amount;
-        time64 match_time, download_time;
         int datediff_day;
         Transaction *new_trans = gnc_import_TransInfo_get_trans (trans_info);
         Split *new_trans_fsplit = gnc_import_TransInfo_get_fsplit (trans_info);
@@ -642,11 +649,6 @@ void split_find_match (GNCImportTransInfo * trans_info,
         /* Matching heuristics */
 
         /* Amount heuristics */
-        downloaded_split_amount =
-            gnc_numeric_to_double (xaccSplitGetAmount(new_trans_fsplit));
-        /*DEBUG(" downloaded_split_amount=%f", downloaded_split_amount);*/
-        match_split_amount = gnc_numeric_to_double(xaccSplitGetAmount(split));
-        /*DEBUG(" match_split_amount=%f", match_split_amount);*/
         if (fabs(downloaded_split_amount - match_split_amount) < 1e-6)
             /* bug#347791: Double type shouldn't be compared for exact
                equality, so we're using fabs() instead. */
@@ -677,8 +679,6 @@ void split_find_match (GNCImportTransInfo * trans_info,
         }
 
         /* Date heuristics */
-        match_time = xaccTransGetDate (xaccSplitGetParent (split));
-        download_time = xaccTransGetDate (new_trans);
         datediff_day = llabs(match_time - download_time) / 86400;
         /* Sorry, there are not really functions around at all that
         	 provide for less hacky calculation of days of date
@@ -827,7 +827,228 @@ void split_find_match (GNCImportTransInfo * trans_info,
             g_list_prepend(trans_info->match_list,
                            match_info);
     }
-}/* end split_find_match */
+}/* end score_candidate */
+
+void split_find_match (GNCImportTransInfo * trans_info,
+                       Split * split,
+                       gint display_threshold,
+                       double fuzzy_amount_difference)
+{
+    Split *new_trans_fsplit = gnc_import_TransInfo_get_fsplit (trans_info);
+
+    score_candidate (trans_info, split,
+                     gnc_numeric_to_double (xaccSplitGetAmount (new_trans_fsplit)),
+                     gnc_numeric_to_double (xaccSplitGetAmount (split)),
+                     xaccTransGetDate (gnc_import_TransInfo_get_trans (trans_info)),
+                     xaccTransGetDate (xaccSplitGetParent (split)),
+                     display_threshold, fuzzy_amount_difference);
+}
+
+/********************************************************************\
+ *   Candidate index used by the main matcher                       *
+\********************************************************************/
+
+/* The best the amount and date heuristics can do for a candidate that is
+ * outside the fuzzy amount range or more than MATCH_DATE_NOT_THRESHOLD
+ * days away: one of them scores -5, the other at most +3.
+ */
+static const int MATCH_OUT_OF_RANGE_MAX_SCORE = -5 + 3;
+
+typedef struct
+{
+    Split *split;
+    double amount;
+    time64 date;
+    /* Position in the candidate list the index was built from. */
+    guint seq;
+} MatchCandidate;
+
+struct _GNCImportMatchIndex
+{
+    /* Account* -> GArray of MatchCandidate, sorted by amount then date. */
+    GHashTable *account_hash;
+};
+
+static gint
+compare_candidates (gconstpointer a, gconstpointer b)
+{
+    const MatchCandidate *ca = a;
+    const MatchCandidate *cb = b;
+
+    if (ca->amount != cb->amount)
+        return ca->amount < cb->amount ? -1 : 1;
+    if (ca->date != cb->date)
+        return ca->date < cb->date ? -1 : 1;
+    return 0;
+}
+
+static void
+sort_candidates (gpointer key, gpointer value, gpointer user_data)
+{
+    g_array_sort ((GArray*) value, compare_candidates);
+}
+
+GNCImportMatchIndex *
+gnc_import_MatchIndex_new (GList *candidate_splits)
+{
+    GNCImportMatchIndex *index = g_new0 (GNCImportMatchIndex, 1);
+    guint seq = 0;
+
+    index->account_hash =
+        g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+                               (GDestroyNotify) g_array_unref);
+
+    for (GList *node = candidate_splits; node; node = g_list_next (node), ++seq)
+    {
+        Split *split = node->data;
+        Account *account;
+        GArray *candidates;
+        MatchCandidate candidate;
+
+        if (gnc_import_split_has_online_id (split))
+            continue;
+
+        account = xaccSplitGetAccount (split);
+        candidates = g_hash_table_lookup (index->account_hash, account);
+        if (!candidates)
+        {
+            candidates = g_array_new (FALSE, FALSE, sizeof (MatchCandidate));
+            g_hash_table_insert (index->account_hash, account, candidates);
+        }
+        candidate.split = split;
+        candidate.amount = gnc_numeric_to_double (xaccSplitGetAmount (split));
+        candidate.date = xaccTransGetDate (xaccSplitGetParent (split));
+        candidate.seq = seq;
+        g_array_append_val (candidates, candidate);
+    }
+    g_hash_table_foreach (index->account_hash, sort_candidates, NULL);
+    return index;
+}
+
+void
+gnc_import_MatchIndex_destroy (GNCImportMatchIndex *index)
+{
+    if (!index)
+        return;
+    g_hash_table_destroy (index->account_hash);
+    g_free (index);
+}
+
+/* The most the check number, memo and description heuristics can add to
+ * the score of any candidate for trans_info. */
+static gint
+max_text_score (const GNCImportTransInfo *trans_info)
+{
+    const char *str;
+    gint score = 0;
+
+    str = gnc_get_num_action (trans_info->trans, trans_info->first_split);
+    if (str && *str)
+        score += 4;
+    str = xaccSplitGetMemo (trans_info->first_split);
+    if (str && *str)
+        score += 2;
+    str = xaccTransGetDescription (trans_info->trans);
+    if (str && *str)
+        score += 2;
+    return score;
+}
+
+/* Sorts candidates into reverse candidate list order. */
+static gint
+compare_candidates_seq_desc (gconstpointer a, gconstpointer b)
+{
+    const MatchCandidate *ca = *(const MatchCandidate **) a;
+    const MatchCandidate *cb = *(const MatchCandidate **) b;
+
+    return ca->seq < cb->seq ? 1 : (ca->seq > cb->seq ? -1 : 0);
+}
+
+/* Index of the first candidate whose amount is not below amount. */
+static guint
+candidates_lower_bound (const GArray *candidates, double amount)
+{
+    guint lo = 0, hi = candidates->len;
+
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+        if (g_array_index (candidates, MatchCandidate, mid).amount < amount)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+void
+gnc_import_MatchIndex_find_matches (const GNCImportMatchIndex *index,
+                                    GNCImportTransInfo *trans_info,
+                                    gint display_threshold,
+                                    double fuzzy_amount_difference)
+{
+    GArray *candidates;
+    GPtrArray *in_range;
+    Split *fsplit;
+    double amount, window;
+    time64 date;
+    guint first = 0, last;
+    gboolean prune;
+
+    g_return_if_fail (index && trans_info);
+
+    fsplit = gnc_import_TransInfo_get_fsplit (trans_info);
+    candidates = g_hash_table_lookup (index->account_hash,
+                                      xaccSplitGetAccount (fsplit));
+    if (!candidates)
+        return;
+
+    amount = gnc_numeric_to_double (xaccSplitGetAmount (fsplit));
+    date = xaccTransGetDate (trans_info->trans);
+    last = candidates->len;
+
+    /* Only when a candidate that is far off in amount or date cannot
+       reach the display threshold are we allowed to skip it. */
+    prune = (max_text_score (trans_info) + MATCH_OUT_OF_RANGE_MAX_SCORE <
+             display_threshold);
+    if (prune)
+    {
+        /* split_find_match treats amounts within 1e-6 as equal. */
+        window = MAX (fuzzy_amount_difference, 1e-6);
+        first = candidates_lower_bound (candidates, amount - window);
+        last = candidates_lower_bound (candidates, amount + window);
+        while (last < candidates->len &&
+               g_array_index (candidates, MatchCandidate, last).amount -
+               amount <= window)
+            ++last;
+    }
+
+    in_range = g_ptr_array_sized_new (last - first);
+    for (guint i = first; i < last; ++i)
+    {
+        MatchCandidate *candidate =
+            &g_array_index (candidates, MatchCandidate, i);
+
+        if (prune &&
+            llabs (candidate->date - date) / 86400 > MATCH_DATE_NOT_THRESHOLD)
+            continue;
+        g_ptr_array_add (in_range, candidate);
+    }
+
+    /* score_candidate prepends to the match list. Scoring in reverse list
+       order leaves the matches in candidate list order, so that matches
+       with equal scores keep the order split_find_match gave them. */
+    g_ptr_array_sort (in_range, compare_candidates_seq_desc);
+    for (guint i = 0; i < in_range->len; ++i)
+    {
+        const MatchCandidate *candidate = g_ptr_array_index (in_range, i);
+
+        score_candidate (trans_info, candidate->split, amount,
+                         candidate->amount, date, candidate->date,
+                         display_threshold, fuzzy_amount_difference);
+    }
+    g_ptr_array_free (in_range, TRUE);
+}
 
 /***********************************************************************
  */
@@ -1051,93 +1272,168 @@ gnc_import_process_trans_item (GncImportMatchMap *matchmap,
 }
 
 /********************************************************************\
- * check_trans_online_id() Callback function used by
- * gnc_import_exists_online_id.  Takes pointers to transaction and split,
- * returns 0 if their online_ids  do NOT match, or if the split
- * belongs to the transaction
+ * Per-account online_id index used by gnc_import_exists_online_id.
+ *
+ * The index of an account is built from the online_id slots of its
+ * transactions and splits the first time the account is checked, is
+ * attached to the account object and is kept current from the account's
+ * split added/changed/removed events, so it survives across imports.
 \********************************************************************/
-static gint check_trans_online_id(Transaction *trans1, void *user_data)
-{
-    Account *account;
-    Split *split1;
-    Split *split2 = user_data;
-    const gchar *online_id1;
-    const gchar *online_id2;
-
-    account = xaccSplitGetAccount(split2);
-    split1 = xaccTransFindSplitByAccount(trans1, account);
-    if (split1 == split2)
-        return 0;
 
-    /* hack - we really want to iterate over the _splits_ of the account
-       instead of the transactions */
-    g_assert(split1 != NULL);
+#define ONLINE_ID_INDEX_KEY "gnc-import-online-id-index"
 
-    if (gnc_import_split_has_online_id(split1))
-        online_id1 = gnc_import_get_split_online_id(split1);
-    else
-        online_id1 = gnc_import_get_trans_online_id(trans1);
+typedef struct
+{
+    /* online_id -> number of the account's splits carrying it. */
+    GHashTable *id_counts;
+    /* Split* -> GSList of the online_ids counted for that split. */
+    GHashTable *split_ids;
+} OnlineIdIndex;
 
-    online_id2 = gnc_import_get_split_online_id(split2);
+static gint online_id_handler_id = 0;
 
-    if ((online_id1 == NULL) ||
-            (online_id2 == NULL) ||
-            (strcmp(online_id1, online_id2) != 0))
+static gchar *
+instance_online_id (gpointer instance)
+{
+    gchar *id = NULL;
+    qof_instance_get (QOF_INSTANCE (instance), "online-id", &id, NULL);
+    if (id && !*id)
     {
-        return 0;
+        g_free (id);
+        id = NULL;
     }
-    else
+    return id;
+}
+
+static void
+free_id_list (gpointer ids)
+{
+    g_slist_free_full (ids, g_free);
+}
+
+static void
+online_id_index_destroy (OnlineIdIndex *index)
+{
+    g_hash_table_destroy (index->split_ids);
+    g_hash_table_destroy (index->id_counts);
+    g_free (index);
+}
+
+static void
+online_id_index_forget_split (OnlineIdIndex *index, Split *split)
+{
+    GSList *ids = g_hash_table_lookup (index->split_ids, split);
+
+    for (GSList *node = ids; node; node = node->next)
     {
-        /*printf("test_trans_online_id(): Duplicate found\n");*/
-        return 1;
+        guint count = GPOINTER_TO_UINT (g_hash_table_lookup (index->id_counts,
+                                                             node->data));
+        if (count > 1)
+            g_hash_table_insert (index->id_counts, g_strdup (node->data),
+                                 GUINT_TO_POINTER (count - 1));
+        else
+            g_hash_table_remove (index->id_counts, node->data);
     }
+    g_hash_table_remove (index->split_ids, split);
 }
 
-static gint collect_trans_online_id(Transaction *trans, void *user_data)
+/* An account split is known by its transaction's online_id and by the
+ * online_ids of all of the transaction's splits. */
+static void
+online_id_index_add_split (OnlineIdIndex *index, Split *split)
 {
-    Split *split;
-    GHashTable *id_hash = user_data;
-    int i=0;
-    
-    const gchar* online_id = gnc_import_get_trans_online_id (trans);
-    if (online_id)
-        g_hash_table_add (id_hash, (void*) online_id);
-
-    for (GList *splits = xaccTransGetSplitList (trans); splits; splits = splits->next)
+    Transaction *trans = xaccSplitGetParent (split);
+    GSList *ids = NULL;
+    gchar *id;
+
+    if (!trans)
+        return;
+    if ((id = instance_online_id (trans)))
+        ids = g_slist_prepend (ids, id);
+    for (GList *node = xaccTransGetSplitList (trans); node; node = node->next)
+        if ((id = instance_online_id (node->data)))
+            ids = g_slist_prepend (ids, id);
+    if (!ids)
+        return;
+
+    for (GSList *node = ids; node; node = node->next)
     {
-        if (gnc_import_split_has_online_id (splits->data))
-            g_hash_table_add(id_hash, (void*) gnc_import_get_split_online_id (splits->data));
+        guint count = GPOINTER_TO_UINT (g_hash_table_lookup (index->id_counts,
+                                                             node->data));
+        g_hash_table_insert (index->id_counts, g_strdup (node->data),
+                             GUINT_TO_POINTER (count + 1));
     }
-    return 0;
+    g_hash_table_insert (index->split_ids, split, ids);
+}
+
+static void
+online_id_event_handler (QofInstance *entity, QofEventId event_type,
+                         gpointer handler_data, gpointer event_data)
+{
+    OnlineIdIndex *index;
+    Split *split = event_data;
+
+    if (!(event_type & (GNC_EVENT_ITEM_ADDED | GNC_EVENT_ITEM_CHANGED |
+                        GNC_EVENT_ITEM_REMOVED)) || !GNC_IS_ACCOUNT (entity))
+        return;
+    index = g_object_get_data (G_OBJECT (entity), ONLINE_ID_INDEX_KEY);
+    if (!index || !split)
+        return;
+
+    online_id_index_forget_split (index, split);
+    if (!(event_type & GNC_EVENT_ITEM_REMOVED))
+        online_id_index_add_split (index, split);
+}
+
+static OnlineIdIndex *
+online_id_index_for_account (Account *account)
+{
+    OnlineIdIndex *index = g_object_get_data (G_OBJECT (account),
+                                              ONLINE_ID_INDEX_KEY);
+    if (index)
+        return index;
+
+    if (!online_id_handler_id)
+        online_id_handler_id =
+            qof_event_register_handler (online_id_event_handler, NULL);
+
+    index = g_new0 (OnlineIdIndex, 1);
+    index->id_counts = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                              g_free, NULL);
+    index->split_ids = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                              NULL, free_id_list);
+    for (GList *node = xaccAccountGetSplitList (account); node; node = node->next)
+        online_id_index_add_split (index, node->data);
+
+    g_object_set_data_full (G_OBJECT (account), ONLINE_ID_INDEX_KEY, index,
+                            (GDestroyNotify) online_id_index_destroy);
+    return index;
 }
 
 /** Checks whether the given transaction's online_id already exists in
   its parent account. */
-gboolean gnc_import_exists_online_id (Transaction *trans, GHashTable* acct_id_hash)
+gboolean gnc_import_exists_online_id (Transaction *trans)
 {
     gboolean online_id_exists = FALSE;
     Account *dest_acct;
     Split *source_split;
+    gchar *online_id;
 
     /* Look for an online_id in the first split */
     source_split = xaccTransGetSplit(trans, 0);
     g_assert(source_split);
 
-    // No online id, no point in continuing. We'd crash if we tried.
-    if (!gnc_import_get_split_online_id (source_split))
+    // No online id, no point in continuing.
+    online_id = instance_online_id (source_split);
+    if (!online_id)
         return FALSE;
-    // Create a hash per account of a hash of all transactions IDs. Then the test below will be fast if
-    // we have many transactions to import.
+
     dest_acct = xaccSplitGetAccount (source_split);
-    if (!g_hash_table_contains (acct_id_hash, dest_acct))
-    {
-        GHashTable* new_hash = g_hash_table_new (g_str_hash, g_str_equal);
-        g_hash_table_insert (acct_id_hash, dest_acct, new_hash);
-        xaccAccountForEachTransaction (dest_acct, collect_trans_online_id, new_hash);
-    }
-    online_id_exists = g_hash_table_contains (g_hash_table_lookup (acct_id_hash, dest_acct),
-                                              gnc_import_get_split_online_id (source_split));
-    
+    online_id_exists =
+        g_hash_table_contains (online_id_index_for_account (dest_acct)->id_counts,
+                               online_id);
+    g_free (online_id);
+
     /* If it does, abort the process for this transaction, since it is
        already in the system. */
     if (online_id_exists == TRUE)
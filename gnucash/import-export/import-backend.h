@@ -62,9 +62,14 @@ typedef enum _action
  * editing. If a matching online_id exists, the transaction is
  * destroyed (!) and TRUE is returned, otherwise FALSE is returned.
  *
+ * The online_ids of an account are indexed the first time it is
+ * checked and the index is kept up to date as splits are added to,
+ * changed in or removed from the account, so each check is a hash
+ * lookup.
+ *
  * @param trans The transaction for which to check for an existing
  * online_id. */
-gboolean gnc_import_exists_online_id (Transaction *trans, GHashTable* acct_id_hash);
+gboolean gnc_import_exists_online_id (Transaction *trans);
 
 /** Evaluates the match between trans_info and split using the provided parameters.
  *
@@ -81,6 +86,46 @@ void split_find_match (GNCImportTransInfo * trans_info,
                        gint display_threshold,
                        double fuzzy_amount_difference);
 
+/** Opaque index of the register splits that are candidates for matching
+ * imported transactions. It is built once per import; candidates are
+ * grouped by account and sorted by amount so that only candidates close
+ * enough in amount and date to reach the display threshold are scored.
+ */
+typedef struct _GNCImportMatchIndex GNCImportMatchIndex;
+
+/** Create a match index from a list of candidate splits, typically the
+ * result of a split query over the imported accounts and date range.
+ * Splits that already carry an online_id are not considered candidates.
+ *
+ * @param candidate_splits A GList of Split*. The list is not retained.
+ *
+ * @return A new GNCImportMatchIndex; free it with
+ * gnc_import_MatchIndex_destroy().
+ */
+GNCImportMatchIndex *gnc_import_MatchIndex_new (GList *candidate_splits);
+
+void gnc_import_MatchIndex_destroy (GNCImportMatchIndex *index);
+
+/** Evaluates all candidates of the index that can possibly reach
+ * display_threshold against trans_info, adding the matches to its match
+ * list exactly as split_find_match() would.
+ *
+ * The index is not modified, so this may be called for different
+ * trans_infos from several threads at once.
+ *
+ * @param index The candidate index.
+ *
+ * @param trans_info The TransInfo for the imported transaction
+ *
+ * @param display_threshold Minimum match score to include split in the list of matches.
+ *
+ * @param fuzzy_amount_difference Maximum amount difference to consider the match good.
+ */
+void gnc_import_MatchIndex_find_matches (const GNCImportMatchIndex *index,
+                                         GNCImportTransInfo *trans_info,
+                                         gint display_threshold,
+                                         double fuzzy_amount_difference);
+
 /** Iterates through all splits of the originating account of
  * trans_info. Sorts the resulting list and sets the selected_match
  * and action fields in the trans_info.
@@ -76,7 +76,6 @@ struct _main_matcher_info
     gboolean add_toggled;     // flag to indicate that add has been toggled to stop selection
     gint id;
     GSList* temp_trans_list;  // Temporary list of imported transactions
-    GHashTable* acct_id_hash; // Hash table, per account, of list of transaction IDs.
     GSList* edited_accounts;  // List of accounts currently edited.
 };
 
@@ -144,14 +143,6 @@ static gboolean query_tooltip_tree_view_cb (GtkWidget *widget, gint x, gint y,
                                             gpointer user_data);
 /* end local prototypes */
 
-static
-gboolean delete_hash (gpointer key, gpointer value, gpointer user_data)
-{
-    // Value is a hash table that needs to be destroyed.
-    g_hash_table_destroy (value);
-    return TRUE;
-}
-
 static void
 update_all_balances (GNCImportMainMatcher *info)
 {
@@ -217,9 +208,6 @@ gnc_gen_trans_list_delete (GNCImportMainMatcher *info)
 
     // We've deferred balance computations on many accounts. Let's do it now that we're done.
     update_all_balances (info);
-
-    g_hash_table_foreach_remove (info->acct_id_hash, delete_hash, NULL);
-    info->acct_id_hash = NULL;
     g_free (info);
 }
 
@@ -1132,8 +1120,6 @@ gnc_gen_trans_init_view (GNCImportMainMatcher *info,
                       G_CALLBACK(gnc_gen_trans_onButtonPressed_cb), info);
     g_signal_connect (view, "popup-menu",
                       G_CALLBACK(gnc_gen_trans_onPopupMenu_cb), info);
-
-    info->acct_id_hash = g_hash_table_new (g_direct_hash, g_direct_equal);
 }
 
 static void
@@ -1710,7 +1696,7 @@ gnc_gen_trans_list_add_trans_with_ref_id (GNCImportMainMatcher *gui, Transaction
     g_assert (gui);
     g_assert (trans);
 
-    if (gnc_import_exists_online_id (trans, gui->acct_id_hash))
+    if (gnc_import_exists_online_id (trans))
         return;
     else
     {
@@ -1771,59 +1757,60 @@ query_imported_transaction_accounts (GNCImportMainMatcher *gui)
     return retval;
 }
 
-/* Create a hash by account of all splits that could match one of the imported
- * transactions based on their account and date and organized per account.
- */
-static GHashTable*
-create_hash_of_potential_matches (GList *candidate_txns,
-                                  GHashTable *account_hash)
-{
-    for (GList* candidate = candidate_txns; candidate != NULL;
-         candidate = g_list_next (candidate))
-    {
-        Account* split_account;
-        GSList* split_list;
-        if (gnc_import_split_has_online_id (candidate->data))
-            continue;
-        split_account = xaccSplitGetAccount (candidate->data);
-        /* g_hash_table_steal_extended would do the two calls in one shot but is
-         * not available until GLib 2.58.
-         */
-        split_list = g_hash_table_lookup (account_hash, split_account);
-        g_hash_table_steal (account_hash, split_account);
-        split_list = g_slist_prepend (split_list, candidate->data);
-        g_hash_table_insert (account_hash, split_account, split_list);
-    }
-    return account_hash;
-}
-
 typedef struct _match_struct
 {
-    GNCImportTransInfo* transaction_info;
+    GNCImportMatchIndex* index;
     gint display_threshold;
     double fuzzy_amount;
 } match_struct;
 
 static void
-match_helper (Split* data, match_struct* s)
+match_helper (GNCImportTransInfo* txn_info, match_struct* s)
+{
+    gnc_import_MatchIndex_find_matches (s->index, txn_info,
+                                        s->display_threshold, s->fuzzy_amount);
+}
+
+/* Score every imported transaction against the candidate index. The
+ * imported transactions are independent of each other and the index is
+ * read-only, so the scoring is spread over a thread pool.
+ */
+static void
+find_matches (GNCImportMainMatcher *gui, GNCImportMatchIndex *index)
 {
-    split_find_match (s->transaction_info, data,
-                      s->display_threshold, s->fuzzy_amount);
+    match_struct s = {index,
+        gnc_import_Settings_get_display_threshold (gui->user_settings),
+        gnc_import_Settings_get_fuzzy_amount (gui->user_settings)};
+    guint n_threads = g_get_num_processors ();
+    GThreadPool *pool = NULL;
+
+    /* The book caches the num-field option on first use; do that here so
+     * that the worker threads only read it. */
+    qof_book_use_split_action_for_num_field (gnc_get_current_book ());
+
+    if (n_threads > 1 && gui->temp_trans_list && gui->temp_trans_list->next)
+        pool = g_thread_pool_new ((GFunc) match_helper, &s, n_threads,
+                                  TRUE, NULL);
+    for (GSList *imported_txn = gui->temp_trans_list; imported_txn !=NULL;
+         imported_txn = g_slist_next (imported_txn))
+    {
+        if (pool)
+            g_thread_pool_push (pool, imported_txn->data, NULL);
+        else
+            match_helper (imported_txn->data, &s);
+    }
+    if (pool)
+        g_thread_pool_free (pool, FALSE, TRUE);
 }
 
-/* Iterate through the imported transactions selecting matches from the
- * potential match lists in the account hash and update the matcher with the
- * results.
+/* Iterate through the imported transactions, select the best of the
+ * matches found by find_matches and update the matcher with the results.
  */
 
 static void
-perform_matching (GNCImportMainMatcher *gui, GHashTable *account_hash)
+perform_matching (GNCImportMainMatcher *gui)
 {
     GtkTreeModel* model = gtk_tree_view_get_model (gui->view);
-    gint display_threshold =
-        gnc_import_Settings_get_display_threshold (gui->user_settings);
-    double fuzzy_amount =
-        gnc_import_Settings_get_fuzzy_amount (gui->user_settings);
 
     for (GSList *imported_txn = gui->temp_trans_list; imported_txn !=NULL;
          imported_txn = g_slist_next (imported_txn))
@@ -1832,11 +1819,6 @@ perform_matching (GNCImportMainMatcher *gui, GHashTable *account_hash)
         GNCImportMatchInfo *selected_match;
         gboolean match_selected_manually;
         GNCImportTransInfo* txn_info = imported_txn->data;
-        Account *importaccount = xaccSplitGetAccount (gnc_import_TransInfo_get_fsplit (txn_info));
-        match_struct s = {txn_info, display_threshold, fuzzy_amount};
-
-        g_slist_foreach (g_hash_table_lookup (account_hash, importaccount),
-                         (GFunc) match_helper, &s);
 
         // Sort the matches, select the best match, and set the action.
         gnc_import_TransInfo_init_matches (txn_info, gui->user_settings);
@@ -1858,18 +1840,17 @@ perform_matching (GNCImportMainMatcher *gui, GHashTable *account_hash)
 void
 gnc_gen_trans_list_create_matches (GNCImportMainMatcher *gui)
 {
-    GHashTable* account_hash =
-        g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
-                              (GDestroyNotify)g_slist_free);
+    GNCImportMatchIndex *index;
     GList *candidate_txns;
     g_assert (gui);
     candidate_txns = query_imported_transaction_accounts (gui);
 
-    create_hash_of_potential_matches (candidate_txns, account_hash);
-    perform_matching (gui, account_hash);
+    index = gnc_import_MatchIndex_new (candidate_txns);
+    find_matches (gui, index);
+    perform_matching (gui);
 
     g_list_free (candidate_txns);
-    g_hash_table_destroy (account_hash);
+    gnc_import_MatchIndex_destroy (index);
     return;
 }
 
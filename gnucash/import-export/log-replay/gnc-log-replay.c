@@ -546,6 +546,33 @@ static void  process_trans_record(  FILE *log_file)
     }
 }
 
+/* A binary log is replayed by converting it to the text format first.
+   Returns the text in a temporary file positioned at its start, or NULL
+   if log_file isn't a binary log. */
+static FILE *convert_binary_log (FILE *log_file)
+{
+    FILE *text_log = tmpfile();
+    gboolean converted;
+
+    if (!text_log)
+    {
+        PERR("Cannot create a temporary file: %s", strerror(errno));
+        return NULL;
+    }
+    rewind(log_file);
+    converted = xaccLogConvertToText(log_file, text_log);
+    /* Replay whatever could be converted before a corrupted record. */
+    if (!converted && ftell(text_log) <= 0)
+    {
+        fclose(text_log);
+        return NULL;
+    }
+    if (!converted)
+        PWARN("Only part of the binary log could be read");
+    rewind(text_log);
+    return text_log;
+}
+
 void gnc_file_log_replay (GtkWindow *parent)
 {
     char *selected_filename;
@@ -603,7 +630,7 @@ void gnc_file_log_replay (GtkWindow *parent)
         else
         {
             DEBUG("Opening selected file");
-            log_file = g_fopen(selected_filename, "r");
+            log_file = g_fopen(selected_filename, "rb");
             if (!log_file || ferror(log_file) != 0)
             {
                 int err = errno;
@@ -626,6 +653,18 @@ void gnc_file_log_replay (GtkWindow *parent)
                 }
                 else
                 {
+                    if (strncmp(expected_header, read_buf, strlen(expected_header)) != 0)
+                    {
+                        /* Not a text log, it may be a binary one. */
+                        FILE *text_log = convert_binary_log(log_file);
+                        if (text_log)
+                        {
+                            fclose(log_file);
+                            log_file = text_log;
+                            if (!fgets(read_buf, sizeof(read_buf), log_file))
+                                read_buf[0] = '\0';
+                        }
+                    }
                     if (strncmp(expected_header, read_buf, strlen(expected_header)) != 0)
                     {
                         PERR("File header not recognised:\n%s", read_buf);
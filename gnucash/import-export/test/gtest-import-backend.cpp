@@ -61,6 +61,14 @@ qof_log_prettify (const char *name)
     return name;
 }
 
+// fake function from qofevent.cpp
+gint
+qof_event_register_handler (QofEventHandler handler, gpointer user_data)
+{
+    // do nothing
+    return 1;
+}
+
 // fake function from engine-helpers.c
 // this is a slightly modified version of the original function
 const char *
@@ -196,6 +204,95 @@ TEST_F(ImportBackendTest, CreateTransInfo)
 
 
 
+//! Test for function gnc_import_MatchIndex_find_matches()
+TEST_F(ImportBackendTest, MatchIndexFindMatches)
+{
+    using namespace testing;
+
+    GncMockImportMatchMap imap(m_import_acc);
+    time64 date(GncDateTime(GncDate(2020, 3, 18)));
+    std::vector<MockSplit*> splits;
+    std::vector<MockTransaction*> transactions;
+    GList* candidate_splits = NULL;
+
+    // create a candidate split, the candidates are queried in creation order
+    auto add_candidate = [&](Account* account, gint64 amount, int days)->Split* {
+        auto split = new MockSplit();
+        auto trans = new MockTransaction();
+
+        ON_CALL(*split, get_account())
+            .WillByDefault(Return(account));
+        ON_CALL(*split, get_amount())
+            .WillByDefault(Return(gnc_numeric_create(amount, 100)));
+        ON_CALL(*split, get_parent())
+            .WillByDefault(Return(trans));
+        ON_CALL(*trans, get_date())
+            .WillByDefault(Return(date + days * 86400));
+        ON_CALL(*trans, is_open())
+            .WillByDefault(Return(false));
+
+        splits.push_back(split);
+        transactions.push_back(trans);
+        candidate_splits = g_list_append(candidate_splits, split);
+        return split;
+    };
+
+    // the imported transaction has an amount of 100.00, no number, memo or description
+    ON_CALL(*m_trans, get_split(0))
+        .WillByDefault(Return(m_split));
+    ON_CALL(*m_trans, get_date())
+        .WillByDefault(Return(date));
+    ON_CALL(*m_split, get_account())
+        .WillByDefault(Return(m_import_acc));
+    ON_CALL(*m_split, get_amount())
+        .WillByDefault(Return(gnc_numeric_create(10000, 100)));
+    EXPECT_CALL(imap, find_account(_, _))
+        .WillOnce(Return(nullptr));
+
+    // candidates not listed in amount order
+    auto fuzzy_amount = add_candidate(m_import_acc, 10100, 1);   // score 2 + 2
+    auto exact_amount = add_candidate(m_import_acc, 10000, 0);   // score 3 + 3
+    add_candidate(m_import_acc, 15000, 0);                       // out of amount range
+    EXPECT_CALL(*transactions.back(), is_open()).Times(0);
+    add_candidate(m_import_acc, 10000, 30);                      // out of date range
+    EXPECT_CALL(*transactions.back(), is_open()).Times(0);
+    auto exact_amount2 = add_candidate(m_import_acc, 10000, 0);  // score 3 + 3
+    add_candidate(m_dest_acc, 10000, 0);                         // other account
+    EXPECT_CALL(*transactions.back(), is_open()).Times(0);
+
+    GNCImportTransInfo *trans_info = gnc_import_TransInfo_new(m_trans, &imap);
+    GNCImportMatchIndex *index = gnc_import_MatchIndex_new(candidate_splits);
+
+    // call function to be tested
+    gnc_import_MatchIndex_find_matches(index, trans_info, 1, 2.0);
+
+    // only the candidates within range are scored and kept in candidate list order
+    std::vector<Split*> matched;
+    std::vector<gint> scores;
+    for (GList* node = gnc_import_TransInfo_get_match_list(trans_info); node; node = node->next)
+    {
+        auto match_info = static_cast<GNCImportMatchInfo*>(node->data);
+        matched.push_back(gnc_import_MatchInfo_get_split(match_info));
+        scores.push_back(gnc_import_MatchInfo_get_probability(match_info));
+    }
+    EXPECT_THAT(matched, ElementsAre(fuzzy_amount, exact_amount, exact_amount2));
+    EXPECT_THAT(scores, ElementsAre(4, 6, 6));
+
+    // transaction is not open anymore
+    ON_CALL(*m_trans, is_open())
+        .WillByDefault(Return(false));
+
+    gnc_import_MatchIndex_destroy(index);
+    gnc_import_TransInfo_delete(trans_info);
+    g_list_free(candidate_splits);
+    for (auto split : splits)
+        split->free();
+    for (auto trans : transactions)
+        trans->free();
+};
+
+
+
 // Test fixture for tests with bayesian matching
 class ImportBackendBayesTest : public ImportBackendTest
 {
@@ -415,6 +415,7 @@ gnc_ledger_display_gl (void)
     query = qof_query_create_for (GNC_ID_SPLIT);
 
     qof_query_set_book (query, gnc_get_current_book());
+    qof_query_set_backend_search (query, TRUE);
 
     /* In lieu of not "mis-using" some portion of the infrastructure by writing
      * a bunch of new code, we just filter out the accounts of the template
@@ -673,6 +674,7 @@ gnc_ledger_display_make_query (GNCLedgerDisplay* ld,
         qof_query_set_max_results (ld->query, limit);
 
     qof_query_set_book (ld->query, gnc_get_current_book());
+    qof_query_set_backend_search (ld->query, TRUE);
 
     leader = gnc_ledger_display_leader (ld);
 
@@ -400,6 +400,7 @@ gnc_split_register_load (SplitRegister* reg, GList* slist,
     g_return_if_fail (info);
 
     ENTER ("reg=%p, slist=%p, default_account=%p", reg, slist, default_account);
+    QOF_TRACE_BEGIN ("register load");
 
     blank_split = xaccSplitLookup (&info->blank_split_guid,
                                    gnc_get_current_book());
@@ -796,6 +797,7 @@ gnc_split_register_load (SplitRegister* reg, GList* slist,
     if (we_own_slist)
         g_list_free (slist);
 
+    QOF_TRACE_END ("register load");
     LEAVE (" ");
 }
 
@@ -507,25 +507,33 @@ gnucash_sheet_cursor_move (GnucashSheet *sheet, VirtualLocation virt_loc)
 }
 
 
-static gint
+/* Block offsets only ever grow with the row number and hidden blocks take
+ * no space, so the block containing y can be found by bisection instead of
+ * walking all the rows above it. */
+gint
 gnucash_sheet_y_pixel_to_block (GnucashSheet *sheet, int y)
 {
     VirtualCellLocation vcell_loc = { 1, 0 };
+    gint lo = 1, hi = sheet->num_virt_rows;
 
-    for (;
-            vcell_loc.virt_row < sheet->num_virt_rows;
-            vcell_loc.virt_row++)
+    while (lo < hi)
     {
         SheetBlock *block;
+        gint bottom;
 
+        vcell_loc.virt_row = lo + (hi - lo) / 2;
         block = gnucash_sheet_get_block (sheet, vcell_loc);
-        if (!block || !block->visible)
-            continue;
 
-        if (block->origin_y + block->style->dimensions->height > y)
-            break;
+        bottom = block->origin_y;
+        if (block->visible && block->style)
+            bottom += block->style->dimensions->height;
+
+        if (bottom > y)
+            hi = vcell_loc.virt_row;
+        else
+            lo = vcell_loc.virt_row + 1;
     }
-    return vcell_loc.virt_row;
+    return lo;
 }
 
 
@@ -2175,6 +2183,7 @@ gnucash_sheet_table_load (GnucashSheet *sheet, gboolean do_scroll)
     g_return_if_fail (sheet->table != NULL);
 
     table = sheet->table;
+    QOF_TRACE_BEGIN ("sheet load");
 
     gnucash_sheet_stop_editing (sheet);
 
@@ -2219,6 +2228,7 @@ gnucash_sheet_table_load (GnucashSheet *sheet, gboolean do_scroll)
 
     gnucash_sheet_cursor_set_from_table (sheet, do_scroll);
     gnucash_sheet_activate_cursor_cell (sheet, TRUE);
+    QOF_TRACE_END ("sheet load");
 }
 
 /*************************************************************/
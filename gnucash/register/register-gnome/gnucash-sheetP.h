@@ -117,6 +117,10 @@ void gnucash_sheet_set_popup (GnucashSheet *sheet, GtkWidget *popup, gpointer da
 void gnucash_sheet_goto_virt_loc (GnucashSheet *sheet, VirtualLocation virt_loc);
 void gnucash_sheet_refresh_from_prefs (GnucashSheet *sheet);
 
+/** Return the first visible row whose block reaches below pixel y, or the
+ *  number of rows if there is none. */
+gint gnucash_sheet_y_pixel_to_block (GnucashSheet *sheet, int y);
+
 gboolean   gnucash_sheet_find_loc_by_pixel (GnucashSheet *sheet, gint x, gint y,
                                            VirtualLocation *vcell_loc);
 gboolean gnucash_sheet_draw_internal (GnucashSheet *sheet, cairo_t *cr,
@@ -222,7 +222,9 @@ gnc_run_report (gint report_id, char ** data)
     *data = NULL;
 
     str = g_strdup_printf("(gnc:report-run %d)", report_id);
+    QOF_TRACE_BEGIN ("report");
     scm_text = gfec_eval_string(str, error_handler);
+    QOF_TRACE_END ("report");
     g_free(str);
 
     if (scm_text == SCM_UNDEFINED || !scm_is_string (scm_text))
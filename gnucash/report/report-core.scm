@@ -236,7 +236,8 @@ not found.")))
 
 ;; A <report> represents an instantiation of a particular report type.
 (define-record-type <report>
-  (make-report type id options dirty? needs-save? editor-widget ctext custom-template)
+  (make-report type id options dirty? needs-save? editor-widget ctext ctext-key
+               custom-template)
   report?
   (type report-type report-set-type!)
   (id report-id report-set-id!)
@@ -245,6 +246,7 @@ not found.")))
   (needs-save? report-needs-save? report-set-needs-save?!)
   (editor-widget report-editor-widget report-set-editor-widget!)
   (ctext report-ctext report-set-ctext!)
+  (ctext-key report-ctext-key report-set-ctext-key!)
   (custom-template report-custom-template report-set-custom-template!))
 
 (define gnc:report-type report-type)
@@ -286,6 +288,7 @@ not found.")))
              #f              ;; needs-save
              #f              ;; editor-widget
              #f              ;; ctext
+             #f              ;; ctext-key
              custom-template ;; custom-template
              ))
          (template (hash-ref *gnc:_report-templates_* template-id)))
@@ -306,7 +309,7 @@ not found.")))
 
 (define (gnc:restore-report-by-guid id template-id template-name options)
   (if options
-      (let* ((r (make-report template-id id options #t #t #f #f ""))
+      (let* ((r (make-report template-id id options #t #t #f #f #f ""))
              (report-id (gnc-report-add r)))
         (if (number? report-id)
             (gnc:report-set-id! r report-id))
@@ -318,7 +321,7 @@ not found.")))
 (define (gnc:restore-report-by-guid-with-custom-template
          id template-id template-name custom-template-id options)
   (if options
-      (let* ((r (make-report template-id id options #t #t #f #f custom-template-id))
+      (let* ((r (make-report template-id id options #t #t #f #f #f custom-template-id))
              (report-id (gnc-report-add r)))
         (if (number? report-id)
             (gnc:report-set-id! r report-id))
@@ -666,9 +669,14 @@ not found.")))
 ;; returns the html string.
 ;; Now accepts either an html-doc or finished HTML from the renderer -
 ;; the former requires further processing, the latter is just returned.
+;; The cached string is reused until the report is marked dirty (its
+;; options changed) or a change is committed to the book.
 (define (gnc:report-render-html report headers?)
+  (define ctext-key
+    (cons (qof-book-get-change-generation (gnc-get-current-book)) headers?))
   (if (and (not (gnc:report-dirty? report))
-           (gnc:report-ctext report))
+           (gnc:report-ctext report)
+           (equal? (report-ctext-key report) ctext-key))
       (gnc:report-ctext report)
       (let ((template (hash-ref *gnc:_report-templates_* (gnc:report-type report))))
         (and template
@@ -681,6 +689,7 @@ not found.")))
                             (gnc:html-document-set-style-sheet! doc stylesheet)
                             (gnc:html-document-render doc headers?)))))
                (gnc:report-set-ctext! report html) ;; cache the html
+               (report-set-ctext-key! report ctext-key)
                (gnc:report-set-dirty?! report #f)  ;; mark it clean
                html)))))
 
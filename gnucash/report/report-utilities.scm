@@ -234,60 +234,50 @@
 ;;       <commodity> doesn't exist, the balance will be 0. If
 ;;       signreverse? is true, the result's sign will be reversed.
 ;;   (internal) 'list #f #f: get the list of
-;;       (cons commodity numeric-collector)
+;;       (cons commodity total)
 
 (define (gnc:make-commodity-collector)
-  ;; the association list of (commodity . value-collector) pairs.
+  ;; the association list of (commodity . total) pairs. The totals are
+  ;; updated in place, so adding to a commodity which already showed
+  ;; up allocates nothing but the sum itself.
   (let ((commoditylist '()))
-    
+
     ;; helper function to add a (commodity . value) pair to our list.
     ;; If no pair with this commodity exists, we will create one.
     (define (add-commodity-value commodity value)
-      (let ((pair (assoc commodity commoditylist)))
-	(unless pair
-	  (set! pair (list commodity (gnc:make-value-collector)))
-	  (set! commoditylist (cons pair commoditylist)))
-	((cadr pair) 'add value)))
-    
+      (let ((pair (assoc commodity commoditylist))
+            (value (if (number? value) value 0)))
+        (if pair
+            (set-cdr! pair (+ (cdr pair) value))
+            (set! commoditylist (cons (cons commodity value)
+                                      commoditylist)))))
+
     ;; helper function to walk an association list, adding each
-    ;; (commodity . collector) pair to our list at the appropriate
-    ;; place
+    ;; (commodity . total) pair to our list at the appropriate place
     (define (add-commodity-clist clist)
-      (cond ((null? clist) '())
-	    (else (add-commodity-value 
-		   (caar clist) 
-		   ((cadar clist) 'total #f))
-		  (add-commodity-clist (cdr clist)))))
+      (for-each
+       (lambda (pair) (add-commodity-value (car pair) (cdr pair)))
+       clist))
 
     (define (minus-commodity-clist clist)
-      (cond ((null? clist) '())
-	    (else (add-commodity-value 
-		   (caar clist) 
-		   (- ((cadar clist) 'total #f)))
-		  (minus-commodity-clist (cdr clist)))))
+      (for-each
+       (lambda (pair) (add-commodity-value (car pair) (- (cdr pair))))
+       clist))
 
     ;; helper function walk the association list doing a callback on
     ;; each key-value pair.
     (define (process-commodity-list fn clist)
       (map
        (lambda (pair)
-         (fn (car pair) ((cadr pair) 'total #f)))
+         (fn (car pair) (cdr pair)))
        clist))
 
-    ;; helper function which is given a commodity and returns a list
-    ;; (list gnc:commodity number).
-    (define (getpair c sign?)
+    ;; helper function which returns the total of commodity c, or 0.
+    (define (gettotal c sign?)
       (let* ((pair (assoc c commoditylist))
-             (total (if pair ((cadr pair) 'total #f) 0)))
-	(list c (if sign? (- total) total))))
+             (total (if pair (cdr pair) 0)))
+        (if sign? (- total) total)))
 
-    ;; helper function which is given a commodity and returns a
-    ;; <gnc:monetary> value, whose amount may be 0.
-    (define (getmonetary c sign?)
-      (let* ((pair (assoc c commoditylist))
-             (total (if pair ((cadr pair) 'total #f) 0)))
-	(gnc:make-gnc-monetary c (if sign? (- total) total))))
-    
     ;; Dispatch function
     (lambda (action commodity amount)
       (case action
@@ -298,8 +288,9 @@
                        (commodity 'list #f #f)))
 	((format) (process-commodity-list commodity commoditylist))
 	((reset) (set! commoditylist '()))
-	((getpair) (getpair commodity amount))
-	((getmonetary) (getmonetary commodity amount))
+	((getpair) (list commodity (gettotal commodity amount)))
+	((getmonetary) (gnc:make-gnc-monetary
+                        commodity (gettotal commodity amount)))
 	((list) commoditylist) ; this one is only for internal use
 	(else (gnc:warn "bad commodity-collector action: " action))))))
 
@@ -364,16 +355,20 @@
 ;; (and (not (xaccTransGetIsClosingTxn (xaccSplitGetParent s)))
 ;; (xaccSplitGetAmount s)))
 (define* (gnc:account-get-balances-at-dates
-          account dates-list #:key (split->amount xaccSplitGetAmount))
+          account dates-list #:key (split->amount #f))
+  (define comm (xaccAccountGetCommodity account))
   (define (amount->monetary bal)
-    (gnc:make-gnc-monetary (xaccAccountGetCommodity account) (or bal 0)))
+    (gnc:make-gnc-monetary comm (or bal 0)))
   (define balance 0)
   (map amount->monetary
-       (gnc:account-accumulate-at-dates
-        account dates-list #:split->elt
-        (lambda (s)
-          (if s (set! balance (+ balance (or (split->amount s) 0))))
-          balance))))
+       (if split->amount
+           (gnc:account-accumulate-at-dates
+            account dates-list #:split->elt
+            (lambda (s)
+              (if s (set! balance (+ balance (or (split->amount s) 0))))
+              balance))
+           ;; plain split amounts: let the engine walk the splits
+           (gnc-account-get-balances-at-dates account dates-list #f comm #f))))
 
 
 ;; this function will scan through account splitlist, building a list
@@ -240,12 +240,9 @@
     (define (account->balancelist account)
       (let ((comm (xaccAccountGetCommodity account)))
         (cons account
-              (gnc:account-accumulate-at-dates
-               account dates-list
-               #:split->elt (lambda (s)
-                              (gnc:make-gnc-monetary
-                               comm (xaccSplitGetNoclosingBalance s)))
-               #:nosplit->elt (gnc:make-gnc-monetary comm 0)))))
+              (map (lambda (amt) (gnc:make-gnc-monetary comm amt))
+                   (gnc-account-get-balances-at-dates
+                    account dates-list #t comm #f)))))
 
     ;; This calculates the balances for all the 'account-balances' for
     ;; each element of the list 'dates'. Uses the collector->monetary
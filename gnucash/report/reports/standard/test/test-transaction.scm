@@ -903,7 +903,7 @@
 
       (let* ((template (gnc:find-report-template trep-uuid))
              (constructor (record-constructor <report>))
-             (report (constructor trep-uuid "bar" options #t #t #f #f ""))
+             (report (constructor trep-uuid "bar" options #t #t #f #f #f ""))
              (renderer (gnc:report-template-renderer template))
              (document (renderer report #:export-type 'csv)))
         (test-assert "csv output has no export error"
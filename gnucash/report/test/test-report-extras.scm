@@ -42,7 +42,7 @@
   (let* ((template (or (gnc:find-report-template uuid)
                        (error "report not found:" uuid)))
          (constructor (record-constructor <report>))
-         (report (constructor uuid "bar" options #t #t #f #f ""))
+         (report (constructor uuid "bar" options #t #t #f #f #f ""))
          (renderer (gnc:report-template-renderer template))
          (document (renderer report))
          (sanitize-char (lambda (c)
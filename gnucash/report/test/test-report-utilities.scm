@@ -639,6 +639,11 @@
                 (and (not (xaccTransGetIsClosingTxn (xaccSplitGetParent s)))
                      (xaccSplitGetAmount s))))))
 
+      (test-equal "gnc-account-get-balances-at-dates ignoring closing"
+        '(0 10 20 30)
+        (gnc-account-get-balances-at-dates
+         bank1 dates #t (xaccAccountGetCommodity bank1) #f))
+
       (test-equal "2 txn before start, 1 in middle"
         '(("USD" . 20) ("USD" . 20) ("USD" . 30) ("USD" . 30))
         (map monetary->pair (gnc:account-get-balances-at-dates bank2 dates)))
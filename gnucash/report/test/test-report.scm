@@ -1,3 +1,4 @@
+(use-modules (gnucash engine))
 (use-modules (gnucash app-utils))
 (use-modules (gnucash report))
 (use-modules (srfi srfi-64))
@@ -17,6 +18,7 @@
   (test-report-template-getters)
   (test-make-report)
   (test-report)
+  (test-report-render-cache)
   (test-end "Testing/Temporary/test-report"))
 
 (define test4-guid "54c2fc051af64a08ba2334c2e9179e24")
@@ -168,7 +170,7 @@
   (let* ((template (gnc:find-report-template test-uuid))
          (constructor (record-constructor <report>))
          (options (gnc:make-report-options test-uuid))
-         (report (constructor test-uuid "bar" options #t #t #f #f "")))
+         (report (constructor test-uuid "bar" options #t #t #f #f #f "")))
     (test-equal "render works"
       "return-string"
       ((gnc:report-template-renderer template) report))
@@ -221,3 +223,40 @@
     (test-assert "gnc:report-serialize = string"
       (string?
        (gnc:report-serialize report)))))
+
+(define (test-report-render-cache)
+  (define test-uuid "render-cache-report-guid")
+  (define renders 0)
+  (gnc:define-report
+   'version 1
+   'name "render cache report"
+   'report-guid test-uuid
+   'options-generator gnc:new-options
+   'renderer (lambda (obj)
+               (set! renders (1+ renders))
+               "cached-string"))
+  (let* ((constructor (record-constructor <report>))
+         (options (gnc:make-report-options test-uuid))
+         (report (constructor test-uuid "baz" options #t #t #f #f #f "")))
+    (test-begin "test-report-render-cache")
+    (test-equal "first render runs the renderer"
+      '("cached-string" 1)
+      (list (gnc:report-render-html report #t) renders))
+    (test-equal "unchanged report and book reuses the html"
+      '("cached-string" 1)
+      (list (gnc:report-render-html report #t) renders))
+    (gnc:report-render-html report #f)
+    (test-equal "different headers? renders again"
+      2 renders)
+    (gnc:report-set-dirty?! report #t)
+    (gnc:report-render-html report #f)
+    (test-equal "dirty report renders again"
+      3 renders)
+    (let ((acc (xaccMallocAccount (gnc-get-current-book))))
+      (xaccAccountBeginEdit acc)
+      (xaccAccountSetName acc "render cache account")
+      (xaccAccountCommitEdit acc))
+    (gnc:report-render-html report #f)
+    (test-equal "book change renders again"
+      4 renders)
+    (test-end "test-report-render-cache")))
@@ -2085,43 +2085,50 @@ warning will be removed in GnuCash 5.0"))
        (else
         (string-contains str transaction-matcher))))
 
-    (define (generic-less? split-X split-Y sortkey date-subtotal-key ascend?)
-      ;; compare splits X and Y, whereby
-      ;; sortkey and date-subtotal-key specify the options used
+    (define (split-sortvalue-fn sortkey date-subtotal-key)
+      ;; returns the split->value function for sortkey and
+      ;; date-subtotal-key; the values are compared by value-less?
+      (if (memq sortkey DATE-SORTING-TYPES)
+          (let ((date (keylist-get-info
+                       (sortkey-list BOOK-SPLIT-ACTION)
+                       sortkey 'split-sortvalue))
+                (date-comparator
+                 (keylist-get-info date-subtotal-list
+                                   date-subtotal-key 'date-sortvalue)))
+            (lambda (s)
+              (and date-comparator (date-comparator (date s)))))
+          (or (keylist-get-info (sortkey-list BOOK-SPLIT-ACTION)
+                                sortkey 'split-sortvalue)
+              (lambda (s) #f))))
+
+    (define (value-less? value-of-X value-of-Y ascend?)
+      ;; compare sort values X and Y, whereby
       ;; ascend? specifies whether ascending or descending
-      (let* ((comparator-function
-              (if (memq sortkey DATE-SORTING-TYPES)
-                  (let ((date (keylist-get-info
-                               (sortkey-list BOOK-SPLIT-ACTION)
-                               sortkey 'split-sortvalue))
-                        (date-comparator
-                         (keylist-get-info date-subtotal-list
-                                           date-subtotal-key 'date-sortvalue)))
-                    (lambda (s)
-                      (and date-comparator (date-comparator (date s)))))
-                  (or (keylist-get-info (sortkey-list BOOK-SPLIT-ACTION)
-                                        sortkey 'split-sortvalue)
-                      (lambda (s) #f))))
-             (value-of-X (comparator-function split-X))
-             (value-of-Y (comparator-function split-Y))
-             (op (if (string? value-of-X)
-                     (if ascend? gnc:string-locale<? gnc:string-locale>?)
-                     (if ascend? < >))))
+      (let ((op (if (string? value-of-X)
+                    (if ascend? gnc:string-locale<? gnc:string-locale>?)
+                    (if ascend? < >))))
         (and value-of-X (op value-of-X value-of-Y))))
 
-    (define (primary-comparator? X Y)
-      (generic-less? X Y primary-key
-                     primary-date-subtotal
-                     (eq? primary-order 'ascend)))
-
-    (define (secondary-comparator? X Y)
-      (generic-less? X Y secondary-key
-                     secondary-date-subtotal
-                     (eq? secondary-order 'ascend)))
-
-    ;; This will, by default, sort the split list by ascending posted-date.
-    (define (date-comparator? X Y)
-      (generic-less? X Y 'date 'none #t))
+    (define (custom-sort splits)
+      ;; sorts splits by primary then secondary key. The sort values
+      ;; are retrieved once per split rather than once per comparison.
+      (let ((primary-value (split-sortvalue-fn primary-key primary-date-subtotal))
+            (primary-ascend? (eq? primary-order 'ascend))
+            (secondary-value (split-sortvalue-fn secondary-key secondary-date-subtotal))
+            (secondary-ascend? (eq? secondary-order 'ascend)))
+        (define (less? X Y)
+          (let ((pX (vector-ref X 1)) (pY (vector-ref Y 1)))
+            (cond
+             ((value-less? pX pY primary-ascend?) #t)
+             ((value-less? pY pX primary-ascend?) #f)
+             (else (value-less? (vector-ref X 2) (vector-ref Y 2)
+                                secondary-ascend?)))))
+        (map
+         (lambda (row) (vector-ref row 0))
+         (stable-sort!
+          (map (lambda (s) (vector s (primary-value s) (secondary-value s)))
+               splits)
+          less?))))
 
     (define (transaction-filter-match split)
       (or (match? (xaccTransGetDescription (xaccSplitGetParent split)))
@@ -2216,9 +2223,7 @@ warning will be removed in GnuCash 5.0"))
          splits))
 
       (when custom-sort?
-        (set! splits (stable-sort! splits date-comparator?))
-        (set! splits (stable-sort! splits secondary-comparator?))
-        (set! splits (stable-sort! splits primary-comparator?)))
+        (set! splits (custom-sort splits)))
 
       (cond
        ((null? splits)
@@ -32,20 +32,36 @@
 #include "gnc-ui-util.h"
 
 
+/* The best matching text of a node is usually also the best matching
+ * text of every node on the path to it, so the nodes share one
+ * reference counted copy instead of each holding its own. */
+typedef struct
+{
+    guint ref_count;
+    char str[];
+} QuickFillText;
+
+typedef struct
+{
+    guint key;           /* upper cased character leading to qf */
+    QuickFill *qf;
+} QuickFillMatch;
+
 struct _QuickFill
 {
-    char *text;          /* the first matching text string     */
-    int len;             /* number of chars in text string     */
-    GHashTable *matches; /* array of children in the tree      */
+    QuickFillText *text;     /* the first matching text string     */
+    int len;                 /* number of chars in text string     */
+    guint n_matches;         /* number of children in the tree     */
+    QuickFillMatch *matches; /* children, sorted by key            */
 };
 
 
 /** PROTOTYPES ******************************************************/
-static void quickfill_insert_recursive (QuickFill *qf, const char *text, int len,
+static void quickfill_insert_recursive (QuickFill *qf, QuickFillText *text, int len,
                                         const char* next_char, QuickFillSort sort);
 
 static void gnc_quickfill_remove_recursive (QuickFill *qf, const gchar *text,
-        gint depth, QuickFillSort sort);
+        const gchar *next_char, QuickFillSort sort);
 
 /* This static indicates the debugging module that this .o belongs to.  */
 static QofLogModule log_module = GNC_MOD_REGISTER;
@@ -53,6 +69,80 @@ static QofLogModule log_module = GNC_MOD_REGISTER;
 /********************************************************************\
 \********************************************************************/
 
+static QuickFillText *
+quickfill_text_new (const char *str)
+{
+    size_t size = strlen (str) + 1;
+    QuickFillText *text = g_malloc (sizeof (QuickFillText) + size);
+
+    text->ref_count = 1;
+    memcpy (text->str, str, size);
+    return text;
+}
+
+static QuickFillText *
+quickfill_text_ref (QuickFillText *text)
+{
+    if (text)
+        text->ref_count++;
+    return text;
+}
+
+static void
+quickfill_text_unref (QuickFillText *text)
+{
+    if (text && --text->ref_count == 0)
+        g_free (text);
+}
+
+/* Returns the index of the first child whose key is not less than key. */
+static guint
+quickfill_match_index (const QuickFill *qf, guint key)
+{
+    guint lo = 0, hi = qf->n_matches;
+
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+        if (qf->matches[mid].key < key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static QuickFill *
+quickfill_lookup (const QuickFill *qf, guint key)
+{
+    guint i = quickfill_match_index (qf, key);
+
+    if (i < qf->n_matches && qf->matches[i].key == key)
+        return qf->matches[i].qf;
+    return NULL;
+}
+
+static void
+quickfill_remove_match (QuickFill *qf, guint key)
+{
+    guint i = quickfill_match_index (qf, key);
+
+    if (i >= qf->n_matches || qf->matches[i].key != key)
+        return;
+
+    qf->n_matches--;
+    memmove (&qf->matches[i], &qf->matches[i + 1],
+             (qf->n_matches - i) * sizeof (QuickFillMatch));
+    if (qf->n_matches == 0)
+    {
+        g_free (qf->matches);
+        qf->matches = NULL;
+    }
+}
+
+/********************************************************************\
+\********************************************************************/
+
 QuickFill *
 gnc_quickfill_new (void)
 {
@@ -69,7 +159,8 @@ gnc_quickfill_new (void)
     qf->text = NULL;
     qf->len = 0;
 
-    qf->matches = g_hash_table_new (g_direct_hash, g_direct_equal);
+    qf->n_matches = 0;
+    qf->matches = NULL;
 
     return qf;
 }
@@ -77,28 +168,13 @@ gnc_quickfill_new (void)
 /********************************************************************\
 \********************************************************************/
 
-static gboolean
-destroy_helper (gpointer key, gpointer value, gpointer data)
-{
-    gnc_quickfill_destroy (value);
-    return TRUE;
-}
-
 void
 gnc_quickfill_destroy (QuickFill *qf)
 {
     if (qf == NULL)
         return;
 
-    g_hash_table_foreach (qf->matches, (GHFunc)destroy_helper, NULL);
-    g_hash_table_destroy (qf->matches);
-    qf->matches = NULL;
-
-    if (qf->text)
-        g_free(qf->text);
-    qf->text = NULL;
-    qf->len = 0;
-
+    gnc_quickfill_purge (qf);
     g_free (qf);
 }
 
@@ -108,10 +184,13 @@ gnc_quickfill_purge (QuickFill *qf)
     if (qf == NULL)
         return;
 
-    g_hash_table_foreach_remove (qf->matches, destroy_helper, NULL);
+    for (guint i = 0; i < qf->n_matches; i++)
+        gnc_quickfill_destroy (qf->matches[i].qf);
+    g_free (qf->matches);
+    qf->matches = NULL;
+    qf->n_matches = 0;
 
-    if (qf->text)
-        g_free (qf->text);
+    quickfill_text_unref (qf->text);
     qf->text = NULL;
     qf->len = 0;
 }
@@ -122,10 +201,10 @@ gnc_quickfill_purge (QuickFill *qf)
 const char *
 gnc_quickfill_string (QuickFill *qf)
 {
-    if (qf == NULL)
+    if (qf == NULL || qf->text == NULL)
         return NULL;
 
-    return qf->text;
+    return qf->text->str;
 }
 
 /********************************************************************\
@@ -140,7 +219,7 @@ gnc_quickfill_get_char_match (QuickFill *qf, gunichar uc)
 
     DEBUG ("xaccGetQuickFill(): index = %u\n", key);
 
-    return g_hash_table_lookup (qf->matches, GUINT_TO_POINTER (key));
+    return quickfill_lookup (qf, key);
 }
 
 /********************************************************************\
@@ -187,14 +266,6 @@ gnc_quickfill_get_string_match (QuickFill *qf, const char *str)
 /********************************************************************\
 \********************************************************************/
 
-static void
-unique_len_helper (gpointer key, gpointer value, gpointer data)
-{
-    QuickFill **qf_p = data;
-
-    *qf_p = value;
-}
-
 QuickFill *
 gnc_quickfill_get_unique_len_match (QuickFill *qf, int *length)
 {
@@ -204,16 +275,9 @@ gnc_quickfill_get_unique_len_match (QuickFill *qf, int *length)
     if (qf == NULL)
         return NULL;
 
-    while (1)
+    while (qf->n_matches == 1)
     {
-        guint count;
-
-        count = g_hash_table_size (qf->matches);
-
-        if (count != 1)
-            break;
-
-        g_hash_table_foreach (qf->matches, unique_len_helper, &qf);
+        qf = qf->matches[0].qf;
 
         if (length != NULL)
             (*length)++;
@@ -229,6 +293,7 @@ void
 gnc_quickfill_insert (QuickFill *qf, const char *text, QuickFillSort sort)
 {
     gchar *normalized_str;
+    QuickFillText *qf_text;
     int len;
 
     if (NULL == qf) return;
@@ -237,7 +302,9 @@ gnc_quickfill_insert (QuickFill *qf, const char *text, QuickFillSort sort)
 
     normalized_str = g_utf8_normalize (text, -1, G_NORMALIZE_NFC);
     len = g_utf8_strlen (text, -1);
-    quickfill_insert_recursive (qf, normalized_str, len, normalized_str, sort);
+    qf_text = quickfill_text_new (normalized_str);
+    quickfill_insert_recursive (qf, qf_text, len, normalized_str, sort);
+    quickfill_text_unref (qf_text);
     g_free (normalized_str);
 }
 
@@ -245,11 +312,20 @@ gnc_quickfill_insert (QuickFill *qf, const char *text, QuickFillSort sort)
 \********************************************************************/
 
 static void
-quickfill_insert_recursive (QuickFill *qf, const char *text, int len,
+quickfill_set_text (QuickFill *qf, QuickFillText *text, int len)
+{
+    quickfill_text_ref (text);
+    quickfill_text_unref (qf->text);
+    qf->text = text;
+    qf->len = len;
+}
+
+static void
+quickfill_insert_recursive (QuickFill *qf, QuickFillText *text, int len,
                             const char *next_char, QuickFillSort sort)
 {
-    guint key;
-    char *old_text;
+    guint key, i;
+    const char *old_text;
     QuickFill *match_qf;
     gunichar key_char_uc;
 
@@ -263,19 +339,26 @@ quickfill_insert_recursive (QuickFill *qf, const char *text, int len,
     key_char_uc = g_utf8_get_char (next_char);
     key = g_unichar_toupper (key_char_uc);
 
-    match_qf = g_hash_table_lookup (qf->matches, GUINT_TO_POINTER (key));
-    if (match_qf == NULL)
+    i = quickfill_match_index (qf, key);
+    if (i < qf->n_matches && qf->matches[i].key == key)
+        match_qf = qf->matches[i].qf;
+    else
     {
         match_qf = gnc_quickfill_new ();
-        g_hash_table_insert (qf->matches, GUINT_TO_POINTER (key), match_qf);
+        qf->matches = g_renew (QuickFillMatch, qf->matches, qf->n_matches + 1);
+        memmove (&qf->matches[i + 1], &qf->matches[i],
+                 (qf->n_matches - i) * sizeof (QuickFillMatch));
+        qf->matches[i].key = key;
+        qf->matches[i].qf = match_qf;
+        qf->n_matches++;
     }
 
-    old_text = match_qf->text;
+    old_text = gnc_quickfill_string (match_qf);
 
     switch (sort)
     {
     case QUICKFILL_ALPHA:
-        if (old_text && (g_utf8_collate (text, old_text) >= 0))
+        if (old_text && (g_utf8_collate (text->str, old_text) >= 0))
             break;
         /* fall through */
 
@@ -284,19 +367,16 @@ quickfill_insert_recursive (QuickFill *qf, const char *text, int len,
         /* If there's no string there already, just put the new one in. */
         if (old_text == NULL)
         {
-            match_qf->text = g_strdup(text);
-            match_qf->len = len;
+            quickfill_set_text (match_qf, text, len);
             break;
         }
 
         /* Leave prefixes in place */
         if ((len > match_qf->len) &&
-                (strncmp(text, old_text, strlen(old_text)) == 0))
+                (strncmp(text->str, old_text, strlen(old_text)) == 0))
             break;
 
-        g_free(old_text);
-        match_qf->text = g_strdup(text);
-        match_qf->len = len;
+        quickfill_set_text (match_qf, text, len);
         break;
     }
 
@@ -315,79 +395,45 @@ gnc_quickfill_remove (QuickFill *qf, const gchar *text, QuickFillSort sort)
     if (text == NULL) return;
 
     normalized_str = g_utf8_normalize (text, -1, G_NORMALIZE_NFC);
-    gnc_quickfill_remove_recursive (qf, normalized_str, 0, sort);
+    gnc_quickfill_remove_recursive (qf, normalized_str, normalized_str, sort);
     g_free (normalized_str);
 }
 
 /********************************************************************\
 \********************************************************************/
 
-struct _BestText
-{
-    gchar *text;
-    QuickFillSort sort;
-};
-
 static void
-best_text_helper (gpointer key, gpointer value, gpointer user_data)
-{
-    QuickFill *qf = value;
-    struct _BestText *best = user_data;
-
-    if (best->text == NULL)
-    {
-        /* start with the first text */
-        best->text = qf->text;
-
-    }
-    else if (best->text == QUICKFILL_LIFO)
-    {
-        /* we do not track history, so ignore it */
-        return;
-
-    }
-    else if (g_utf8_collate (qf->text, best->text) < 0)
-    {
-        /* even better text */
-        best->text = qf->text;
-    }
-}
-
-
-
-static void
-gnc_quickfill_remove_recursive (QuickFill *qf, const gchar *text, gint depth,
-                                QuickFillSort sort)
+gnc_quickfill_remove_recursive (QuickFill *qf, const gchar *text,
+                                const gchar *next_char, QuickFillSort sort)
 {
     QuickFill *match_qf;
-    gchar *child_text;
+    QuickFillText *child_text;
     gint child_len;
 
     child_text = NULL;
     child_len = 0;
 
-    if (depth < g_utf8_strlen (text, -1))
+    if (*next_char != '\0')
     {
         /* process next letter */
 
-        gchar *key_char;
         gunichar key_char_uc;
         guint key;
 
-        key_char = g_utf8_offset_to_pointer (text, depth);
-        key_char_uc = g_utf8_get_char (key_char);
+        key_char_uc = g_utf8_get_char (next_char);
         key = g_unichar_toupper (key_char_uc);
 
-        match_qf = g_hash_table_lookup (qf->matches, GUINT_TO_POINTER (key));
+        match_qf = quickfill_lookup (qf, key);
         if (match_qf)
         {
             /* remove text from child qf */
-            gnc_quickfill_remove_recursive (match_qf, text, depth + 1, sort);
+            gnc_quickfill_remove_recursive (match_qf, text,
+                                            g_utf8_next_char (next_char), sort);
 
             if (match_qf->text == NULL)
             {
                 /* text was the only word with a prefix up to match_qf */
-                g_hash_table_remove (qf->matches, GUINT_TO_POINTER (key));
+                quickfill_remove_match (qf, key);
                 gnc_quickfill_destroy (match_qf);
 
             }
@@ -403,11 +449,11 @@ gnc_quickfill_remove_recursive (QuickFill *qf, const gchar *text, gint depth,
     if (qf->text == NULL)
         return;
 
-    if (strcmp (text, qf->text) == 0)
+    if (strcmp (text, qf->text->str) == 0)
     {
         /* the currently best text is about to be removed */
 
-        gchar *best_text = NULL;
+        QuickFillText *best_text = NULL;
         gint best_len = 0;
 
         if (child_text != NULL)
@@ -419,28 +465,26 @@ gnc_quickfill_remove_recursive (QuickFill *qf, const gchar *text, gint depth,
         }
         else
         {
-            if (g_hash_table_size (qf->matches) != 0)
+            /* otherwise search for another good text */
+            for (guint i = 0; i < qf->n_matches; i++)
             {
-                /* otherwise search for another good text */
-                struct _BestText bts;
-                bts.text = NULL;
-                bts.sort = sort;
-
-                g_hash_table_foreach (qf->matches, (GHFunc) best_text_helper, &bts);
-                best_text = bts.text;
-                best_len = (best_text == NULL) ? 0 : g_utf8_strlen (best_text, -1);
+                QuickFillText *match_text = qf->matches[i].qf->text;
+
+                if (match_text == NULL)
+                    continue;
+                if (best_text == NULL ||
+                    g_utf8_collate (match_text->str, best_text->str) < 0)
+                    best_text = match_text;
             }
+            best_len = (best_text == NULL) ? 0 : g_utf8_strlen (best_text->str, -1);
         }
 
         /* now replace or clear text */
-        g_free(qf->text);
         if (best_text != NULL)
-        {
-            qf->text = g_strdup(best_text);
-            qf->len = best_len;
-        }
+            quickfill_set_text (qf, best_text, best_len);
         else
         {
+            quickfill_text_unref (qf->text);
             qf->text = NULL;
             qf->len = 0;
         }
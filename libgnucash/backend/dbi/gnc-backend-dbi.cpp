@@ -374,6 +374,56 @@ error_handler<DbType::DBI_SQLITE> (dbi_conn conn, void* user_data)
         dbi_be->set_dbi_error (ERR_BACKEND_MISC, 0, false);
 }
 
+/* Run a pragma on a sqlite3 connection. A failure only costs speed, so it's
+ * just logged.
+ */
+static bool
+sqlite3_pragma (dbi_conn conn, const char* pragma)
+{
+    auto result = dbi_conn_queryf (conn, "PRAGMA %s", pragma);
+    if (result == nullptr)
+    {
+        PWARN ("Failed to set PRAGMA %s", pragma);
+        return false;
+    }
+    dbi_result_free (result);
+    return true;
+}
+
+/* The write-ahead log lets a transaction commit with a single sync and lets
+ * readers map the file instead of copying pages through the page cache, but
+ * it keeps -wal and -shm files next to the book, doesn't work on network file
+ * systems and with synchronous=NORMAL the last commits can be lost in a power
+ * failure. It's therefore only used when GNC_SQLITE_WAL is set; otherwise the
+ * book is kept in (or returned to) the rollback journal mode with full syncs.
+ * The journal mode is stored in the file, so it's left alone when the book is
+ * only read; the cache and map sizes only affect this connection.
+ */
+static bool
+sqlite3_use_wal ()
+{
+    return g_getenv ("GNC_SQLITE_WAL") != nullptr;
+}
+
+static const char*
+sqlite3_sync_pragma ()
+{
+    return sqlite3_use_wal () ? "synchronous=NORMAL" : "synchronous=FULL";
+}
+
+static void
+sqlite3_set_pragmas (dbi_conn conn, bool read_only)
+{
+    if (!read_only)
+    {
+        sqlite3_pragma (conn, sqlite3_use_wal () ? "journal_mode=WAL" :
+                        "journal_mode=DELETE");
+        sqlite3_pragma (conn, sqlite3_sync_pragma ());
+    }
+    sqlite3_pragma (conn, "cache_size=-32768");
+    sqlite3_pragma (conn, "mmap_size=268435456");
+}
+
 template <> void
 GncDbiBackend<DbType::DBI_SQLITE>::session_begin(QofSession* session,
                                                  const char* new_uri,
@@ -463,6 +513,12 @@ GncDbiBackend<DbType::DBI_SQLITE>::session_begin(QofSession* session,
         return;
     }
 
+    /* The page size can only be changed before the first table, the lock
+     * table included, is created. */
+    if (create)
+        sqlite3_pragma (conn, "page_size=8192");
+
+    m_exists = !create;
     try
     {
         connect(new GncDbiSqlConnection(DbType::DBI_SQLITE,
@@ -472,6 +528,8 @@ GncDbiBackend<DbType::DBI_SQLITE>::session_begin(QofSession* session,
     {
         return;
     }
+    /* Don't touch the file until we know that it's ours to change. */
+    sqlite3_set_pragmas (conn, mode == SESSION_READ_ONLY);
 
     /* We should now have a proper session set up.
      * Let's start logging */
@@ -785,6 +843,23 @@ GncDbiBackend<Type>::session_begin (QofSession* session, const char* new_uri,
     PINFO ("logpath=%s", translog_path ? translog_path : "(null)");
     g_free (translog_path);
 
+    /* Replay the writes a crashed session left in the write-behind journal
+     * and, if asked for, queue this session's commits behind a writer
+     * thread so that they don't wait for the server. */
+    if (mode != SESSION_READ_ONLY)
+    {
+        auto journal = uri.basename() + ".journal";
+        auto journal_path = gnc_build_translog_path (journal.c_str());
+        if (create)
+            g_remove (journal_path);
+        set_write_behind (journal_path,
+                          g_getenv ("GNC_SQL_WRITE_BEHIND") != nullptr);
+        g_free (journal_path);
+    }
+    /* Let sessions sharing the database pick up each other's changes
+     * without reopening the book. */
+    set_change_log (g_getenv ("GNC_SQL_CHANGE_LOG") != nullptr);
+
     LEAVE (" ");
 }
 
@@ -854,6 +929,23 @@ GncDbiBackend<Type>::session_end ()
     LEAVE (" ");
 }
 
+/* Leave a complete book behind: a write-ahead log is checkpointed into the
+ * file and truncated before the connection is closed.
+ */
+template <> void
+GncDbiBackend<DbType::DBI_SQLITE>::session_end ()
+{
+    ENTER (" ");
+
+    finalize_version_info ();
+    auto conn = dynamic_cast<GncDbiSqlConnection*>(m_conn);
+    if (conn && !conn->is_readonly() && sqlite3_use_wal ())
+        sqlite3_pragma (conn->conn(), "wal_checkpoint(TRUNCATE)");
+    connect(nullptr);
+
+    LEAVE (" ");
+}
+
 template <DbType Type>
 GncDbiBackend<Type>::~GncDbiBackend()
 {
@@ -913,6 +1005,54 @@ GncDbiBackend<Type>::load (QofBook* book, QofBackendLoadType loadType)
     LEAVE ("");
 }
 
+template <DbType Type> bool
+GncDbiBackend<Type>::begin_bulk_write (QofBook* book)
+{
+    return GncSqlBackend::begin_bulk_write (book);
+}
+
+template <DbType Type> void
+GncDbiBackend<Type>::end_bulk_write (bool complete)
+{
+    GncSqlBackend::end_bulk_write (complete);
+}
+
+/* Saving into a new file writes every object in the book; if that fails
+ * the file is useless anyway, so there's no point in syncing the disk along
+ * the way. Durability is restored, and a write-ahead log checkpointed into
+ * the file, once everything is written.
+ */
+template <> bool
+GncDbiBackend<DbType::DBI_SQLITE>::begin_bulk_write (QofBook* book)
+{
+    auto conn = dynamic_cast<GncDbiSqlConnection*>(m_conn);
+    if (m_exists || conn == nullptr)
+        return GncSqlBackend::begin_bulk_write (book);
+
+    sqlite3_pragma (conn->conn(), "synchronous=OFF");
+    if (GncSqlBackend::begin_bulk_write (book))
+        return true;
+    sqlite3_pragma (conn->conn(), sqlite3_sync_pragma ());
+    return false;
+}
+
+template <> void
+GncDbiBackend<DbType::DBI_SQLITE>::end_bulk_write (bool complete)
+{
+    GncSqlBackend::end_bulk_write (complete);
+    auto conn = dynamic_cast<GncDbiSqlConnection*>(m_conn);
+    if (m_exists || conn == nullptr)
+        return;
+
+    sqlite3_pragma (conn->conn(), sqlite3_sync_pragma ());
+    if (!check_error())
+    {
+        if (sqlite3_use_wal ())
+            sqlite3_pragma (conn->conn(), "wal_checkpoint(TRUNCATE)");
+        m_exists = true;
+    }
+}
+
 /* ================================================================= */
 /* This is used too early to call GncDbiProvider::get_table_list(). */
 template <DbType T> bool
@@ -965,6 +1105,7 @@ GncDbiBackend<Type>::safe_sync (QofBook* book)
     g_return_if_fail (book != nullptr);
 
     ENTER ("book=%p, primary=%p", book, m_book);
+    flush_writes();
     if (!conn->begin_transaction())
     {
         LEAVE("Failed to obtain a transaction.");
@@ -1008,6 +1149,7 @@ GncDbiBackend<DbType::DBI_MYSQL>::safe_sync (QofBook* book)
     g_return_if_fail (book != nullptr);
 
     ENTER ("book=%p, primary=%p", book, m_book);
+    flush_writes();
     if (!conn->table_operation (TableOpType::backup))
     {
         set_error(ERR_BACKEND_SERVER_ERR);
@@ -95,6 +95,8 @@ public:
     void session_begin(QofSession*, const char*, SessionOpenMode) override;
     void session_end() override;
     void load(QofBook*, QofBackendLoadType) override;
+    bool begin_bulk_write(QofBook*) override;
+    void end_bulk_write(bool) override;
     void safe_sync(QofBook*) override;
     bool connected() const noexcept { return m_conn != nullptr; }
     /** FIXME: Just a pass-through to m_conn: */
@@ -27,6 +27,7 @@ extern "C"
 #include <config.h>
 #include <platform.h>
 #include <gnc-locale-utils.h>
+#include <gmodule.h>
 }
 
 #include <string>
@@ -82,7 +83,7 @@ GncDbiSqlStatement::add_where_cond(QofIdTypeConst type_name,
 
 GncDbiSqlConnection::GncDbiSqlConnection (DbType type, QofBackend* qbe,
                                           dbi_conn conn, SessionOpenMode mode) :
-    m_qbe{qbe}, m_conn{conn},
+    m_type{type}, m_qbe{qbe}, m_conn{conn},
     m_provider{type == DbType::DBI_SQLITE ?
             make_dbi_provider<DbType::DBI_SQLITE>() :
             type == DbType::DBI_MYSQL ?
@@ -102,6 +103,16 @@ GncDbiSqlConnection::GncDbiSqlConnection (DbType type, QofBackend* qbe,
     }
 }
 
+GncDbiSqlConnection::GncDbiSqlConnection (DbType type, dbi_conn conn) :
+    m_type{type}, m_qbe{nullptr}, m_conn{conn},
+    m_provider{type == DbType::DBI_MYSQL ?
+            make_dbi_provider<DbType::DBI_MYSQL>() :
+            make_dbi_provider<DbType::DBI_PGSQL>()},
+    m_conn_ok{false}, m_last_error{ERR_BACKEND_NO_ERR}, m_error_repeat{0},
+    m_retry{false}, m_sql_savepoint{0}, m_readonly{true}, m_reader{true}
+{
+}
+
 bool
 GncDbiSqlConnection::lock_database (bool break_lock)
 {
@@ -249,14 +260,97 @@ GncDbiSqlConnection::check_and_rollback_failed_save()
 
 GncDbiSqlConnection::~GncDbiSqlConnection()
 {
+    free_released_results();
     if (m_conn)
     {
-        unlock_database();
+        if (!m_reader)
+            unlock_database();
         dbi_conn_close(m_conn);
         m_conn = nullptr;
     }
 }
 
+GncSqlConnection*
+GncDbiSqlConnection::open_reader() const noexcept
+{
+    /* SQLite serializes the readers anyway and a second connection would
+     * have to wait for the lock table transaction. */
+    if (m_type == DbType::DBI_SQLITE || m_reader || m_conn == nullptr)
+        return nullptr;
+    /* The dbi instance isn't thread safe, so the connection is created here
+     * and only connected on the reader's thread. */
+    auto conn = dbi_conn_open (dbi_conn_get_driver (m_conn));
+    if (conn == nullptr)
+        return nullptr;
+    const char* option = nullptr;
+    while ((option = dbi_conn_get_option_list (m_conn, option)) != nullptr)
+    {
+        auto value = dbi_conn_get_option (m_conn, option);
+        if (value != nullptr)
+            dbi_conn_set_option (conn, option, value);
+        else
+            dbi_conn_set_option_numeric (conn, option,
+                                         dbi_conn_get_option_numeric (m_conn,
+                                                                      option));
+    }
+    return new GncDbiSqlConnection (m_type, conn);
+}
+
+void
+GncDbiSqlConnection::free_released_results() const noexcept
+{
+    for (auto result : m_released_results)
+        dbi_result_free (result);
+    m_released_results.clear();
+}
+
+void
+GncDbiSqlConnection::release_reader_result (dbi_result result) const noexcept
+{
+    std::lock_guard<std::mutex> lock{m_reader_mutex};
+    if (m_thread_ended)
+        dbi_result_free (result);
+    else
+        m_released_results.push_back (result);
+}
+
+/* libdbi has no call for releasing a thread's client library state, so the
+ * MySQL client's own one is used when the driver made it visible. The
+ * connection and its results stay valid, they're freed on the backend's
+ * thread.
+ */
+void
+GncDbiSqlConnection::end_thread() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock{m_reader_mutex};
+        free_released_results();
+        m_thread_ended = true;
+    }
+    if (m_type != DbType::DBI_MYSQL || !m_conn_ok)
+        return;
+    static auto mysql_thread_end = []()
+    {
+        gpointer symbol = nullptr;
+        auto self = g_module_open (nullptr, G_MODULE_BIND_LAZY);
+        if (self == nullptr ||
+            !g_module_symbol (self, "mysql_thread_end", &symbol))
+            symbol = nullptr;
+        return reinterpret_cast<void (*)(void)>(symbol);
+    }();
+    if (mysql_thread_end != nullptr)
+        mysql_thread_end ();
+}
+
+void
+GncDbiSqlConnection::report_error (QofBackendError error) noexcept
+{
+    if (!m_defer_errors)
+        qof_backend_set_error (m_qbe, error);
+    else if (m_deferred_error == ERR_BACKEND_NO_ERR)
+        m_deferred_error = error;
+}
+
 GncSqlResultPtr
 GncDbiSqlConnection::execute_select_statement (const GncSqlStatementPtr& stmt)
     noexcept
@@ -264,6 +358,28 @@ GncDbiSqlConnection::execute_select_statement (const GncSqlStatementPtr& stmt)
     dbi_result result;
 
     DEBUG ("SQL: %s\n", stmt->to_sql());
+    if (m_reader)
+    {
+        /* No retries, locale switching or error reporting here: those
+         * aren't thread safe and the backend just executes the statement
+         * itself if this fails. */
+        if (m_last_error != ERR_BACKEND_NO_ERR)
+            return nullptr;
+        if (!m_conn_ok && dbi_conn_connect (m_conn) < 0)
+        {
+            m_last_error = ERR_BACKEND_CANT_CONNECT;
+            return nullptr;
+        }
+        m_conn_ok = true;
+        {
+            std::lock_guard<std::mutex> lock{m_reader_mutex};
+            free_released_results();
+        }
+        result = dbi_conn_query (m_conn, stmt->to_sql());
+        if (result == nullptr)
+            return nullptr;
+        return GncSqlResultPtr(new GncDbiSqlResult (this, result));
+    }
     auto locale = gnc_push_locale (LC_NUMERIC, "C");
     do
     {
@@ -275,9 +391,9 @@ GncDbiSqlConnection::execute_select_statement (const GncSqlStatementPtr& stmt)
     {
         PERR ("Error executing SQL %s\n", stmt->to_sql());
         if(m_last_error)
-            m_qbe->set_error(m_last_error);
+            report_error (m_last_error);
         else
-            m_qbe->set_error(ERR_BACKEND_SERVER_ERR);
+            report_error (ERR_BACKEND_SERVER_ERR);
     }
     gnc_pop_locale (LC_NUMERIC, locale);
     return GncSqlResultPtr(new GncDbiSqlResult (this, result));
@@ -300,9 +416,9 @@ GncDbiSqlConnection::execute_nonselect_statement (const GncSqlStatementPtr& stmt
     {
         PERR ("Error executing SQL %s\n", stmt->to_sql());
         if(m_last_error)
-            m_qbe->set_error(m_last_error);
+            report_error (m_last_error);
         else
-            m_qbe->set_error(ERR_BACKEND_SERVER_ERR);
+            report_error (ERR_BACKEND_SERVER_ERR);
         return -1;
     }
     if (!result)
@@ -313,9 +429,9 @@ GncDbiSqlConnection::execute_nonselect_statement (const GncSqlStatementPtr& stmt
     {
         PERR ("Error in dbi_result_free() result\n");
         if(m_last_error)
-            m_qbe->set_error(m_last_error);
+            report_error (m_last_error);
         else
-            m_qbe->set_error(ERR_BACKEND_SERVER_ERR);
+            report_error (ERR_BACKEND_SERVER_ERR);
     }
     return num_rows;
 }
@@ -344,7 +460,7 @@ GncDbiSqlConnection::begin_transaction () noexcept
     if (!verify ())
     {
         PERR ("gnc_dbi_verify_conn() failed\n");
-        qof_backend_set_error (m_qbe, ERR_BACKEND_SERVER_ERR);
+        report_error (ERR_BACKEND_SERVER_ERR);
         return false;
     }
 
@@ -366,13 +482,13 @@ GncDbiSqlConnection::begin_transaction () noexcept
     if (!result)
     {
         PERR ("BEGIN transaction failed()\n");
-        qof_backend_set_error (m_qbe, ERR_BACKEND_SERVER_ERR);
+        report_error (ERR_BACKEND_SERVER_ERR);
         return false;
     }
     if (dbi_result_free (result) < 0)
     {
         PERR ("Error in dbi_result_free() result\n");
-        qof_backend_set_error (m_qbe, ERR_BACKEND_SERVER_ERR);
+        report_error (ERR_BACKEND_SERVER_ERR);
         return false;
     }
     ++m_sql_savepoint;
@@ -397,14 +513,14 @@ GncDbiSqlConnection::rollback_transaction () noexcept
     if (!result)
     {
         PERR ("Error in conn_rollback_transaction()\n");
-        qof_backend_set_error (m_qbe, ERR_BACKEND_SERVER_ERR);
+        report_error (ERR_BACKEND_SERVER_ERR);
         return false;
     }
 
     if (dbi_result_free (result) < 0)
     {
         PERR ("Error in dbi_result_free() result\n");
-        qof_backend_set_error (m_qbe, ERR_BACKEND_SERVER_ERR);
+        report_error (ERR_BACKEND_SERVER_ERR);
         return false;
     }
 
@@ -431,14 +547,14 @@ GncDbiSqlConnection::commit_transaction () noexcept
     if (!result)
     {
         PERR ("Error in conn_commit_transaction()\n");
-        qof_backend_set_error (m_qbe, ERR_BACKEND_SERVER_ERR);
+        report_error (ERR_BACKEND_SERVER_ERR);
         return false;
     }
 
     if (dbi_result_free (result) < 0)
     {
         PERR ("Error in dbi_result_free() result\n");
-        qof_backend_set_error (m_qbe, ERR_BACKEND_SERVER_ERR);
+        report_error (ERR_BACKEND_SERVER_ERR);
         return false;
     }
     --m_sql_savepoint;
@@ -23,6 +23,7 @@
 #ifndef _GNC_DBISQLCONNECTION_HPP_
 #define _GNC_DBISQLCONNECTION_HPP_
 
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -80,12 +81,32 @@ public:
      */
     bool verify() noexcept override;
     bool retry_connection(const char* msg) noexcept override;
+    GncSqlConnection* open_reader() const noexcept override;
+    void end_thread() noexcept override;
+    void defer_errors() noexcept override
+    {
+        m_defer_errors = true;
+        m_deferred_error = ERR_BACKEND_NO_ERR;
+    }
+    QofBackendError end_defer_errors() noexcept override
+    {
+        m_defer_errors = false;
+        return m_deferred_error;
+    }
+    /** Readers own their results, see open_reader(). */
+    bool is_reader() const noexcept { return m_reader; }
+    /** Free a reader's result once it has been read, see m_reader_mutex. */
+    void release_reader_result(dbi_result result) const noexcept;
+    bool is_readonly() const noexcept { return m_readonly; }
 
     bool table_operation (TableOpType op) noexcept;
     std::string add_columns_ddl(const std::string& table_name,
                                 const ColVec& info_vec) const noexcept;
     bool drop_indexes() noexcept;
 private:
+    /** Reader constructor, see open_reader(). */
+    GncDbiSqlConnection (DbType type, dbi_conn conn);
+    DbType m_type;
     QofBackend* m_qbe = nullptr;
     dbi_conn m_conn;
     std::unique_ptr<GncDbiProvider> m_provider;
@@ -109,6 +130,21 @@ private:
     bool m_retry;
     unsigned int m_sql_savepoint;
     bool m_readonly; 
+    /** Set for a connection made by open_reader(). */
+    bool m_reader = false;
+    /** A reader's results are read on a different thread from the reader's
+     * queries and libdbi doesn't allow freeing them concurrently. Released
+     * results are therefore freed by the reader's thread before its next
+     * query or when it ends, and right away once it has ended. The mutex
+     * protects the two members below. */
+    mutable std::mutex m_reader_mutex;
+    mutable std::vector<dbi_result> m_released_results;
+    mutable bool m_thread_ended = false;
+    void free_released_results() const noexcept;
+    /** Set between defer_errors() and end_defer_errors(). */
+    bool m_defer_errors = false;
+    QofBackendError m_deferred_error = ERR_BACKEND_NO_ERR;
+    void report_error(QofBackendError error) noexcept;
     bool lock_database(bool break_lock);
     void unlock_database();
     bool rename_table(const std::string& old_name, const std::string& new_name);
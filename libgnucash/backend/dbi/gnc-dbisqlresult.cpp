@@ -43,8 +43,40 @@ static QofLogModule log_module = G_LOG_DOMAIN;
 #define HAVE_LIBDBI_TO_LONGLONG 0
 #endif
 
+GncDbiSqlResult::GncDbiSqlResult(const GncDbiSqlConnection* conn,
+                                 dbi_result result) :
+    m_conn{conn}, m_dbi_result{result}, m_iter{this}, m_row{&m_iter},
+    m_sentinel{nullptr}
+{
+    if (m_dbi_result == nullptr)
+        return;
+    /* libdbi looks fields up by name with a linear scan, which would be done
+     * several times for every cell; resolve the names and types once here
+     * and decode the rows by field index. */
+    auto nfields = dbi_result_get_numfields (m_dbi_result);
+    if (nfields == DBI_FIELD_ERROR)
+        return;
+    m_fields.reserve (nfields);
+    for (unsigned int idx = 1; idx <= nfields; ++idx)
+    {
+        auto name = dbi_result_get_field_name (m_dbi_result, idx);
+        if (name == nullptr)
+            continue;
+        FieldInfo field{idx,
+                        dbi_result_get_field_type_idx (m_dbi_result, idx),
+                        dbi_result_get_field_attribs_idx (m_dbi_result, idx)};
+        /* Like libdbi, the first of several fields with the same name wins. */
+        m_fields.emplace (name, field);
+    }
+}
+
 GncDbiSqlResult::~GncDbiSqlResult()
 {
+    if (m_conn->is_reader())
+    {
+        m_conn->release_reader_result (m_dbi_result);
+        return;
+    }
     int status = dbi_result_free (m_dbi_result);
 
     if (status == 0)
@@ -85,6 +117,16 @@ GncDbiSqlResult::size() const noexcept
 {
     return dbi_result_get_numrows(m_dbi_result);
 }
+
+const GncDbiSqlResult::FieldInfo&
+GncDbiSqlResult::field_info (const char* col) const noexcept
+{
+    /* Index 0 is never a valid field and type 0 is DBI_TYPE_ERROR, so
+     * lookups of unknown columns fail the same way libdbi's do. */
+    static const FieldInfo no_field{0, 0, 0};
+    auto field = m_fields.find (col);
+    return field == m_fields.end() ? no_field : field->second;
+}
 /* --------------------------------------------------------- */
 
 GncSqlRow&
@@ -104,23 +146,22 @@ GncDbiSqlResult::IteratorImpl::operator++()
 int64_t
 GncDbiSqlResult::IteratorImpl::get_int_at_col(const char* col) const
 {
-    auto type = dbi_result_get_field_type (m_inst->m_dbi_result, col);
-    if(type != DBI_TYPE_INTEGER)
+    auto& field = m_inst->field_info (col);
+    if(field.type != DBI_TYPE_INTEGER)
         throw (std::invalid_argument{"Requested integer from non-integer column."});
-    return dbi_result_get_longlong (m_inst->m_dbi_result, col);
+    return dbi_result_get_longlong_idx (m_inst->m_dbi_result, field.idx);
 }
 
 double
 GncDbiSqlResult::IteratorImpl::get_float_at_col(const char* col) const
 {
     constexpr double float_precision = 1000000.0;
-    auto type = dbi_result_get_field_type (m_inst->m_dbi_result, col);
-    auto attrs = dbi_result_get_field_attribs (m_inst->m_dbi_result, col);
-    if(type != DBI_TYPE_DECIMAL ||
-       (attrs & DBI_DECIMAL_SIZEMASK) != DBI_DECIMAL_SIZE4)
+    auto& field = m_inst->field_info (col);
+    if(field.type != DBI_TYPE_DECIMAL ||
+       (field.attribs & DBI_DECIMAL_SIZEMASK) != DBI_DECIMAL_SIZE4)
         throw (std::invalid_argument{"Requested float from non-float column."});
     auto locale = gnc_push_locale (LC_NUMERIC, "C");
-    auto interim =  dbi_result_get_float(m_inst->m_dbi_result, col);
+    auto interim =  dbi_result_get_float_idx(m_inst->m_dbi_result, field.idx);
     gnc_pop_locale (LC_NUMERIC, locale);
     double retval = static_cast<double>(round(interim * float_precision)) / float_precision;
     return retval;
@@ -129,13 +170,12 @@ GncDbiSqlResult::IteratorImpl::get_float_at_col(const char* col) const
 double
 GncDbiSqlResult::IteratorImpl::get_double_at_col(const char* col) const
 {
-    auto type = dbi_result_get_field_type (m_inst->m_dbi_result, col);
-    auto attrs = dbi_result_get_field_attribs (m_inst->m_dbi_result, col);
-    if(type != DBI_TYPE_DECIMAL ||
-       (attrs & DBI_DECIMAL_SIZEMASK) != DBI_DECIMAL_SIZE8)
+    auto& field = m_inst->field_info (col);
+    if(field.type != DBI_TYPE_DECIMAL ||
+       (field.attribs & DBI_DECIMAL_SIZEMASK) != DBI_DECIMAL_SIZE8)
         throw (std::invalid_argument{"Requested double from non-double column."});
     auto locale = gnc_push_locale (LC_NUMERIC, "C");
-    auto retval =  dbi_result_get_double(m_inst->m_dbi_result, col);
+    auto retval =  dbi_result_get_double_idx(m_inst->m_dbi_result, field.idx);
     gnc_pop_locale (LC_NUMERIC, locale);
     return retval;
 }
@@ -143,11 +183,10 @@ GncDbiSqlResult::IteratorImpl::get_double_at_col(const char* col) const
 std::string
 GncDbiSqlResult::IteratorImpl::get_string_at_col(const char* col) const
 {
-    auto type = dbi_result_get_field_type (m_inst->m_dbi_result, col);
-    dbi_result_get_field_attribs (m_inst->m_dbi_result, col);
-    if(type != DBI_TYPE_STRING)
+    auto& field = m_inst->field_info (col);
+    if(field.type != DBI_TYPE_STRING)
         throw (std::invalid_argument{"Requested string from non-string column."});
-    auto strval = dbi_result_get_string(m_inst->m_dbi_result, col);
+    auto strval = dbi_result_get_string_idx(m_inst->m_dbi_result, field.idx);
     if (strval == nullptr)
     {
         throw (std::invalid_argument{"Column empty."});
@@ -155,19 +194,27 @@ GncDbiSqlResult::IteratorImpl::get_string_at_col(const char* col) const
     auto retval =  std::string{strval};
     return retval;
 }
+bool
+GncDbiSqlResult::IteratorImpl::is_col_null (const char* col) const noexcept
+{
+    auto& field = m_inst->field_info (col);
+    if (field.idx == 0)
+        return true;
+    return dbi_result_field_is_null_idx (m_inst->m_dbi_result, field.idx);
+}
+
 time64
 GncDbiSqlResult::IteratorImpl::get_time64_at_col (const char* col) const
 {
     auto result = (dbi_result_t*) (m_inst->m_dbi_result);
-    auto type = dbi_result_get_field_type (result, col);
-    dbi_result_get_field_attribs (result, col);
-    if (type != DBI_TYPE_DATETIME)
+    auto& field = m_inst->field_info (col);
+    if (field.type != DBI_TYPE_DATETIME)
         throw (std::invalid_argument{"Requested time64 from non-time64 column."});
 #if HAVE_LIBDBI_TO_LONGLONG
     /* A less evil hack than the one required by libdbi-0.8, but
      * still necessary to work around the same bug.
      */
-    auto retval = dbi_result_get_as_longlong(result, col);
+    auto retval = dbi_result_get_as_longlong_idx(result, field.idx);
 #else
     /* A seriously evil hack to work around libdbi bug #15
      * https://sourceforge.net/p/libdbi/bugs/15/. When libdbi
@@ -176,7 +223,7 @@ GncDbiSqlResult::IteratorImpl::get_time64_at_col (const char* col) const
      * Note: 0.9 is available in Debian Jessie and Fedora 21.
      */
     auto row = dbi_result_get_currow (result);
-    auto idx = dbi_result_get_field_idx (result, col) - 1;
+    auto idx = field.idx - 1;
     time64 retval = result->rows[row]->field_values[idx].d_datetime;
 #endif //HAVE_LIBDBI_TO_LONGLONG
     if (retval < MINTIME || retval > MAXTIME)
@@ -27,6 +27,8 @@
 
 #include "gnc-backend-dbi.h"
 #include <gnc-sql-result.hpp>
+#include <string_view>
+#include <unordered_map>
 
 class GncDbiSqlConnection;
 
@@ -36,9 +38,7 @@ class GncDbiSqlConnection;
 class GncDbiSqlResult : public GncSqlResult
 {
 public:
-    GncDbiSqlResult(const GncDbiSqlConnection* conn, dbi_result result) :
-        m_conn{conn}, m_dbi_result{result}, m_iter{this}, m_row{&m_iter},
-        m_sentinel{nullptr} {}
+    GncDbiSqlResult(const GncDbiSqlConnection* conn, dbi_result result);
     ~GncDbiSqlResult();
     uint64_t size() const noexcept;
     int dberror() const noexcept;
@@ -58,21 +58,28 @@ protected:
         virtual double get_double_at_col (const char* col) const;
         virtual std::string get_string_at_col (const char* col)const;
         virtual time64 get_time64_at_col (const char* col) const;
-        virtual bool is_col_null(const char* col) const noexcept
-        {
-            return dbi_result_field_is_null(m_inst->m_dbi_result, col);
-        }
+        virtual bool is_col_null(const char* col) const noexcept;
     private:
         GncDbiSqlResult* m_inst = nullptr;
     };
 
 private:
+    /** Type information for one field of the result, resolved once per
+     * result set so that rows can be decoded by index. */
+    struct FieldInfo
+    {
+        unsigned int idx;
+        unsigned short type;
+        unsigned int attribs;
+    };
+    const FieldInfo& field_info (const char* col) const noexcept;
     const GncDbiSqlConnection* m_conn = nullptr;
     dbi_result m_dbi_result;
     IteratorImpl m_iter;
     GncSqlRow m_row;
     GncSqlRow m_sentinel;
-
+    /* Keyed by the field names owned by m_dbi_result. */
+    std::unordered_map<std::string_view, FieldInfo> m_fields;
 };
 
 #endif //__GNC_DBISQLRESULT_HPP__
@@ -209,27 +209,10 @@ load_single_account (GncSqlBackend* sql_be, GncSqlRow& row,
     return pAccount;
 }
 
-void
-GncSqlAccountBackend::load_all (GncSqlBackend* sql_be)
+/* Attach the loaded accounts whose parents weren't loaded yet. */
+static void
+resolve_parents (GncSqlBackend* sql_be, ParentGuidVec& l_accounts_needing_parents)
 {
-    QofBook* pBook;
-    ParentGuidVec l_accounts_needing_parents;
-    g_return_if_fail (sql_be != NULL);
-
-    ENTER ("");
-
-    pBook = sql_be->book();
-
-    std::string sql("SELECT * FROM " TABLE_NAME);
-    auto stmt = sql_be->create_statement_from_sql(sql);
-    auto result = sql_be->execute_select_statement(stmt);
-    for (auto row : *result)
-        load_single_account (sql_be, row, l_accounts_needing_parents);
-
-    sql = "SELECT DISTINCT guid FROM " TABLE_NAME;
-    gnc_sql_slots_load_for_sql_subquery (sql_be, sql,
-                                         (BookLookupFn)xaccAccountLookup);
-
     /* While there are items on the list of accounts needing parents,
        try to see if the parent has now been loaded.  Theory says that if
        items are removed from the front and added to the back if the
@@ -262,7 +245,7 @@ GncSqlAccountBackend::load_all (GncSqlBackend* sql_be)
         }
 
         /* Any non-ROOT accounts left over must be parented by the root account */
-        auto root = gnc_book_get_root_account (pBook);
+        auto root = gnc_book_get_root_account (sql_be->book());
         end = std::remove_if(l_accounts_needing_parents.begin(), end,
 			     [&](ParentGuidPtr s)
 			     {
@@ -272,10 +255,94 @@ GncSqlAccountBackend::load_all (GncSqlBackend* sql_be)
 				 return true;
 			     });
     }
+}
+
+void
+GncSqlAccountBackend::load_all (GncSqlBackend* sql_be)
+{
+    ParentGuidVec l_accounts_needing_parents;
+    g_return_if_fail (sql_be != NULL);
+
+    ENTER ("");
+
+    std::string sql("SELECT * FROM " TABLE_NAME);
+    auto stmt = sql_be->create_statement_from_sql(sql);
+    auto result = sql_be->execute_select_statement(stmt);
+    for (auto row : *result)
+        load_single_account (sql_be, row, l_accounts_needing_parents);
+
+    sql = "SELECT DISTINCT guid FROM " TABLE_NAME;
+    gnc_sql_slots_load_for_sql_subquery (sql_be, sql,
+                                         (BookLookupFn)xaccAccountLookup);
+
+    resolve_parents (sql_be, l_accounts_needing_parents);
 
     LEAVE ("");
 }
 
+/**
+ * Reloads accounts changed by another session. Deleted accounts are only
+ * removed if nothing here refers to them any more.
+ */
+bool
+GncSqlAccountBackend::load_changed (GncSqlBackend* sql_be,
+                                    const std::vector<GncGUID>& guids)
+{
+    ParentGuidVec l_accounts_needing_parents;
+    g_return_val_if_fail (sql_be != NULL, false);
+
+    std::string selector{"("};
+    for (auto const& guid : guids)
+    {
+        if (selector.size() > 1)
+            selector += ",";
+        selector += "'" + gnc::GUID(guid).to_string() + "'";
+    }
+    selector += ")";
+
+    std::string sql("SELECT * FROM " TABLE_NAME " WHERE guid IN " + selector);
+    auto stmt = sql_be->create_statement_from_sql(sql);
+    auto result = sql_be->execute_select_statement(stmt);
+    if (result == nullptr)
+        return false;
+    AccountVec loaded;
+    for (auto row : *result)
+        loaded.push_back (load_single_account (sql_be, row,
+                                               l_accounts_needing_parents));
+    delete result;
+
+    sql = "SELECT DISTINCT guid FROM " TABLE_NAME " WHERE guid IN " + selector;
+    gnc_sql_slots_load_for_sql_subquery (sql_be, sql,
+                                         (BookLookupFn)xaccAccountLookup);
+    resolve_parents (sql_be, l_accounts_needing_parents);
+
+    for (auto const& guid : guids)
+    {
+        auto pAccount = xaccAccountLookup (&guid, sql_be->book());
+        if (pAccount == nullptr ||
+            std::find (loaded.begin(), loaded.end(), pAccount) != loaded.end())
+            continue;
+        if (xaccAccountGetSplitList (pAccount) != nullptr ||
+            gnc_account_n_children (pAccount) > 0)
+        {
+            PWARN ("Account %s was deleted elsewhere but is still in use.",
+                   xaccAccountGetName (pAccount));
+            continue;
+        }
+        xaccAccountBeginEdit (pAccount);
+        xaccAccountDestroy (pAccount);
+    }
+    return true;
+}
+
+std::vector<std::string>
+GncSqlAccountBackend::load_statements () const
+{
+    return {"SELECT * FROM " TABLE_NAME,
+            gnc_sql_slots_sql_for_subquery ("SELECT DISTINCT guid FROM "
+                                            TABLE_NAME)};
+}
+
 /* ================================================================= */
 bool
 GncSqlAccountBackend::commit (GncSqlBackend* sql_be, QofInstance* inst)
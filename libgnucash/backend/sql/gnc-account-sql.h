@@ -36,6 +36,8 @@ class GncSqlAccountBackend : public GncSqlObjectBackend
 public:
     GncSqlAccountBackend();
     void load_all(GncSqlBackend*) override;
+    std::vector<std::string> load_statements() const override;
+    bool load_changed(GncSqlBackend*, const std::vector<GncGUID>&) override;
     bool commit(GncSqlBackend*, QofInstance*) override;
 };
 
@@ -335,11 +335,21 @@ GncSqlBudgetBackend::load_all (GncSqlBackend* sql_be)
     for (auto row : *result)
         load_single_budget (sql_be, row);
 
+    /* The slots are written straight into the budgets' KVP, which hold the
+     * amounts. Loading them inside an edit makes the budgets drop the
+     * amounts they cached when the edit is committed. */
+    auto budgets = qof_book_get_collection (sql_be->book(), GNC_ID_BUDGET);
+    qof_collection_foreach (budgets, [](QofInstance* inst, gpointer)
+                            { gnc_budget_begin_edit (GNC_BUDGET (inst)); },
+                            nullptr);
     std::string pkey(col_table[0]->name());
     sql = "SELECT DISTINCT ";
     sql += pkey + " FROM " BUDGET_TABLE;
     gnc_sql_slots_load_for_sql_subquery (sql_be, sql,
 					 (BookLookupFn)gnc_budget_lookup);
+    qof_collection_foreach (budgets, [](QofInstance* inst, gpointer)
+                            { gnc_budget_commit_edit (GNC_BUDGET (inst)); },
+                            nullptr);
 }
 
 /* ================================================================= */
@@ -0,0 +1,176 @@
+/********************************************************************
+ * gnc-change-log-sql.cpp: record changes for other sessions        *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+/** @file gnc-change-log-sql.cpp
+ *  @brief record the committed objects so that other sessions can refresh
+ */
+#include <guid.hpp>
+extern "C"
+{
+#include <config.h>
+
+#include <glib.h>
+
+#include "qof.h"
+}
+
+#include <sstream>
+
+#include "gnc-sql-connection.hpp"
+#include "gnc-sql-backend.hpp"
+#include "gnc-sql-object-backend.hpp"
+#include "gnc-sql-column-table-entry.hpp"
+#include "gnc-sql-result.hpp"
+#include "gnc-change-log-sql.h"
+
+static QofLogModule log_module = G_LOG_DOMAIN;
+
+#define TABLE_NAME "changes"
+#define TABLE_VERSION 1
+
+#define CHANGE_MAX_TYPE_LEN 40
+
+static const EntryVec col_table
+({
+    gnc_sql_make_table_entry<CT_INT>(
+        "id", 0, COL_PKEY | COL_NNUL | COL_AUTOINC),
+    gnc_sql_make_table_entry<CT_GUID>("session", 0, COL_NNUL),
+    gnc_sql_make_table_entry<CT_STRING>(
+        "obj_type", CHANGE_MAX_TYPE_LEN, COL_NNUL),
+    gnc_sql_make_table_entry<CT_GUID>("obj_guid", 0, COL_NNUL),
+    gnc_sql_make_table_entry<CT_INT>("operation", 0, COL_NNUL),
+});
+
+GncSqlChangeLogBackend::GncSqlChangeLogBackend() :
+    GncSqlObjectBackend(TABLE_VERSION, GNC_ID_ACCOUNT,
+                        TABLE_NAME, col_table) {}
+
+/* ================================================================= */
+void
+GncSqlChangeLogBackend::create_tables (GncSqlBackend* sql_be)
+{
+    g_return_if_fail (sql_be != NULL);
+
+    if (!sql_be->change_log() || sql_be->get_table_version (TABLE_NAME) != 0)
+        return;
+    (void)sql_be->create_table (TABLE_NAME, TABLE_VERSION, col_table);
+}
+
+gboolean
+gnc_sql_change_log_exists (GncSqlBackend* sql_be)
+{
+    g_return_val_if_fail (sql_be != NULL, FALSE);
+
+    return sql_be->get_table_version (TABLE_NAME) != 0;
+}
+
+gboolean
+gnc_sql_change_log_append (GncSqlBackend* sql_be, const std::string& session,
+                           QofIdTypeConst type, const GncGUID* guid,
+                           E_DB_OPERATION op)
+{
+    g_return_val_if_fail (sql_be != NULL, FALSE);
+    g_return_val_if_fail (type != NULL, FALSE);
+    g_return_val_if_fail (guid != NULL, FALSE);
+
+    std::stringstream sql;
+    sql << "INSERT INTO " TABLE_NAME " (session, obj_type, obj_guid, "
+        "operation) VALUES ('" << session << "', '" << type << "', '" <<
+        gnc::GUID(*guid).to_string() << "', " << static_cast<int>(op) << ")";
+    auto stmt = sql_be->create_statement_from_sql (sql.str());
+    if (stmt == nullptr)
+        return FALSE;
+    return sql_be->execute_nonselect_statement (stmt) != -1;
+}
+
+int64_t
+gnc_sql_change_log_last_id (GncSqlBackend* sql_be)
+{
+    g_return_val_if_fail (sql_be != NULL, 0);
+
+    auto stmt = sql_be->create_statement_from_sql (
+        "SELECT MAX(id) AS last_id FROM " TABLE_NAME);
+    if (stmt == nullptr)
+        return 0;
+    auto result = sql_be->execute_select_statement (stmt);
+    if (result == nullptr)
+        return 0;
+    int64_t last_id = 0;
+    for (auto row : *result)
+    {
+        if (!row.is_col_null ("last_id"))
+            last_id = row.get_int_at_col ("last_id");
+        break;
+    }
+    delete result;
+    return last_id;
+}
+
+GncSqlChangeVec
+gnc_sql_change_log_read (GncSqlBackend* sql_be, int64_t after)
+{
+    GncSqlChangeVec changes;
+    g_return_val_if_fail (sql_be != NULL, changes);
+
+    std::stringstream sql;
+    sql << "SELECT * FROM " TABLE_NAME " WHERE id > " << after <<
+        " ORDER BY id";
+    auto stmt = sql_be->create_statement_from_sql (sql.str());
+    if (stmt == nullptr)
+        return changes;
+    auto result = sql_be->execute_select_statement (stmt);
+    if (result == nullptr)
+        return changes;
+    for (auto row : *result)
+    {
+        GncSqlChange change;
+        change.id = row.get_int_at_col ("id");
+        change.session = row.get_string_at_col ("session");
+        change.obj_type = row.get_string_at_col ("obj_type");
+        auto guid = row.get_string_at_col ("obj_guid");
+        if (!string_to_guid (guid.c_str(), &change.guid))
+        {
+            PWARN ("Change %" G_GINT64_FORMAT " has a malformed guid %s",
+                   change.id, guid.c_str());
+            continue;
+        }
+        change.op = static_cast<E_DB_OPERATION>(row.get_int_at_col ("operation"));
+        changes.push_back (std::move(change));
+    }
+    delete result;
+    return changes;
+}
+
+void
+gnc_sql_change_log_prune (GncSqlBackend* sql_be, int64_t keep)
+{
+    g_return_if_fail (sql_be != NULL);
+
+    auto last = gnc_sql_change_log_last_id (sql_be) - keep;
+    if (last <= 0)
+        return;
+    std::stringstream sql;
+    sql << "DELETE FROM " TABLE_NAME " WHERE id <= " << last;
+    auto stmt = sql_be->create_statement_from_sql (sql.str());
+    if (stmt != nullptr)
+        (void)sql_be->execute_nonselect_statement (stmt);
+}
+
+/* ========================== END OF FILE ===================== */
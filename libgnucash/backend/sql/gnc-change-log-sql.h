@@ -0,0 +1,118 @@
+/********************************************************************
+ * gnc-change-log-sql.h: record changes for other sessions          *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+/** @file gnc-change-log-sql.h
+ *  @brief record the committed objects so that other sessions can refresh
+ *
+ * Every commit of a session with the change log enabled appends a row
+ * naming the object's type and guid, the operation and the session. Other
+ * sessions poll the table for rows after the last one they've seen and
+ * reload just those objects.
+ */
+
+#ifndef GNC_CHANGE_LOG_SQL_H
+#define GNC_CHANGE_LOG_SQL_H
+extern "C"
+{
+#include <glib.h>
+#include "guid.h"
+#include "qof.h"
+}
+#include "gnc-sql-backend.hpp"
+#include "gnc-sql-object-backend.hpp"
+
+/**
+ * The change log is neither loadable nor committable; the backend appends to
+ * it and reads it directly.
+ */
+class GncSqlChangeLogBackend : public GncSqlObjectBackend
+{
+public:
+    GncSqlChangeLogBackend();
+    void load_all(GncSqlBackend*) override { return; }
+    /** Only creates the table if the backend's change log is enabled. */
+    void create_tables(GncSqlBackend*) override;
+    bool commit(GncSqlBackend*, QofInstance*) override { return false; }
+};
+
+/** One row of the change log. */
+struct GncSqlChange
+{
+    int64_t id;                 /**< Increases with every change */
+    std::string session;        /**< The session that made the change */
+    std::string obj_type;       /**< QofIdType of the object */
+    GncGUID guid;
+    E_DB_OPERATION op;
+};
+
+using GncSqlChangeVec = std::vector<GncSqlChange>;
+
+/**
+ * gnc_sql_change_log_exists - Check whether the database has a change log.
+ *
+ * @param sql_be SQL backend
+ * @return TRUE if the change log table exists
+ */
+gboolean gnc_sql_change_log_exists (GncSqlBackend* sql_be);
+
+/**
+ * gnc_sql_change_log_append - Record a change. The statement is executed
+ * like any other so that it is part of the commit's database transaction.
+ *
+ * @param sql_be SQL backend
+ * @param session The id of the session making the change
+ * @param type The object's type
+ * @param guid The object's guid
+ * @param op The operation
+ * @return TRUE if successful, FALSE if error
+ */
+gboolean gnc_sql_change_log_append (GncSqlBackend* sql_be,
+                                    const std::string& session,
+                                    QofIdTypeConst type, const GncGUID* guid,
+                                    E_DB_OPERATION op);
+
+/**
+ * gnc_sql_change_log_last_id - The id of the latest change.
+ *
+ * @param sql_be SQL backend
+ * @return The id, 0 if the log is empty
+ */
+int64_t gnc_sql_change_log_last_id (GncSqlBackend* sql_be);
+
+/**
+ * gnc_sql_change_log_read - Read the changes logged after a given one, in
+ * order.
+ *
+ * @param sql_be SQL backend
+ * @param after The id of the last change already seen
+ * @return The changes
+ */
+GncSqlChangeVec gnc_sql_change_log_read (GncSqlBackend* sql_be,
+                                         int64_t after);
+
+/**
+ * gnc_sql_change_log_prune - Delete all but the latest changes.
+ *
+ * @param sql_be SQL backend
+ * @param keep The number of changes to keep
+ */
+void gnc_sql_change_log_prune (GncSqlBackend* sql_be, int64_t keep);
+
+#endif /* GNC_CHANGE_LOG_SQL_H */
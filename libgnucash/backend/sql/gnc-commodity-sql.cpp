@@ -168,6 +168,15 @@ GncSqlCommodityBackend::load_all (GncSqlBackend* sql_be)
     gnc_sql_slots_load_for_sql_subquery (sql_be, sql,
 					 (BookLookupFn)gnc_commodity_find_commodity_by_guid);
 }
+
+std::vector<std::string>
+GncSqlCommodityBackend::load_statements () const
+{
+    std::string pkey(col_table[0]->name());
+    return {"SELECT * FROM " COMMODITIES_TABLE,
+            gnc_sql_slots_sql_for_subquery ("SELECT DISTINCT " + pkey +
+                                            " FROM " COMMODITIES_TABLE)};
+}
 /* ================================================================= */
 static gboolean
 do_commit_commodity (GncSqlBackend* sql_be, QofInstance* inst,
@@ -142,6 +142,14 @@ GncSqlLotsBackend::load_all (GncSqlBackend* sql_be)
     }
 }
 
+std::vector<std::string>
+GncSqlLotsBackend::load_statements () const
+{
+    return {"SELECT * FROM " TABLE_NAME,
+            gnc_sql_slots_sql_for_subquery ("SELECT DISTINCT guid FROM "
+                                            TABLE_NAME)};
+}
+
 /* ================================================================= */
 void
 GncSqlLotsBackend::create_tables (GncSqlBackend* sql_be)
@@ -132,6 +132,15 @@ GncSqlPriceBackend::load_all (GncSqlBackend* sql_be)
     }
 }
 
+std::vector<std::string>
+GncSqlPriceBackend::load_statements () const
+{
+    std::string pkey(col_table[0]->name());
+    return {"SELECT * FROM " TABLE_NAME,
+            gnc_sql_slots_sql_for_subquery ("SELECT DISTINCT " + pkey +
+                                            " FROM " TABLE_NAME)};
+}
+
 /* ================================================================= */
 void
 GncSqlPriceBackend::create_tables (GncSqlBackend* sql_be)
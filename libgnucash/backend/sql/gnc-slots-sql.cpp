@@ -42,6 +42,9 @@ extern "C"
 
 #include <string>
 #include <sstream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "gnc-sql-connection.hpp"
 #include "gnc-sql-backend.hpp"
@@ -63,6 +66,8 @@ typedef enum
     LIST
 } context_t;
 
+struct slot_load_batch_t;
+
 struct slot_info_t
 {
     GncSqlBackend* be;
@@ -75,6 +80,19 @@ struct slot_info_t
     KvpValue* pKvpValue;
     std::string path;
     std::string parent_path;
+    slot_load_batch_t* batch = nullptr;
+};
+
+/* Nested frames and lists are stored in the slots table under their own
+ * obj_guid. Instead of querying for each of them as it's encountered, the
+ * loaders collect them here and fetch a whole nesting level at a time. */
+struct slot_load_batch_t
+{
+    /* Keyed by the stringified guid of the nested frame or list. */
+    std::unordered_map<std::string, slot_info_t*> pending;
+    /* Lists can only be stored in their parent frame once all of their
+     * items have been loaded. */
+    std::vector<std::pair<slot_info_t*, std::string>> lists;
 };
 
 
@@ -99,10 +117,11 @@ static void set_numeric_val (gpointer pObject, gnc_numeric value);
 static GDate* get_gdate_val (gpointer pObject);
 static void set_gdate_val (gpointer pObject, GDate* value);
 static slot_info_t* slot_info_copy (slot_info_t* pInfo, GncGUID* guid);
-static void slots_load_info (slot_info_t* pInfo);
+static bool slots_defer_load (slot_info_t* pInfo, const GncGUID* guid);
 
 #define SLOT_MAX_PATHNAME_LEN 4096
 #define SLOT_MAX_STRINGVAL_LEN 4096
+#define SLOT_MAX_GUIDS_PER_QUERY 1000
 enum
 {
     id_col = 0,
@@ -450,21 +469,20 @@ set_guid_val (gpointer pObject,  gpointer pValue)
     }
     case KvpValue::Type::GLIST:
     {
-        slot_info_t* newInfo = slot_info_copy (pInfo, (GncGUID*)pValue);
-        KvpValue* pValue = NULL;
-        auto key = get_key (pInfo);
+        slot_info_t* newInfo = slot_info_copy (pInfo, NULL);
 
         newInfo->context = LIST;
+        newInfo->pList = NULL;
 
-        slots_load_info (newInfo);
-        pValue = new KvpValue {newInfo->pList};
-        pInfo->pKvpFrame->set ({key.c_str()}, pValue);
-	delete newInfo;
+        if (slots_defer_load (newInfo, (GncGUID*)pValue))
+            pInfo->batch->lists.emplace_back (newInfo, get_key (pInfo));
+        else
+            delete newInfo;
         break;
     }
     case KvpValue::Type::FRAME:
     {
-        slot_info_t* newInfo = slot_info_copy (pInfo, (GncGUID*)pValue) ;
+        slot_info_t* newInfo = slot_info_copy (pInfo, NULL);
         auto newFrame = new KvpFrame;
         newInfo->pKvpFrame = newFrame;
 
@@ -487,8 +505,8 @@ set_guid_val (gpointer pObject,  gpointer pValue)
         }
 
         newInfo->context = FRAME;
-        slots_load_info (newInfo);
-        delete newInfo;
+        if (!slots_defer_load (newInfo, (GncGUID*)pValue))
+            delete newInfo;
         break;
     }
     default:
@@ -570,6 +588,7 @@ slot_info_copy (slot_info_t* pInfo, GncGUID* guid)
     newSlot->pList = pInfo->pList;
     newSlot->context = pInfo->context;
     newSlot->pKvpValue = pInfo->pKvpValue;
+    newSlot->batch = pInfo->batch;
     if (!pInfo->path.empty())
         newSlot->parent_path = pInfo->path + "/";
     else
@@ -746,11 +765,83 @@ load_slot (slot_info_t* pInfo, GncSqlRow& row)
     delete slot_info;
 }
 
+static bool
+slots_defer_load (slot_info_t* pInfo, const GncGUID* guid)
+{
+    g_return_val_if_fail (pInfo != NULL, false);
+    g_return_val_if_fail (pInfo->batch != NULL, false);
+
+    auto key = gnc::GUID (*guid).to_string ();
+    if (!pInfo->batch->pending.emplace (key, pInfo).second)
+    {
+        PWARN ("Slot %s is referenced more than once", key.c_str ());
+        return false;
+    }
+    return true;
+}
+
+/* Loads the frames and lists collected in batch, including the ones nested
+ * in them, with one query per nesting level and SLOT_MAX_GUIDS_PER_QUERY
+ * frames.
+ */
+static void
+slots_load_pending (GncSqlBackend* sql_be, slot_load_batch_t& batch)
+{
+    g_return_if_fail (sql_be != NULL);
+
+    while (!batch.pending.empty ())
+    {
+        auto level = std::move (batch.pending);
+        auto lists = std::move (batch.lists);
+        batch.pending.clear ();
+        batch.lists.clear ();
+
+        auto iter = level.begin ();
+        while (iter != level.end ())
+        {
+            std::string sql ("SELECT * FROM " TABLE_NAME " WHERE obj_guid IN (");
+            for (auto count = 0; count < SLOT_MAX_GUIDS_PER_QUERY &&
+                     iter != level.end (); ++count, ++iter)
+            {
+                if (count)
+                    sql += ",";
+                sql += "'" + iter->first + "'";
+            }
+            sql += ") ORDER BY obj_guid, id";
+
+            auto stmt = sql_be->create_statement_from_sql (sql);
+            if (stmt == nullptr)
+            {
+                PERR ("stmt == NULL, SQL = '%s'\n", sql.c_str ());
+                continue;
+            }
+            auto result = sql_be->execute_select_statement (stmt);
+            for (auto row : *result)
+            {
+                auto entry = level.find (row.get_string_at_col ("obj_guid"));
+                if (entry != level.end ())
+                    load_slot (entry->second, row);
+            }
+            delete result;
+        }
+
+        for (auto& list : lists)
+        {
+            auto info = list.first;
+            info->pKvpFrame->set ({list.second.c_str()},
+                                  new KvpValue {info->pList});
+        }
+        for (auto& entry : level)
+            delete entry.second;
+    }
+}
+
 void
 gnc_sql_slots_load (GncSqlBackend* sql_be, QofInstance* inst)
 {
     slot_info_t info = { NULL, NULL, TRUE, NULL, KvpValue::Type::INVALID,
                          NULL, FRAME, NULL, "" };
+    slot_load_batch_t batch;
     g_return_if_fail (sql_be != NULL);
     g_return_if_fail (inst != NULL);
 
@@ -758,29 +849,20 @@ gnc_sql_slots_load (GncSqlBackend* sql_be, QofInstance* inst)
     info.guid = qof_instance_get_guid (inst);
     info.pKvpFrame = qof_instance_get_slots (inst);
     info.context = NONE;
+    info.batch = &batch;
 
-    slots_load_info (&info);
-}
-
-static void
-slots_load_info (slot_info_t* pInfo)
-{
-    g_return_if_fail (pInfo != NULL);
-    g_return_if_fail (pInfo->be != NULL);
-    g_return_if_fail (pInfo->guid != NULL);
-    g_return_if_fail (pInfo->pKvpFrame != NULL);
-
-    gnc::GUID guid(*pInfo->guid);
+    gnc::GUID guid(*info.guid);
     std::string sql("SELECT * FROM " TABLE_NAME " WHERE obj_guid='");
-    sql += guid.to_string() + "'";
-    auto stmt = pInfo->be->create_statement_from_sql(sql);
+    sql += guid.to_string() + "' ORDER BY id";
+    auto stmt = sql_be->create_statement_from_sql(sql);
     if (stmt != nullptr)
     {
-        auto result = pInfo->be->execute_select_statement (stmt);
+        auto result = sql_be->execute_select_statement (stmt);
         for (auto row : *result)
-            load_slot (pInfo, row);
+            load_slot (&info, row);
         delete result;
     }
+    slots_load_pending (sql_be, batch);
 }
 
 static  const GncGUID*
@@ -795,34 +877,9 @@ load_obj_guid (const GncSqlBackend* sql_be, GncSqlRow& row)
     return &guid;
 }
 
-static void
-load_slot_for_list_item (GncSqlBackend* sql_be, GncSqlRow& row,
-                         QofCollection* coll)
-{
-    slot_info_t slot_info = { NULL, NULL, TRUE, NULL, KvpValue::Type::INVALID,
-                              NULL, FRAME, NULL, "" };
-    const GncGUID* guid;
-    QofInstance* inst;
-
-    g_return_if_fail (sql_be != NULL);
-    g_return_if_fail (coll != NULL);
-
-    guid = load_obj_guid (sql_be, row);
-    g_assert (guid != NULL);
-    inst = qof_collection_lookup_entity (coll, guid);
-
-    slot_info.be = sql_be;
-    slot_info.pKvpFrame = qof_instance_get_slots (inst);
-    slot_info.context = NONE;
-
-    gnc_sql_load_object (sql_be, row, TABLE_NAME, &slot_info, col_table);
-
-
-}
-
 static void
 load_slot_for_book_object (GncSqlBackend* sql_be, GncSqlRow& row,
-                           BookLookupFn lookup_fn)
+                           BookLookupFn lookup_fn, slot_load_batch_t& batch)
 {
     slot_info_t slot_info = { NULL, NULL, TRUE, NULL, KvpValue::Type::INVALID,
                               NULL, FRAME, NULL, "" };
@@ -840,6 +897,7 @@ load_slot_for_book_object (GncSqlBackend* sql_be, GncSqlRow& row,
     slot_info.be = sql_be;
     slot_info.pKvpFrame = qof_instance_get_slots (inst);
     slot_info.path.clear();
+    slot_info.batch = &batch;
 
     gnc_sql_load_object (sql_be, row, TABLE_NAME, &slot_info, col_table);
 }
@@ -862,9 +920,7 @@ void gnc_sql_slots_load_for_sql_subquery (GncSqlBackend* sql_be,
     // Ignore empty subquery
     if (subquery.empty()) return;
 
-    std::string pkey(obj_guid_col_table[0]->name());
-    std::string sql("SELECT * FROM " TABLE_NAME " WHERE ");
-    sql += pkey + " IN (" + subquery + ")";
+    auto sql = gnc_sql_slots_sql_for_subquery (subquery);
 
     // Execute the query and load the slots
     auto stmt = sql_be->create_statement_from_sql(sql);
@@ -873,10 +929,21 @@ void gnc_sql_slots_load_for_sql_subquery (GncSqlBackend* sql_be,
         PERR ("stmt == NULL, SQL = '%s'\n", sql.c_str());
         return;
     }
+    slot_load_batch_t batch;
     auto result = sql_be->execute_select_statement(stmt);
     for (auto row : *result)
-        load_slot_for_book_object (sql_be, row, lookup_fn);
+        load_slot_for_book_object (sql_be, row, lookup_fn, batch);
     delete result;
+    slots_load_pending (sql_be, batch);
+}
+
+std::string
+gnc_sql_slots_sql_for_subquery (const std::string& subquery)
+{
+    std::string pkey(obj_guid_col_table[0]->name());
+    std::string sql("SELECT * FROM " TABLE_NAME " WHERE ");
+    sql += pkey + " IN (" + subquery + ") ORDER BY " + pkey + ", id";
+    return sql;
 }
 
 /* ================================================================= */
@@ -92,6 +92,15 @@ void gnc_sql_slots_load_for_sql_subquery (GncSqlBackend* sql_be,
                                           const std::string subquery,
                                           BookLookupFn lookup_fn);
 
+/**
+ * gnc_sql_slots_sql_for_subquery - The SELECT statement that
+ * gnc_sql_slots_load_for_sql_subquery executes for a subquery.
+ *
+ * @param subquery Subquery SQL string
+ * @return The SQL statement
+ */
+std::string gnc_sql_slots_sql_for_subquery (const std::string& subquery);
+
 void gnc_sql_init_slots_handler (void);
 
 #endif /* GNC_SLOTS_SQL_H */
@@ -20,6 +20,7 @@
  * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
  * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
 \********************************************************************/
+#include <guid.hpp>
 extern "C"
 {
 #include <config.h>
@@ -31,6 +32,8 @@ extern "C"
 #include <gncBillTerm.h>
 #include <gncTaxTable.h>
 #include <gncInvoice.h>
+#include <Transaction.h>
+#include <Split.h>
 #include <gnc-pricedb.h>
 }
 
@@ -42,10 +45,13 @@ extern "C"
 #include "gnc-sql-object-backend.hpp"
 #include "gnc-sql-column-table-entry.hpp"
 #include "gnc-sql-result.hpp"
+#include "gnc-sql-write-queue.hpp"
+#include "gnc-sql-read-ahead.hpp"
 
 #include "gnc-account-sql.h"
 #include "gnc-book-sql.h"
 #include "gnc-budget-sql.h"
+#include "gnc-change-log-sql.h"
 #include "gnc-commodity-sql.h"
 #include "gnc-lots-sql.h"
 #include "gnc-price-sql.h"
@@ -88,15 +94,67 @@ GncSqlBackend::GncSqlBackend(GncSqlConnection *conn, QofBook* book) :
         connect (conn);
 }
 
+GncSqlBackend::~GncSqlBackend()
+{
+    m_read_ahead.reset();
+    m_write_queue.reset();
+}
+
 void
 GncSqlBackend::connect(GncSqlConnection *conn) noexcept
 {
+    /* The read-ahead and the queued writes belong to the old connection. */
+    m_read_ahead.reset();
+    if (m_write_queue)
+    {
+        flush_writes();
+        m_write_queue.reset();
+    }
     if (m_conn != nullptr && m_conn != conn)
         delete m_conn;
     finalize_version_info();
     m_conn = conn;
 }
 
+void
+GncSqlBackend::set_write_behind(const std::string& journal_path,
+                                bool enable) noexcept
+{
+    g_return_if_fail (m_conn != nullptr);
+
+    if (m_write_queue)
+    {
+        flush_writes();
+        m_write_queue.reset();
+    }
+    GncSqlWriteQueue::replay_journal (m_conn, journal_path);
+    if (enable)
+        m_write_queue.reset(new GncSqlWriteQueue{m_conn, journal_path});
+}
+
+void
+GncSqlBackend::flush_writes() const noexcept
+{
+    if (!m_write_queue)
+        return;
+    InstanceRefVec failed;
+    auto error = m_write_queue->flush (&failed);
+    if (error == ERR_BACKEND_NO_ERR)
+        return;
+    qof_backend_set_error ((QofBackend*)this, error);
+    /* The instances were marked clean when their writes were queued; they
+     * haven't been saved after all. */
+    for (auto const& ref : failed)
+    {
+        auto coll = qof_book_get_collection (m_book, ref.first);
+        auto inst = qof_collection_lookup_entity (coll, &ref.second);
+        if (inst != nullptr)
+            qof_instance_set_dirty_flag (inst, TRUE);
+    }
+    if (!failed.empty())
+        qof_book_mark_session_dirty (m_book);
+}
+
 GncSqlStatementPtr
 GncSqlBackend::create_statement_from_sql(const std::string& str) const noexcept
 {
@@ -112,6 +170,14 @@ GncSqlBackend::create_statement_from_sql(const std::string& str) const noexcept
 GncSqlResultPtr
 GncSqlBackend::execute_select_statement(const GncSqlStatementPtr& stmt) const noexcept
 {
+    /* Reads must see the queued writes. */
+    flush_writes();
+    if (m_read_ahead)
+    {
+        auto result = m_read_ahead->take(stmt->to_sql());
+        if (result != nullptr)
+            return result;
+    }
     auto result = m_conn ? m_conn->execute_select_statement(stmt) : nullptr;
     if (result == nullptr)
     {
@@ -124,6 +190,12 @@ GncSqlBackend::execute_select_statement(const GncSqlStatementPtr& stmt) const no
 int
 GncSqlBackend::execute_nonselect_statement(const GncSqlStatementPtr& stmt) const noexcept
 {
+    if (m_captured_statements)
+    {
+        m_captured_statements->emplace_back(stmt->to_sql());
+        return 1;
+    }
+    flush_writes();
     int result = m_conn ? m_conn->execute_nonselect_statement(stmt) : -1;
     if (result == -1)
     {
@@ -139,6 +211,11 @@ GncSqlBackend::quote_string(const std::string& str) const noexcept
     g_return_val_if_fail (m_conn != nullptr, empty_string);
     if (!m_conn)
         return empty_string;
+    if (m_write_queue)
+    {
+        std::lock_guard<std::mutex> lock{m_write_queue->connection_mutex()};
+        return m_conn->quote_string(str);
+    }
     return m_conn->quote_string(str);
 }
 
@@ -223,6 +300,186 @@ static const StrVec fixed_load_order
 static const StrVec business_fixed_load_order =
 { GNC_ID_BILLTERM, GNC_ID_TAXTABLE, GNC_ID_INVOICE };
 
+/* The number of changes kept in the change log; a session that falls
+ * further behind misses changes. */
+static const int64_t change_log_size = 100000;
+/* How often a change that is missing from the change log is waited for
+ * before concluding that its database transaction was rolled back. */
+static const unsigned int change_log_gap_polls = 3;
+
+void
+GncSqlBackend::start_change_log() noexcept
+{
+    if (!gnc_sql_change_log_exists (this))
+    {
+        PWARN ("The change log table couldn't be created, turning it off.");
+        m_change_log = false;
+        return;
+    }
+    m_session_id = gnc::GUID::create_random().to_string();
+    gnc_sql_change_log_prune (this, change_log_size);
+    /* Changes made while loading are reloaded, which is harmless. */
+    m_change_seq = gnc_sql_change_log_last_id (this);
+    m_changes_seen.clear();
+    m_change_gap_polls = 0;
+    m_pending_changes.clear();
+}
+
+bool
+GncSqlBackend::log_change(QofInstance* inst) noexcept
+{
+    if (!m_change_log || m_session_id.empty())
+        return true;
+    auto op = qof_instance_get_destroying (inst) ? OP_DB_DELETE :
+        qof_instance_get_infant (inst) ? OP_DB_INSERT : OP_DB_UPDATE;
+    /* Splits are reloaded with their transactions. */
+    if (GNC_IS_SPLIT (inst))
+    {
+        auto trans = xaccSplitGetParent (GNC_SPLIT (inst));
+        if (trans == nullptr)
+            return true;
+        inst = QOF_INSTANCE (trans);
+        op = OP_DB_UPDATE;
+    }
+    return gnc_sql_change_log_append (this, m_session_id, inst->e_type,
+                                      qof_instance_get_guid (inst), op);
+}
+
+bool
+GncSqlBackend::events_pending()
+{
+    if (!m_change_log || m_conn == nullptr || m_book == nullptr ||
+        m_loading || m_session_id.empty())
+        return false;
+
+    for (auto& change : gnc_sql_change_log_read (this, m_change_seq))
+    {
+        if (!m_changes_seen.insert(change.id).second)
+            continue;
+        if (change.session != m_session_id)
+            m_pending_changes.push_back (std::move(change));
+    }
+    while (m_changes_seen.erase (m_change_seq + 1))
+        ++m_change_seq;
+    if (m_changes_seen.empty())
+        m_change_gap_polls = 0;
+    else if (++m_change_gap_polls > change_log_gap_polls)
+    {
+        PINFO ("Skipping changes %" G_GINT64_FORMAT " to %" G_GINT64_FORMAT,
+               m_change_seq + 1, *m_changes_seen.begin() - 1);
+        m_change_seq = *m_changes_seen.begin() - 1;
+        while (m_changes_seen.erase (m_change_seq + 1))
+            ++m_change_seq;
+        m_change_gap_polls = 0;
+    }
+    return !m_pending_changes.empty();
+}
+
+bool
+GncSqlBackend::process_events()
+{
+    if (m_pending_changes.empty())
+        return false;
+
+    ENTER ("%zu changes", m_pending_changes.size());
+    /* Collect the changed objects by type, each once. */
+    std::vector<std::pair<std::string, std::vector<GncGUID>>> changed;
+    for (auto const& change : m_pending_changes)
+    {
+        auto entry = std::find_if (changed.begin(), changed.end(),
+                                   [&change](auto const& e)
+                                   { return e.first == change.obj_type; });
+        if (entry == changed.end())
+        {
+            changed.emplace_back (change.obj_type, std::vector<GncGUID>{});
+            entry = changed.end() - 1;
+        }
+        auto& guids = entry->second;
+        if (std::find_if (guids.begin(), guids.end(),
+                          [&change](const GncGUID& guid)
+                          { return guid_equal (&guid, &change.guid); })
+            == guids.end())
+            guids.push_back (change.guid);
+    }
+    m_pending_changes.clear();
+
+    /* Objects that others depend on go first, as when loading. */
+    auto rank = [](const std::string& type)
+    {
+        auto pos = std::find (fixed_load_order.begin(), fixed_load_order.end(),
+                              type);
+        return pos - fixed_load_order.begin();
+    };
+    std::stable_sort (changed.begin(), changed.end(),
+                      [&rank](auto const& a, auto const& b)
+                      { return rank(a.first) < rank(b.first); });
+
+    auto changed_book = false;
+    m_loading = true;
+    for (auto const& entry : changed)
+    {
+        auto obe = m_backend_registry.get_object_backend(entry.first);
+        if (obe != nullptr && obe->load_changed (this, entry.second))
+            changed_book = true;
+        else
+            PWARN ("%zu changed objects of type %s will only be seen when the "
+                   "book is reopened.", entry.second.size(),
+                   entry.first.c_str());
+    }
+    m_loading = false;
+    LEAVE ("");
+    return changed_book;
+}
+
+/* Maximum number of extra connections used to read ahead while loading. */
+static const size_t max_read_ahead_connections = 4;
+
+void
+GncSqlBackend::start_read_ahead() noexcept
+{
+    /* Queue the statements in the order load() needs them. */
+    std::vector<std::string> statements;
+    auto add_statements = [&statements](GncSqlObjectBackendPtr obe)
+    {
+        if (obe == nullptr)
+            return;
+        for (auto& sql : obe->load_statements())
+            statements.push_back (std::move(sql));
+    };
+    for (auto type : fixed_load_order)
+        add_statements (m_backend_registry.get_object_backend(type));
+    for (auto type : business_fixed_load_order)
+        add_statements (m_backend_registry.get_object_backend(type));
+    for (auto entry : m_backend_registry)
+    {
+        auto type = std::get<0>(entry);
+        if (std::find(fixed_load_order.begin(), fixed_load_order.end(),
+                      type) == fixed_load_order.end() &&
+            std::find(business_fixed_load_order.begin(),
+                      business_fixed_load_order.end(),
+                      type) == business_fixed_load_order.end())
+            add_statements (std::get<1>(entry));
+    }
+    if (statements.empty() || m_conn == nullptr)
+        return;
+
+    std::vector<GncSqlConnection*> readers;
+    auto num_readers = std::min(max_read_ahead_connections, statements.size());
+    while (readers.size() < num_readers)
+    {
+        auto reader = m_conn->open_reader();
+        if (reader == nullptr)
+            break;
+        readers.push_back(reader);
+    }
+    if (readers.empty())
+        return;
+    DEBUG ("Reading %zu statements ahead on %zu connections", statements.size(),
+           readers.size());
+    m_read_ahead.reset(new GncSqlReadAhead{std::move(readers),
+                                           std::move(statements)});
+}
+
 void
 GncSqlBackend::ObjectBackendRegistry::load_remaining(GncSqlBackend* sql_be)
 {
@@ -279,6 +536,7 @@ GncSqlBackend::load (QofBook* book, QofBackendLoadType loadType)
 
     ENTER ("sql_be=%p, book=%p", this, book);
 
+    flush_writes();
     m_loading = TRUE;
 
     if (loadType == LOAD_TYPE_INITIAL_LOAD)
@@ -289,6 +547,10 @@ GncSqlBackend::load (QofBook* book, QofBackendLoadType loadType)
         auto num_types = m_backend_registry.size();
         auto num_done = 0;
 
+        if (m_change_log)
+            start_change_log();
+        start_read_ahead();
+
         /* Load any initial stuff. Some of this needs to happen in a certain order */
         for (auto type : fixed_load_order)
         {
@@ -319,6 +581,7 @@ GncSqlBackend::load (QofBook* book, QofBackendLoadType loadType)
 
         gnc_account_foreach_descendant(root, (AccountCb)xaccAccountCommitEdit,
                                        nullptr);
+        m_read_ahead.reset();
     }
     else if (loadType == LOAD_TYPE_LOAD_ALL)
     {
@@ -455,12 +718,26 @@ GncSqlBackend::write_schedXactions()
 
 #pragma GCC diagnostic warning "-Wformat-nonliteral"
 
+/* Transactions written by bulk_write() between commits. */
+static const unsigned int bulk_write_chunk = 5000;
+
 void
 GncSqlBackend::sync(QofBook* book)
 {
     g_return_if_fail (book != NULL);
     g_return_if_fail (m_conn != nullptr);
 
+    if (begin_bulk_write (book))
+        end_bulk_write (true);
+}
+
+bool
+GncSqlBackend::begin_bulk_write(QofBook* book)
+{
+    g_return_val_if_fail (book != NULL, false);
+    g_return_val_if_fail (m_conn != nullptr, false);
+
+    flush_writes();
     reset_version_info();
     ENTER ("book=%p, sql_be->book=%p", book, m_book);
     update_progress(101.0);
@@ -471,14 +748,56 @@ GncSqlBackend::sync(QofBook* book)
 
     /* Save all contents */
     m_book = book;
-    auto is_ok = m_conn->begin_transaction();
+    m_bulk_written = 0;
+    if (!m_conn->begin_transaction())
+    {
+        set_error (ERR_BACKEND_SERVER_ERR);
+        finish_progress();
+        LEAVE ("Failed to start a transaction");
+        return false;
+    }
+    LEAVE ("");
+    return true;
+}
+
+bool
+GncSqlBackend::bulk_write(QofInstance* inst)
+{
+    g_return_val_if_fail (inst != nullptr, false);
+
+    if (!GNC_IS_TRANSACTION (inst) || check_error())
+        return false;
+    auto tx = GNC_TRANSACTION (inst);
+    for (auto node = xaccTransGetSplitList (tx); node; node = g_list_next (node))
+        if (xaccSplitGetLot (GNC_SPLIT (node->data)) != nullptr)
+            return false;
+
+    auto obe = m_backend_registry.get_object_backend(GNC_ID_TRANS);
+    write_objects_t data{this, true, obe.get()};
+    write_tx (tx, &data);
+    if (!data.is_ok)
+    {
+        set_error (ERR_BACKEND_SERVER_ERR);
+        return false;
+    }
+    if (++m_bulk_written % bulk_write_chunk == 0 &&
+        !(m_conn->commit_transaction() && m_conn->begin_transaction()))
+        set_error (ERR_BACKEND_SERVER_ERR);
+    return true;
+}
+
+void
+GncSqlBackend::end_bulk_write(bool complete)
+{
+    ENTER ("book=%p", m_book);
+    auto is_ok = complete && !check_error();
 
     // FIXME: should write the set of commodities that are used
     // write_commodities(sql_be, book);
     if (is_ok)
     {
         auto obe = m_backend_registry.get_object_backend(GNC_ID_BOOK);
-        is_ok = obe->commit (this, QOF_INSTANCE (book));
+        is_ok = obe->commit (this, QOF_INSTANCE (m_book));
     }
     if (is_ok)
     {
@@ -508,19 +827,22 @@ GncSqlBackend::sync(QofBook* book)
     if (is_ok)
     {
         m_is_pristine_db = false;
+        if (m_change_log)
+            start_change_log();
 
         /* Mark the session as clean -- though it shouldn't ever get
          * marked dirty with this backend
          */
-        qof_book_mark_session_saved(book);
+        qof_book_mark_session_saved(m_book);
     }
     else
     {
-        set_error (ERR_BACKEND_SERVER_ERR);
+        if (complete)
+            set_error (ERR_BACKEND_SERVER_ERR);
         m_conn->rollback_transaction ();
     }
     finish_progress();
-    LEAVE ("book=%p", book);
+    LEAVE ("book=%p", m_book);
 }
 
 /* ================================================================= */
@@ -544,6 +866,20 @@ GncSqlBackend::rollback(QofInstance* inst)
     //LEAVE ("");
 }
 
+bool
+GncSqlBackend::select_candidates(QofQuery* query, QofBook* book,
+                                 GList** candidates)
+{
+    g_return_val_if_fail (query != nullptr, false);
+    g_return_val_if_fail (candidates != nullptr, false);
+
+    if (m_conn == nullptr || book != m_book || m_loading)
+        return false;
+    if (g_strcmp0 (qof_query_get_search_for (query), GNC_ID_SPLIT) != 0)
+        return false;
+    return gnc_sql_split_query_candidates (this, query, candidates);
+}
+
 void
 GncSqlBackend::commodity_for_postload_processing(gnc_commodity* commodity)
 {
@@ -571,19 +907,21 @@ GncSqlBackend::commit (QofInstance* inst)
     g_return_if_fail (inst != NULL);
     g_return_if_fail (m_conn != nullptr);
 
-    if (qof_book_is_readonly(m_book))
-    {
-        set_error (ERR_BACKEND_READONLY);
-        (void)m_conn->rollback_transaction ();
-        return;
-    }
     /* During initial load where objects are being created, don't commit
-    anything, but do mark the object as clean. */
+    anything, but do mark the object as clean. The same goes for reloading
+    the changes of other sessions. */
     if (m_loading)
     {
         qof_instance_mark_clean (inst);
         return;
     }
+    if (qof_book_is_readonly(m_book))
+    {
+        set_error (ERR_BACKEND_READONLY);
+        if (!m_write_queue)
+            (void)m_conn->rollback_transaction ();
+        return;
+    }
 
     // The engine has a PriceDB object but it isn't in the database
     if (strcmp (inst->e_type, "PriceDB") == 0)
@@ -609,6 +947,13 @@ GncSqlBackend::commit (QofInstance* inst)
         return;
     }
 
+    if (m_write_queue)
+    {
+        commit_write_behind (inst, is_infant || is_destroying);
+        LEAVE ("");
+        return;
+    }
+
     if (!m_conn->begin_transaction ())
     {
         PERR ("begin_transaction failed\n");
@@ -620,7 +965,7 @@ GncSqlBackend::commit (QofInstance* inst)
 
     auto obe = m_backend_registry.get_object_backend(std::string{inst->e_type});
     if (obe != nullptr)
-        is_ok = obe->commit(this, inst);
+        is_ok = obe->commit(this, inst) && log_change(inst);
     else
     {
         PERR ("Unknown object type '%s'\n", inst->e_type);
@@ -651,6 +996,40 @@ GncSqlBackend::commit (QofInstance* inst)
 }
 
 
+/* Generate the statements committing inst without executing them and queue
+ * them for the writer thread. The instance is considered saved once its
+ * statements are journaled; flush_writes() marks it dirty again if they
+ * fail. */
+void
+GncSqlBackend::commit_write_behind (QofInstance* inst, bool is_new_or_deleted)
+{
+    auto obe = m_backend_registry.get_object_backend(std::string{inst->e_type});
+    if (obe == nullptr)
+    {
+        PERR ("Unknown object type '%s'\n", inst->e_type);
+        qof_book_mark_session_saved(m_book);
+        qof_instance_mark_clean (inst);
+        return;
+    }
+
+    std::vector<std::string> statements;
+    m_captured_statements = &statements;
+    auto is_ok = obe->commit(this, inst) && log_change(inst);
+    m_captured_statements = nullptr;
+    if (!is_ok)
+    {
+        // Nothing has been executed; leave the instance dirty.
+        PERR ("Failed to prepare the commit of a '%s'\n", inst->e_type);
+        return;
+    }
+
+    m_write_queue->enqueue ({inst->e_type, *qof_instance_get_guid (inst)},
+                            !(is_new_or_deleted || m_is_pristine_db),
+                            std::move(statements));
+    qof_book_mark_session_saved(m_book);
+    qof_instance_mark_clean (inst);
+}
+
 /**
  * Sees if the version table exists, and if it does, loads the info into
  * the version hash table.  Otherwise, it creates an empty version table.
@@ -994,6 +1373,7 @@ GncSqlBackend::ObjectBackendRegistry::ObjectBackendRegistry()
     register_backend(std::make_shared<GncSqlOrderBackend>());
     register_backend(std::make_shared<GncSqlTaxTableBackend>());
     register_backend(std::make_shared<GncSqlVendorBackend>());
+    register_backend(std::make_shared<GncSqlChangeLogBackend>());
 }
 
 void
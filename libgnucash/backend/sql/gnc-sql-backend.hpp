@@ -31,7 +31,9 @@ extern "C"
 }
 #include <memory>
 #include <exception>
+#include <set>
 #include <sstream>
+#include <string>
 #include <vector>
 #include <qof-backend.hpp>
 
@@ -43,6 +45,9 @@ using GncSqlObjectBackendPtr = std::shared_ptr<GncSqlObjectBackend>;
 using OBEEntry = std::tuple<std::string, GncSqlObjectBackendPtr>;
 using OBEVec = std::vector<OBEEntry>;
 class GncSqlConnection;
+class GncSqlWriteQueue;
+class GncSqlReadAhead;
+struct GncSqlChange;
 class GncSqlStatement;
 using GncSqlStatementPtr = std::unique_ptr<GncSqlStatement>;
 class GncSqlResult;
@@ -66,7 +71,7 @@ class GncSqlBackend : public QofBackend
 {
 public:
     GncSqlBackend(GncSqlConnection *conn, QofBook* book);
-    virtual ~GncSqlBackend() = default;
+    virtual ~GncSqlBackend();
     /**
      * Load the contents of an SQL database into a book.
      *
@@ -79,6 +84,30 @@ public:
      * @param book Book to be saved
      */
     void sync(QofBook*) override;
+    /**
+     * Start saving a book into an empty database a piece at a time: create
+     * the tables and open a database transaction.
+     *
+     * @param book Book to be saved
+     * @return false, with ERR_BACKEND_SERVER_ERR set, if it couldn't start.
+     */
+    bool begin_bulk_write(QofBook*) override;
+    /**
+     * Save a transaction of the book being bulk-written and its splits.
+     * Transactions with splits in lots are left for end_bulk_write() because
+     * lots and business objects refer to them. The database transaction is
+     * committed every few thousand transactions so that the database's
+     * journal doesn't have to hold the whole book.
+     *
+     * @param inst The instance to save.
+     * @return true if it was saved.
+     */
+    bool bulk_write(QofInstance*) override;
+    /**
+     * Save everything else in the book and commit, or roll back the last
+     * part if @a complete is false.
+     */
+    void end_bulk_write(bool complete) override;
     /**
      * An object is about to be edited.
      *
@@ -97,11 +126,62 @@ public:
      * @param inst Object being edited
      */
     void rollback(QofInstance*) override;
+    /**
+     * Select the splits that can match a query in the database.
+     *
+     * Only split queries are handled; see
+     * gnc_sql_split_query_candidates().
+     */
+    bool select_candidates(QofQuery*, QofBook*, GList**) override;
     /** Connect the backend to a GncSqlConnection.
      * Sets up version info. Calling with nullptr clears the connection and
      * destroys the version info.
      */
     void connect(GncSqlConnection *conn) noexcept;
+    /**
+     * Replay the writes left in a write-behind journal by a session that
+     * didn't end cleanly and optionally turn write-behind mode on.
+     *
+     * In write-behind mode commit() only generates the SQL for the
+     * instance and hands it to a writer thread, so that the caller doesn't
+     * wait for the database. The statements are journaled in journal_path
+     * until they have been committed. Anything else that needs the
+     * database waits for the queued writes first.
+     *
+     * Must be called after connect().
+     * @param journal_path Local file for the journal.
+     * @param enable Whether to queue commits; if false only the replay is
+     * done.
+     */
+    void set_write_behind(const std::string& journal_path, bool enable) noexcept;
+    /**
+     * Wait for the writes queued in write-behind mode to reach the database.
+     * If any of them failed, sets the first error and marks the instances
+     * whose writes failed dirty again.
+     */
+    void flush_writes() const noexcept;
+    /**
+     * Turn the change log on or off.
+     *
+     * With the change log on every commit is also recorded in a table, and
+     * events_pending() polls that table for the changes of other sessions
+     * so that process_events() can reload just the changed objects instead
+     * of the whole book.
+     *
+     * Must be called before load().
+     */
+    void set_change_log(bool enable) noexcept { m_change_log = enable; }
+    bool change_log() const noexcept { return m_change_log; }
+    /**
+     * Check the change log for changes made by other sessions.
+     */
+    bool events_pending() override;
+    /**
+     * Reload the objects that events_pending() found changed.
+     *
+     * @return true if the book was changed.
+     */
+    bool process_events() override;
     /**
      * Initializes DB table version information.
      */
@@ -248,12 +328,17 @@ protected:
     bool m_is_pristine_db; /**< Are we saving to a new pristine db? */
     const char* m_time_format = nullptr; /**< Server-specific date-time string format */
     VersionVec m_versions;    /**< Version number for each table */
+    std::unique_ptr<GncSqlWriteQueue> m_write_queue; /**< Write-behind queue */
 private:
     bool write_account_tree(Account*);
     bool write_accounts();
     bool write_transactions();
     bool write_template_transactions();
     bool write_schedXactions();
+    void commit_write_behind(QofInstance* inst, bool is_new_or_deleted);
+    void start_read_ahead() noexcept;
+    void start_change_log() noexcept;
+    bool log_change(QofInstance* inst) noexcept;
     GncSqlStatementPtr build_insert_statement (const char* table_name,
                                                QofIdTypeConst obj_name,
                                                gpointer pObject,
@@ -288,6 +373,20 @@ private:
     };
     ObjectBackendRegistry m_backend_registry;
     std::vector<gnc_commodity*> m_postload_commodities;
+    /** Receives the non-select statements instead of the connection while
+     * commit() prepares a write-behind unit. */
+    std::vector<std::string>* m_captured_statements = nullptr;
+    /** Executes the initial load's queries on extra connections. */
+    std::unique_ptr<GncSqlReadAhead> m_read_ahead;
+    bool m_change_log = false;
+    std::string m_session_id;    /**< Identifies this session's changes */
+    int64_t m_change_seq = 0;    /**< All changes up to this one are seen */
+    /** Changes after m_change_seq that have been seen; the ones in between
+     * belong to database transactions that haven't been committed yet. */
+    std::set<int64_t> m_changes_seen;
+    unsigned int m_change_gap_polls = 0;
+    std::vector<GncSqlChange> m_pending_changes;
+    unsigned int m_bulk_written = 0; /**< Transactions in bulk_write() */
 };
 
 #endif //__GNC_SQL_BACKEND_HPP__
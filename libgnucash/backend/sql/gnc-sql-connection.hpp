@@ -97,6 +97,33 @@ public:
                            bool retry) noexcept = 0;
     virtual bool verify() noexcept = 0;
     virtual bool retry_connection(const char* msg) noexcept = 0;
+    /**
+     * Create another connection to the same database for executing SELECTs
+     * on a separate thread. The reader connects when it's first used, on
+     * that thread, and mustn't report errors to the backend.
+     *
+     * @return nullptr if the database doesn't support concurrent readers.
+     */
+    virtual GncSqlConnection* open_reader() const noexcept { return nullptr; }
+    /**
+     * Release what the database client keeps for the thread that used a
+     * reader. Called on that thread just before it exits.
+     */
+    virtual void end_thread() noexcept {}
+    /**
+     * Keep the errors of the following calls instead of reporting them to
+     * the backend, for calls made on a thread other than the backend's.
+     */
+    virtual void defer_errors() noexcept {}
+    /**
+     * Report errors to the backend again.
+     *
+     * @return The first error kept since defer_errors().
+     */
+    virtual QofBackendError end_defer_errors() noexcept
+    {
+        return ERR_BACKEND_NO_ERR;
+    }
 
 };
 
@@ -60,6 +60,27 @@ public:
      * @param sql_be The GncSqlBackend containing the database connection.
      */
     virtual void load_all (GncSqlBackend* sql_be) = 0;
+    /**
+     * The SELECT statements load_all() executes that don't depend on what it
+     * loaded before, in execution order, so that they can be executed ahead
+     * of time.
+     * @return The SQL statements, by default none.
+     */
+    virtual std::vector<std::string> load_statements () const { return {}; }
+    /**
+     * Bring objects of m_type that another session changed up to date with
+     * the database.
+     * @param sql_be The GncSqlBackend containing the database connection.
+     * @param guids The changed objects; those no longer in the database have
+     * been deleted.
+     * @return false if the type doesn't support this, in which case the
+     * changes are only seen when the book is reopened.
+     */
+    virtual bool load_changed (GncSqlBackend* sql_be,
+                               const std::vector<GncGUID>& guids)
+    {
+        return false;
+    }
     /**
      * Conditionally create or update a database table from m_col_table. The
      * condition is the version returned by querying the database's version
@@ -0,0 +1,101 @@
+/***********************************************************************\
+ * gnc-sql-read-ahead.cpp: Run load queries on extra connections.      *
+ *                                                                     *
+ * This program is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU General Public License as      *
+ * published by the Free Software Foundation; either version 2 of      *
+ * the License, or (at your option) any later version.                 *
+ *                                                                     *
+ * This program is distributed in the hope that it will be useful,     *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of      *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the       *
+ * GNU General Public License for more details.                        *
+ *                                                                     *
+ * You should have received a copy of the GNU General Public License   *
+ * along with this program; if not, contact:                           *
+ *                                                                     *
+ * Free Software Foundation           Voice:  +1-617-542-5942          *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652          *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                      *
+\***********************************************************************/
+extern "C"
+{
+#include <config.h>
+#include <qof.h>
+}
+#include <algorithm>
+#include "gnc-sql-connection.hpp"
+#include "gnc-sql-result.hpp"
+#include "gnc-sql-read-ahead.hpp"
+
+static QofLogModule log_module = G_LOG_DOMAIN;
+
+GncSqlReadAhead::GncSqlReadAhead(std::vector<GncSqlConnection*>&& readers,
+                                 std::vector<std::string>&& statements) :
+    m_readers{std::move(readers)}
+{
+    m_statements.reserve (statements.size());
+    for (auto& sql : statements)
+        m_statements.push_back (Statement{std::move(sql)});
+    m_threads.reserve (m_readers.size());
+    for (auto reader : m_readers)
+        m_threads.emplace_back (&GncSqlReadAhead::run, this, reader);
+}
+
+GncSqlReadAhead::~GncSqlReadAhead()
+{
+    {
+        std::unique_lock<std::mutex> lock{m_mutex};
+        m_stop = true;
+    }
+    for (auto& thread : m_threads)
+        thread.join();
+    for (auto& stmt : m_statements)
+        if (!stmt.taken)
+            delete stmt.result;
+    for (auto reader : m_readers)
+        delete reader;
+}
+
+GncSqlResult*
+GncSqlReadAhead::take(const std::string& sql)
+{
+    std::unique_lock<std::mutex> lock{m_mutex};
+    auto stmt = std::find_if (m_statements.begin(), m_statements.end(),
+                              [&sql](const Statement& s)
+                              {
+                                  return !s.taken && s.sql == sql;
+                              });
+    if (stmt == m_statements.end())
+        return nullptr;
+    m_done.wait (lock, [stmt]{ return stmt->done; });
+    stmt->taken = true;
+    return stmt->result;
+}
+
+void
+GncSqlReadAhead::run(GncSqlConnection* reader)
+{
+    std::unique_lock<std::mutex> lock{m_mutex};
+    while (!m_stop && m_next < m_statements.size())
+    {
+        auto& stmt = m_statements[m_next++];
+        lock.unlock();
+
+        GncSqlResult* result = nullptr;
+        auto sql_stmt = reader->create_statement_from_sql (stmt.sql);
+        if (sql_stmt != nullptr)
+            result = reader->execute_select_statement (sql_stmt);
+        if (result == nullptr)
+            PWARN ("Reading ahead failed for %s", stmt.sql.c_str());
+
+        lock.lock();
+        stmt.result = result;
+        stmt.done = true;
+        m_done.notify_all();
+    }
+    lock.unlock();
+    reader->end_thread();
+}
+
+/* ========================== END OF FILE ===================== */
@@ -0,0 +1,94 @@
+/***********************************************************************\
+ * gnc-sql-read-ahead.hpp: Run load queries on extra connections.      *
+ *                                                                     *
+ * This program is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU General Public License as      *
+ * published by the Free Software Foundation; either version 2 of      *
+ * the License, or (at your option) any later version.                 *
+ *                                                                     *
+ * This program is distributed in the hope that it will be useful,     *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of      *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the       *
+ * GNU General Public License for more details.                        *
+ *                                                                     *
+ * You should have received a copy of the GNU General Public License   *
+ * along with this program; if not, contact:                           *
+ *                                                                     *
+ * Free Software Foundation           Voice:  +1-617-542-5942          *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652          *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                      *
+\***********************************************************************/
+
+#ifndef __GNC_SQL_READ_AHEAD_HPP__
+#define __GNC_SQL_READ_AHEAD_HPP__
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class GncSqlConnection;
+class GncSqlResult;
+
+/**
+ * Executes SELECT statements ahead of time so that the database round trips
+ * overlap with the loading of the results.
+ *
+ * Each reader connection gets a thread of its own; the threads take the
+ * statements in order and keep the results until take() hands them out.
+ * Only the statements are executed on the reader threads: the results are
+ * still read on the caller's thread, which is the only one allowed to touch
+ * the engine.
+ */
+class GncSqlReadAhead
+{
+public:
+    /**
+     * Start executing the statements.
+     *
+     * @param readers Connections from GncSqlConnection::open_reader(); they
+     * are deleted with the GncSqlReadAhead.
+     * @param statements The SELECT statements, in the order they'll be
+     * needed.
+     */
+    GncSqlReadAhead(std::vector<GncSqlConnection*>&& readers,
+                    std::vector<std::string>&& statements);
+    GncSqlReadAhead(const GncSqlReadAhead&) = delete;
+    GncSqlReadAhead& operator=(const GncSqlReadAhead&) = delete;
+    /**
+     * Skip the statements that haven't started, wait for the rest and free
+     * the results that weren't taken. Results handed out by take() mustn't
+     * be used after this because they may refer to the readers.
+     */
+    ~GncSqlReadAhead();
+    /**
+     * Get the result of a statement, waiting for it if it is still being
+     * executed. Each result is handed out once.
+     *
+     * @param sql The statement.
+     * @return The result, owned by the caller, or nullptr if the statement
+     * wasn't read ahead or failed, in which case the caller should just
+     * execute it.
+     */
+    GncSqlResult* take(const std::string& sql);
+private:
+    struct Statement
+    {
+        std::string sql;
+        GncSqlResult* result = nullptr;
+        bool done = false;
+        bool taken = false;
+    };
+    void run(GncSqlConnection* reader);
+
+    std::vector<GncSqlConnection*> m_readers;
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;             /**< Protects everything below. */
+    std::condition_variable m_done;
+    std::vector<Statement> m_statements;
+    size_t m_next = 0;              /**< Next statement to execute. */
+    bool m_stop = false;
+};
+
+#endif //__GNC_SQL_READ_AHEAD_HPP__
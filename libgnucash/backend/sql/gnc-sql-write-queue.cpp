@@ -0,0 +1,293 @@
+/***********************************************************************\
+ * gnc-sql-write-queue.cpp: Write-behind queue for the SQL backend.    *
+ *                                                                     *
+ * This program is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU General Public License as      *
+ * published by the Free Software Foundation; either version 2 of      *
+ * the License, or (at your option) any later version.                 *
+ *                                                                     *
+ * This program is distributed in the hope that it will be useful,     *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of      *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the       *
+ * GNU General Public License for more details.                        *
+ *                                                                     *
+ * You should have received a copy of the GNU General Public License   *
+ * along with this program; if not, contact:                           *
+ *                                                                     *
+ * Free Software Foundation           Voice:  +1-617-542-5942          *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652          *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                      *
+\***********************************************************************/
+extern "C"
+{
+#include <config.h>
+#include <glib/gstdio.h>
+}
+#include <algorithm>
+#include "gnc-sql-connection.hpp"
+#include "gnc-sql-write-queue.hpp"
+
+static QofLogModule log_module = G_LOG_DOMAIN;
+
+/* Journal format: each unit is written as
+ *   unit <number of statements>\n
+ *   <length> <statement>\n      (once per statement)
+ *   end\n
+ * A unit without its end line was cut short by a crash before it was
+ * queued, so it is ignored when replaying.
+ *
+ * After each unit the writer rewrites the journal from the failed and the
+ * still queued units, so a committed unit is never replayed over later
+ * changes.
+ */
+
+GncSqlWriteQueue::GncSqlWriteQueue(GncSqlConnection* conn,
+                                   const std::string& journal,
+                                   size_t max_pending) :
+    m_conn{conn}, m_journal_path{journal},
+    m_journal{journal, std::ios::binary | std::ios::trunc},
+    m_max_pending{std::max<size_t>(max_pending, 1)}
+{
+    if (!m_journal)
+        PWARN ("Unable to open the write journal %s, queued writes will "
+               "be lost if GnuCash crashes.", journal.c_str());
+    m_writer = std::thread{&GncSqlWriteQueue::run, this};
+}
+
+GncSqlWriteQueue::~GncSqlWriteQueue()
+{
+    {
+        std::unique_lock<std::mutex> lock{m_mutex};
+        m_stop = true;
+    }
+    m_work.notify_one();
+    m_writer.join();
+    m_journal.close();
+    if (m_failed_units.empty())
+        g_remove (m_journal_path.c_str());
+}
+
+void
+GncSqlWriteQueue::enqueue(const InstanceRef& inst, bool is_update,
+                          StatementVec&& stmts)
+{
+    if (stmts.empty())
+        return;
+    Unit unit{inst, is_update, std::move(stmts)};
+    auto& guid = inst.second;
+    std::unique_lock<std::mutex> lock{m_mutex};
+    /* Back-pressure: don't let the queue run away from a slow server. */
+    m_done.wait (lock, [this]{ return m_pending.size() < m_max_pending; });
+    if (m_journal.is_open())
+    {
+        write_journal (m_journal, unit);
+        m_journal.flush();
+        if (!m_journal)
+            PWARN ("Failed to write the write journal %s.",
+                   m_journal_path.c_str());
+    }
+    /* An update rewrites the whole instance, so an earlier update of the
+     * same instance that hasn't started yet would be overwritten anyway. */
+    if (is_update)
+    {
+        auto old = std::find_if (m_pending.begin(), m_pending.end(),
+                                 [&guid](const Unit& pending)
+                                 {
+                                     return pending.is_update &&
+                                         guid_equal (&pending.inst.second,
+                                                     &guid);
+                                 });
+        if (old != m_pending.end())
+        {
+            DEBUG ("Replacing a queued update");
+            m_pending.erase (old);
+        }
+    }
+    m_pending.push_back (std::move(unit));
+    lock.unlock();
+    m_work.notify_one();
+}
+
+QofBackendError
+GncSqlWriteQueue::flush(InstanceRefVec* failed)
+{
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_done.wait (lock, [this]{ return m_pending.empty() && !m_busy; });
+    auto error = m_error;
+    m_error = ERR_BACKEND_NO_ERR;
+    if (failed != nullptr)
+        failed->insert (failed->end(), m_failed.begin(), m_failed.end());
+    m_failed.clear();
+    return error;
+}
+
+void
+GncSqlWriteQueue::run()
+{
+    std::unique_lock<std::mutex> lock{m_mutex};
+    while (true)
+    {
+        m_work.wait (lock, [this]{ return m_stop || !m_pending.empty(); });
+        if (m_pending.empty())
+            break;              // Stopping and everything has been written.
+        auto unit = std::move(m_pending.front());
+        m_pending.pop_front();
+        m_busy = true;
+        lock.unlock();
+        m_done.notify_all();    // There's room in the queue again.
+
+        auto error = ERR_BACKEND_NO_ERR;
+        auto ok = execute (m_conn, unit.stmts, &m_conn_mutex, &error);
+
+        lock.lock();
+        m_busy = false;
+        /* An update rewrites the whole instance, so an earlier failed update
+         * of it is superseded, whether this unit is committed or kept. */
+        auto& guid = unit.inst.second;
+        m_failed_units.erase (std::remove_if (m_failed_units.begin(),
+                                              m_failed_units.end(),
+                                              [&guid](const Unit& failed)
+                                              {
+                                                  return failed.is_update &&
+                                                      guid_equal (&failed.inst.second,
+                                                                  &guid);
+                                              }),
+                              m_failed_units.end());
+        if (!ok)
+        {
+            PERR ("A queued write failed; it is kept in %s.",
+                  m_journal_path.c_str());
+            if (m_error == ERR_BACKEND_NO_ERR)
+                m_error = error != ERR_BACKEND_NO_ERR ? error :
+                    ERR_BACKEND_SERVER_ERR;
+            m_failed.push_back (unit.inst);
+            m_failed_units.push_back (std::move(unit));
+        }
+        rewrite_journal ();
+        m_done.notify_all();
+    }
+}
+
+bool
+GncSqlWriteQueue::execute(GncSqlConnection* conn, const StatementVec& stmts,
+                          std::mutex* conn_mutex, QofBackendError* error)
+{
+    /* The connection is only locked per statement so that the caller can
+     * quote strings for the next unit while this one is executing. With a
+     * lock we're on the writer thread, whose errors go to error instead of
+     * the backend. */
+    auto run_locked = [conn, conn_mutex, error](auto&& func)
+    {
+        if (conn_mutex == nullptr)
+            return func();
+        std::lock_guard<std::mutex> lock{*conn_mutex};
+        conn->defer_errors();
+        auto result = func();
+        auto deferred = conn->end_defer_errors();
+        if (error != nullptr && *error == ERR_BACKEND_NO_ERR)
+            *error = deferred;
+        return result;
+    };
+
+    if (!run_locked ([conn]{ return conn->begin_transaction(); }))
+    {
+        PERR ("begin_transaction failed");
+        return false;
+    }
+    for (auto const& sql : stmts)
+    {
+        auto ok = run_locked ([conn, &sql]
+                              {
+                                  auto stmt = conn->create_statement_from_sql (sql);
+                                  return stmt != nullptr &&
+                                      conn->execute_nonselect_statement (stmt) != -1;
+                              });
+        if (!ok)
+        {
+            run_locked ([conn]{ return conn->rollback_transaction(); });
+            return false;
+        }
+    }
+    return run_locked ([conn]{ return conn->commit_transaction(); });
+}
+
+void
+GncSqlWriteQueue::write_journal(std::ostream& out, const Unit& unit)
+{
+    out << "unit " << unit.stmts.size() << '\n';
+    for (auto const& sql : unit.stmts)
+        out << sql.size() << ' ' << sql << '\n';
+    out << "end\n";
+}
+
+/* Replace the journal with the failed and the queued units. The new journal
+ * is written next to the old one and renamed over it, so that a crash while
+ * rewriting doesn't lose the queued units. */
+void
+GncSqlWriteQueue::rewrite_journal()
+{
+    if (!m_journal.is_open())
+        return;
+    m_journal.close();
+    auto tmp_path = m_journal_path + ".new";
+    {
+        std::ofstream out{tmp_path, std::ios::binary | std::ios::trunc};
+        for (auto const& unit : m_failed_units)
+            write_journal (out, unit);
+        for (auto const& unit : m_pending)
+            write_journal (out, unit);
+        out.close();
+        if (!out || g_rename (tmp_path.c_str(), m_journal_path.c_str()) != 0)
+        {
+            PWARN ("Failed to rewrite the write journal %s.",
+                   m_journal_path.c_str());
+            g_remove (tmp_path.c_str());
+        }
+    }
+    m_journal.open (m_journal_path, std::ios::binary | std::ios::app);
+}
+
+unsigned int
+GncSqlWriteQueue::replay_journal(GncSqlConnection* conn,
+                                 const std::string& journal)
+{
+    g_return_val_if_fail (conn != nullptr, 0);
+
+    std::ifstream in{journal, std::ios::binary};
+    if (!in)
+        return 0;
+
+    unsigned int replayed = 0, failed = 0;
+    std::string word;
+    while (in >> word && word == "unit")
+    {
+        size_t count;
+        if (!(in >> count))
+            break;
+        StatementVec stmts;
+        for (size_t i = 0; i < count; ++i)
+        {
+            size_t length;
+            if (!(in >> length) || in.get() != ' ')
+                break;
+            std::string sql(length, '\0');
+            if (!in.read (&sql[0], length) || in.get() != '\n')
+                break;
+            stmts.push_back (std::move(sql));
+        }
+        if (stmts.size() != count || !(in >> word) || word != "end")
+            break;              // Truncated by a crash, never queued.
+        if (execute (conn, stmts, nullptr, nullptr))
+            ++replayed;
+        else
+            ++failed;
+    }
+    in.close();
+    if (replayed || failed)
+        PINFO ("Replayed %u units from %s, %u failed.", replayed,
+               journal.c_str(), failed);
+    g_remove (journal.c_str());
+    return replayed;
+}
+
+/* ========================== END OF FILE ===================== */
@@ -0,0 +1,138 @@
+/***********************************************************************\
+ * gnc-sql-write-queue.hpp: Write-behind queue for the SQL backend.    *
+ *                                                                     *
+ * This program is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU General Public License as      *
+ * published by the Free Software Foundation; either version 2 of      *
+ * the License, or (at your option) any later version.                 *
+ *                                                                     *
+ * This program is distributed in the hope that it will be useful,     *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of      *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the       *
+ * GNU General Public License for more details.                        *
+ *                                                                     *
+ * You should have received a copy of the GNU General Public License   *
+ * along with this program; if not, contact:                           *
+ *                                                                     *
+ * Free Software Foundation           Voice:  +1-617-542-5942          *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652          *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                      *
+\***********************************************************************/
+
+#ifndef __GNC_SQL_WRITE_QUEUE_HPP__
+#define __GNC_SQL_WRITE_QUEUE_HPP__
+
+extern "C"
+{
+#include <qof.h>
+}
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class GncSqlConnection;
+
+using StatementVec = std::vector<std::string>;
+/** An instance's type and guid. */
+using InstanceRef = std::pair<QofIdTypeConst, GncGUID>;
+using InstanceRefVec = std::vector<InstanceRef>;
+
+/**
+ * Executes the SQL statements of instance commits on a separate thread so
+ * that the caller doesn't wait for the database round trips.
+ *
+ * Each commit is queued as a unit, the statements generated for one
+ * instance, and the units are executed in order, each in its own database
+ * transaction. A unit that only updates an instance replaces a
+ * not-yet-started update of the same instance. Units are appended to a
+ * journal file before they're queued and dropped from it once they're
+ * committed, so that writes lost to a crash or that failed can be replayed
+ * with replay_journal().
+ *
+ * The connection is shared with the caller: while the queue exists the
+ * caller must call flush() before executing anything on it and must hold
+ * connection_mutex() for anything else that touches it, e.g. quoting. The
+ * writer thread defers the connection's errors and flush() returns them, so
+ * that only the caller's thread reports errors to the backend.
+ */
+class GncSqlWriteQueue
+{
+public:
+    /**
+     * @param conn The connection the units are executed on.
+     * @param journal Path of the journal file; it is truncated.
+     * @param max_pending Number of queued units at which enqueue() waits
+     * for the writer to catch up.
+     */
+    GncSqlWriteQueue(GncSqlConnection* conn, const std::string& journal,
+                     size_t max_pending = 64);
+    GncSqlWriteQueue(const GncSqlWriteQueue&) = delete;
+    GncSqlWriteQueue& operator=(const GncSqlWriteQueue&) = delete;
+    /** Executes the remaining units and stops the writer thread. */
+    ~GncSqlWriteQueue();
+    /**
+     * Journal and queue the statements committing one instance.
+     *
+     * @param inst The instance's type and guid.
+     * @param is_update True if the statements only rewrite an instance that
+     * is already in the database, so that a later update can replace them.
+     * @param stmts The SQL statements, in execution order.
+     */
+    void enqueue(const InstanceRef& inst, bool is_update, StatementVec&& stmts);
+    /**
+     * Wait until every queued unit has been executed.
+     *
+     * @param failed If not null, the instances of the units that failed
+     * since the last call are appended to it.
+     * @return The first error since the last call, ERR_BACKEND_NO_ERR if
+     * every unit was committed.
+     */
+    QofBackendError flush(InstanceRefVec* failed = nullptr);
+    std::mutex& connection_mutex() noexcept { return m_conn_mutex; }
+    /**
+     * Execute the complete units recorded in a journal file, then remove it.
+     * A unit that fails, typically an insert that had already been
+     * committed before the crash, is rolled back and skipped.
+     *
+     * @return The number of units executed successfully.
+     */
+    static unsigned int replay_journal(GncSqlConnection* conn,
+                                       const std::string& journal);
+private:
+    struct Unit
+    {
+        InstanceRef inst;
+        bool is_update;
+        StatementVec stmts;
+    };
+    void run();
+    static bool execute(GncSqlConnection* conn, const StatementVec& stmts,
+                        std::mutex* conn_mutex, QofBackendError* error);
+    void write_journal(std::ostream& out, const Unit& unit);
+    void rewrite_journal();
+
+    GncSqlConnection* m_conn;
+    std::string m_journal_path;
+    std::ofstream m_journal;
+    size_t m_max_pending;
+    std::mutex m_mutex;             /**< Protects everything below. */
+    std::condition_variable m_work; /**< Signals the writer. */
+    std::condition_variable m_done; /**< Signals the waiting callers. */
+    std::deque<Unit> m_pending;
+    /** Failed units, kept in the journal for the next session. */
+    std::deque<Unit> m_failed_units;
+    /** The instances of the units that failed since the last flush(). */
+    InstanceRefVec m_failed;
+    QofBackendError m_error = ERR_BACKEND_NO_ERR;
+    bool m_busy = false;
+    bool m_stop = false;
+    std::mutex m_conn_mutex;
+    std::thread m_writer;
+};
+
+#endif //__GNC_SQL_WRITE_QUEUE_HPP__
@@ -260,7 +260,6 @@ load_single_taxtable (GncSqlBackend* sql_be, GncSqlRow& row,
         tt = gncTaxTableCreate (sql_be->book());
     }
     gnc_sql_load_object (sql_be, row, GNC_ID_TAXTABLE, tt, tt_col_table);
-    gnc_sql_slots_load (sql_be, QOF_INSTANCE (tt));
     load_taxtable_entries (sql_be, tt);
 
     /* If the tax table doesn't have a parent, it might be because it hasn't
@@ -283,6 +282,13 @@ load_single_taxtable (GncSqlBackend* sql_be, GncSqlRow& row,
     qof_instance_mark_clean (QOF_INSTANCE (tt));
 }
 
+/* Because gncTaxTableLookup has the arguments backwards: */
+static inline GncTaxTable*
+gnc_taxtable_lookup (const GncGUID *guid, const QofBook *book)
+{
+     QOF_BOOK_RETURN_ENTITY(book, guid, GNC_ID_TAXTABLE, GncTaxTable);
+}
+
 void
 GncSqlTaxTableBackend::load_all (GncSqlBackend* sql_be)
 {
@@ -297,6 +303,13 @@ GncSqlTaxTableBackend::load_all (GncSqlBackend* sql_be)
 
     for (auto row : *result)
         load_single_taxtable (sql_be, row, tt_needing_parents);
+    delete result;
+
+    std::string pkey(tt_col_table[0]->name());
+    sql.str("");
+    sql << "SELECT DISTINCT " << pkey << " FROM " << TT_TABLE_NAME;
+    gnc_sql_slots_load_for_sql_subquery (sql_be, sql.str(),
+                                         (BookLookupFn)gnc_taxtable_lookup);
 
     /* While there are items on the list of taxtables needing parents,
        try to see if the parent has now been loaded.  Theory says that if
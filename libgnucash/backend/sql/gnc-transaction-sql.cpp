@@ -49,11 +49,11 @@ extern "C"
 #endif
 }
 
+#include <cmath>
+#include <locale>
 #include <string>
 #include <sstream>
 
-#include "escape.h"
-
 #include <gnc-datetime.hpp>
 #include "gnc-sql-connection.hpp"
 #include "gnc-sql-backend.hpp"
@@ -63,8 +63,6 @@ extern "C"
 #include "gnc-commodity-sql.h"
 #include "gnc-slots-sql.h"
 
-#define SIMPLE_QUERY_COMPILATION 1
-
 static QofLogModule log_module = G_LOG_DOMAIN;
 
 #define TRANSACTION_TABLE "transactions"
@@ -149,13 +147,6 @@ GncSqlSplitBackend::GncSqlSplitBackend() :
     GncSqlObjectBackend(SPLIT_TABLE_VERSION, GNC_ID_SPLIT,
                         SPLIT_TABLE, split_col_table) {}
 
-/* These functions exist but have not been tested.
-   #if LOAD_TRANSACTIONS_AS_NEEDED
-   compile_split_query,
-   run_split_query,
-   free_split_query,
-*/
-
 /* ================================================================= */
 
 static  gpointer
@@ -241,12 +232,13 @@ load_single_split (GncSqlBackend* sql_be, GncSqlRow& row)
     }
     return pSplit;
 }
-static void
-load_splits_for_transactions (GncSqlBackend* sql_be, std::string selector)
+/* The SQL loading the splits of the transactions selected by selector. An
+ * empty selector selects all transactions and is replaced by the equivalent
+ * subquery.
+ */
+static std::string
+splits_sql_for_transactions (std::string& selector)
 {
-    g_return_if_fail (sql_be != NULL);
-
-    const std::string spkey(split_col_table[0]->name());
     const std::string sskey(tx_guid_col_table[0]->name());
     const std::string tpkey(tx_col_table[0]->name());
 
@@ -260,6 +252,26 @@ load_splits_for_transactions (GncSqlBackend* sql_be, std::string selector)
     }
     else
         sql += " * FROM " SPLIT_TABLE " WHERE " + sskey + " IN " + selector;
+    return sql;
+}
+
+static std::string
+split_slots_subquery (const std::string& selector)
+{
+    const std::string spkey(split_col_table[0]->name());
+    const std::string sskey(tx_guid_col_table[0]->name());
+
+    std::string sql("SELECT DISTINCT ");
+    sql += spkey + " FROM " SPLIT_TABLE " WHERE " + sskey + " IN " + selector;
+    return sql;
+}
+
+static void
+load_splits_for_transactions (GncSqlBackend* sql_be, std::string selector)
+{
+    g_return_if_fail (sql_be != NULL);
+
+    auto sql = splits_sql_for_transactions (selector);
 
     // Execute the query and load the splits
     auto stmt = sql_be->create_statement_from_sql(sql);
@@ -267,9 +279,7 @@ load_splits_for_transactions (GncSqlBackend* sql_be, std::string selector)
 
     for (auto row : *result)
         load_single_split (sql_be, row);
-    sql = "SELECT DISTINCT ";
-    sql += spkey + " FROM " SPLIT_TABLE " WHERE " + sskey + " IN " + selector;
-    gnc_sql_slots_load_for_sql_subquery(sql_be, sql,
+    gnc_sql_slots_load_for_sql_subquery(sql_be, split_slots_subquery (selector),
                                         (BookLookupFn)xaccSplitLookup);
 }
 
@@ -724,173 +734,413 @@ GncSqlTransBackend::load_all (GncSqlBackend* sql_be)
                                    nullptr);
 }
 
-static void
-convert_query_comparison_to_sql (QofQueryPredData* pPredData,
-                                 gboolean isInverted, std::stringstream& sql)
-{
-    if (pPredData->how == QOF_COMPARE_LT
-        || (isInverted && pPredData->how == QOF_COMPARE_GTE))
-        sql << "<";
-    else if (pPredData->how == QOF_COMPARE_LTE
-             || (isInverted && pPredData->how == QOF_COMPARE_GT))
-        sql << "<=";
-    else if (pPredData->how == QOF_COMPARE_EQUAL
-             || (isInverted && pPredData->how == QOF_COMPARE_NEQ))
-        sql << "=";
-    else if (pPredData->how == QOF_COMPARE_GT
-             || (isInverted && pPredData->how == QOF_COMPARE_LTE))
-        sql << ">";
-    else if (pPredData->how == QOF_COMPARE_GTE
-             || (isInverted && pPredData->how == QOF_COMPARE_LT))
-        sql << ">=";
-    else if (pPredData->how == QOF_COMPARE_NEQ
-             || (isInverted && pPredData->how == QOF_COMPARE_EQUAL))
-        sql <<  "~=";
-    else
+/**
+ * Reloads transactions changed by another session: the local copies are
+ * destroyed and whatever is still in the database is loaded again.
+ * Transactions open for editing here are left alone.
+ */
+bool
+GncSqlTransBackend::load_changed (GncSqlBackend* sql_be,
+                                  const std::vector<GncGUID>& guids)
+{
+    g_return_val_if_fail (sql_be != NULL, false);
+
+    std::string selector;
+    for (auto const& guid : guids)
     {
-        PERR ("Unknown comparison type\n");
-        sql << "??";
+        auto pTx = xaccTransLookup (&guid, sql_be->book());
+        if (pTx != nullptr)
+        {
+            if (xaccTransIsOpen (pTx))
+            {
+                PWARN ("Transaction %s was changed elsewhere while being "
+                       "edited here.", xaccTransGetDescription (pTx));
+                continue;
+            }
+            xaccTransBeginEdit (pTx);
+            xaccTransDestroy (pTx);
+            xaccTransCommitEdit (pTx);
+        }
+        selector += selector.empty() ? "(" : ",";
+        selector += "'" + gnc::GUID(guid).to_string() + "'";
     }
+    if (selector.empty())
+        return true;
+    selector += ")";
+
+    auto root = gnc_book_get_root_account (sql_be->book());
+    gnc_account_foreach_descendant(root, (AccountCb)xaccAccountBeginEdit,
+                                   nullptr);
+    query_transactions (sql_be, selector);
+    gnc_account_foreach_descendant(root, (AccountCb)xaccAccountCommitEdit,
+                                   nullptr);
+    return true;
 }
 
-static void
-convert_query_term_to_sql (const GncSqlBackend* sql_be, const gchar* fieldName,
-                           QofQueryTerm* pTerm, std::stringstream& sql)
+std::vector<std::string>
+GncSqlTransBackend::load_statements () const
+{
+    const std::string tpkey(tx_col_table[0]->name());
+    std::string selector;
+    auto splits_sql = splits_sql_for_transactions (selector);
+    return {"SELECT * FROM " TRANSACTION_TABLE, splits_sql,
+            gnc_sql_slots_sql_for_subquery (split_slots_subquery (selector)),
+            gnc_sql_slots_sql_for_subquery ("SELECT DISTINCT " + tpkey +
+                                            " FROM " TRANSACTION_TABLE)};
+}
+
+/* ----------------------------------------------------------------- */
+/* Split queries
+ *
+ * The engine checks every candidate against the query itself, so a term
+ * only needs to be translated into a condition that every split matching
+ * it satisfies. Anything that can't be expressed that way is left out of
+ * the WHERE clause: inverted terms, regular expressions, case-insensitive
+ * string matches (the engine compares case-folded, NFKD-normalized strings)
+ * and "not equal"-style comparisons. Dates and amounts are compared with a
+ * little slack for the same reason.
+ */
+struct split_query_column_t
+{
+    const char* param;          /**< First element of the parameter path */
+    const char* sub_param;      /**< Second element or nullptr */
+    const char* pred_type;      /**< Predicate type the column supports */
+    const char* column;         /**< Column, qualified by table alias */
+};
+
+static const split_query_column_t split_query_columns[]
 {
-    QofQueryPredData* pPredData;
-    gboolean isInverted;
+    {QOF_PARAM_GUID, nullptr, QOF_TYPE_GUID, "s.guid"},
+    {SPLIT_ACCOUNT, QOF_PARAM_GUID, QOF_TYPE_GUID, "s.account_guid"},
+    {SPLIT_TRANS, QOF_PARAM_GUID, QOF_TYPE_GUID, "s.tx_guid"},
+    {SPLIT_MEMO, nullptr, QOF_TYPE_STRING, "s.memo"},
+    {SPLIT_ACTION, nullptr, QOF_TYPE_STRING, "s.action"},
+    {SPLIT_RECONCILE, nullptr, QOF_TYPE_CHAR, "s.reconcile_state"},
+    {SPLIT_DATE_RECONCILED, nullptr, QOF_TYPE_DATE, "s.reconcile_date"},
+    {SPLIT_VALUE, nullptr, QOF_TYPE_NUMERIC, "s.value"},
+    {SPLIT_AMOUNT, nullptr, QOF_TYPE_NUMERIC, "s.quantity"},
+    {SPLIT_TRANS, TRANS_NUM, QOF_TYPE_STRING, "t.num"},
+    {SPLIT_TRANS, TRANS_DESCRIPTION, QOF_TYPE_STRING, "t.description"},
+    {SPLIT_TRANS, TRANS_DATE_POSTED, QOF_TYPE_DATE, "t.post_date"},
+    {SPLIT_TRANS, TRANS_DATE_ENTERED, QOF_TYPE_DATE, "t.enter_date"},
+};
 
-    g_return_if_fail (pTerm != NULL);
+static const split_query_column_t*
+find_split_query_column (QofQueryTerm* term)
+{
+    auto path = qof_query_term_get_param_path (term);
+    auto pdata = qof_query_term_get_pred_data (term);
+    if (path == nullptr || pdata == nullptr)
+        return nullptr;
+    auto param = static_cast<const char*>(path->data);
+    auto sub_param = path->next ? static_cast<const char*>(path->next->data) :
+        nullptr;
+    if (path->next && path->next->next)
+        return nullptr;
+    for (auto& col : split_query_columns)
+        if (g_strcmp0 (param, col.param) == 0 &&
+            g_strcmp0 (sub_param, col.sub_param) == 0 &&
+            g_strcmp0 (pdata->type_name, col.pred_type) == 0)
+            return &col;
+    return nullptr;
+}
 
-    pPredData = qof_query_term_get_pred_data (pTerm);
-    isInverted = qof_query_term_is_inverted (pTerm);
+static std::string
+format_sql_time (time64 time)
+{
+    GncDateTime gdt(time);
+    return "'" + gdt.format_iso8601() + "'";
+}
 
-    if (g_strcmp0 (pPredData->type_name, QOF_TYPE_GUID) == 0)
+static bool
+guid_term_to_sql (const char* column, query_guid_t pdata, std::string& sql)
+{
+    if (pdata->guids == nullptr)
+        return false;
+    switch (pdata->options)
+    {
+    case QOF_GUID_MATCH_ANY:
+        sql = std::string{column} + " IN (";
+        break;
+    case QOF_GUID_MATCH_NONE:
+        sql = std::string{column} + " NOT IN (";
+        break;
+    default:
+        return false;
+    }
+    for (auto node = pdata->guids; node; node = node->next)
     {
-        query_guid_t guid_data = (query_guid_t)pPredData;
-        GList* guid_entry;
-        sql << "(" << fieldName;
+        auto guid = static_cast<GncGUID*>(node->data);
+        if (guid == nullptr)
+            return false;
+        if (node != pdata->guids)
+            sql += ",";
+        sql += "'" + gnc::GUID(*guid).to_string() + "'";
+    }
+    sql += ")";
+    return true;
+}
 
-        switch (guid_data->options)
+static bool
+date_term_to_sql (const char* column, query_date_t pdata, std::string& sql)
+{
+    /* Day matches round both times to the same time of day, so allow a
+     * day on either side. A NULL date reads as 0 in the engine. */
+    time64 slack = pdata->options == QOF_DATE_MATCH_DAY ? 86400 : 0;
+    std::string cond;
+    try
+    {
+        switch (pdata->pd.how)
         {
-        case QOF_GUID_MATCH_ANY:
-            sql << (isInverted ? " NOT IN (" : " IN (");
+        case QOF_COMPARE_LT:
+        case QOF_COMPARE_LTE:
+            cond = std::string{column} + " <= " +
+                format_sql_time (pdata->date + slack);
             break;
-
-        case QOF_GUID_MATCH_NONE:
-            sql << (isInverted ? " IN (" : " NOT IN (");
+        case QOF_COMPARE_GT:
+        case QOF_COMPARE_GTE:
+            cond = std::string{column} + " >= " +
+                format_sql_time (pdata->date - slack);
+            break;
+        case QOF_COMPARE_EQUAL:
+            cond = std::string{column} + " BETWEEN " +
+                format_sql_time (pdata->date - slack) + " AND " +
+                format_sql_time (pdata->date + slack);
             break;
-
         default:
-            PERR ("Unexpected GncGUID match type: %d\n", guid_data->options);
-        }
-
-        for (guid_entry = guid_data->guids; guid_entry != NULL;
-             guid_entry = guid_entry->next)
-        {
-            gchar guid_buf[GUID_ENCODING_LENGTH + 1];
-
-            if (guid_entry != guid_data->guids) sql << ",";
-            (void)guid_to_string_buff (static_cast<GncGUID*> (guid_entry->data),
-                                       guid_buf);
-            sql << guid_buf;
+            return false;
         }
-        sql << "))";
-
     }
-    else if (g_strcmp0 (pPredData->type_name, QOF_TYPE_CHAR) == 0)
+    catch (const std::exception&)
     {
-        query_char_t char_data = (query_char_t)pPredData;
-        int i;
+        return false;           // Out of GncDateTime's range.
+    }
+    sql = "(" + std::string{column} + " IS NULL OR " + cond + ")";
+    return true;
+}
 
-        if (isInverted) sql <<  "NOT(";
-        if (char_data->options == QOF_CHAR_MATCH_NONE) sql << "NOT ";
-        sql << "(";
-        for (i = 0; char_data->char_list[i] != '\0'; i++)
-        {
-            if (i != 0) sql << " OR ";
-            sql << fieldName << " = '" << char_data->char_list[i] << "'";
-        }
-        sql << ") ";
-        if (isInverted) sql << ") ";
+static bool
+numeric_term_to_sql (const char* column, query_numeric_t pdata,
+                     std::string& sql)
+{
+    /* The engine compares absolute values and considers amounts within
+     * 1/10000 of each other equal; compare with a bit more slack than that
+     * so that rounding in the database can't exclude a match. */
+    const std::string num{std::string{column} + "_num"};
+    const std::string denom{std::string{column} + "_denom"};
+    const double amount = gnc_numeric_to_double (pdata->amount);
+    const double slack = 0.0002 + std::abs (amount) * 1e-9;
+    std::ostringstream cond;
+    cond.imbue (std::locale::classic());
+    cond.precision (17);
+    switch (pdata->pd.how)
+    {
+    case QOF_COMPARE_LT:
+    case QOF_COMPARE_LTE:
+        cond << " <= " << amount + slack;
+        break;
+    case QOF_COMPARE_GT:
+    case QOF_COMPARE_GTE:
+        cond << " >= " << amount - slack;
+        break;
+    case QOF_COMPARE_EQUAL:
+        cond << " BETWEEN " << std::abs (amount) - slack << " AND "
+             << std::abs (amount) + slack;
+        break;
+    default:
+        break;
     }
-    else if (g_strcmp0 (pPredData->type_name, QOF_TYPE_STRING) == 0)
+
+    sql.clear();
+    if (pdata->options == QOF_NUMERIC_MATCH_CREDIT)
+        sql = num + " <= 0";
+    else if (pdata->options == QOF_NUMERIC_MATCH_DEBIT)
+        sql = num + " >= 0";
+    if (!cond.str().empty())
     {
-        query_string_t string_data = (query_string_t)pPredData;
-        sqlEscape* escape = sqlEscape_new ();
+        if (!sql.empty())
+            sql += " AND ";
+        sql += "(" + denom + " = 0 OR ABS(1.0 * " + num + " / NULLIF(" +
+            denom + ", 0))" + cond.str() + ")";
+    }
+    return !sql.empty();
+}
 
-        if (isInverted ||  pPredData->how == QOF_COMPARE_NEQ)
-            sql << "NOT(";
-        sql << fieldName;
-        if (string_data->is_regex ||
-            string_data->options == QOF_STRING_MATCH_CASEINSENSITIVE)
+static bool
+string_term_to_sql (GncSqlBackend* sql_be, const char* column,
+                    query_string_t pdata, std::string& sql)
+{
+    if (pdata->is_regex || pdata->options != QOF_STRING_MATCH_NORMAL ||
+        pdata->matchstring == nullptr || *pdata->matchstring == '\0')
+        return false;
+    std::string match{pdata->matchstring};
+    switch (pdata->pd.how)
+    {
+    case QOF_COMPARE_EQUAL:
+        sql = std::string{column} + " = " + sql_be->quote_string (match);
+        return true;
+    case QOF_COMPARE_CONTAINS:
+    {
+        std::string pattern{"%"};
+        for (auto c : match)
         {
-            PWARN ("String is_regex || option = QOF_STRING_MATCH_INSENSITIVE\n");
+            if (c == '%' || c == '_' || c == '!')
+                pattern += '!';
+            pattern += c;
         }
-//          sql << " ~" ;
-//      } else {
-        sql << " =";
-//      }
-//      if( string_data->options == QOF_STRING_MATCH_CASEINSENSITIVE ) {
-//          sql+= "*";
-//      }
-        sql << "'" << sqlEscapeString (escape, string_data->matchstring) << "'";
-        if (pPredData->how == QOF_COMPARE_NEQ) sql << ")";
-        if (isInverted) sql << ")";
-        sqlEscape_destroy (escape);
+        pattern += "%";
+        sql = std::string{column} + " LIKE " + sql_be->quote_string (pattern) +
+            " ESCAPE '!'";
+        return true;
+    }
+    default:
+        return false;
+    }
+}
 
+static bool
+char_term_to_sql (GncSqlBackend* sql_be, const char* column,
+                  query_char_t pdata, std::string& sql)
+{
+    if (pdata->char_list == nullptr || *pdata->char_list == '\0')
+        return false;
+    switch (pdata->options)
+    {
+    case QOF_CHAR_MATCH_ANY:
+        sql = std::string{column} + " IN (";
+        break;
+    case QOF_CHAR_MATCH_NONE:
+        sql = std::string{column} + " NOT IN (";
+        break;
+    default:
+        return false;
     }
-    else
+    for (auto c = pdata->char_list; *c; ++c)
     {
-        sql << "(" << fieldName;
-        convert_query_comparison_to_sql (pPredData, isInverted, sql);
+        if (c != pdata->char_list)
+            sql += ",";
+        sql += sql_be->quote_string (std::string(1, *c));
+    }
+    sql += ")";
+    return true;
+}
 
-        if (strcmp (pPredData->type_name, QOF_TYPE_NUMERIC) == 0)
-        {
-            query_numeric_t pData = (query_numeric_t)pPredData;
-            sql << gnc_numeric_to_double (pData->amount);
-        }
-        else if (g_strcmp0 (pPredData->type_name, QOF_TYPE_DATE) == 0)
-        {
-            query_date_t date_data = (query_date_t)pPredData;
+/**
+ * Translate a query term into a SQL condition satisfied by every split
+ * matching the term.
+ *
+ * @param sql_be SQL backend, used to quote strings
+ * @param term The query term
+ * @param sql Set to the condition
+ * @param uses_tx Set to true if the condition refers to the transactions
+ * table
+ * @return false if the term can't be translated
+ */
+static bool
+split_query_term_to_sql (GncSqlBackend* sql_be, QofQueryTerm* term,
+                         std::string& sql, bool& uses_tx)
+{
+    if (qof_query_term_is_inverted (term))
+        return false;
+    auto col = find_split_query_column (term);
+    if (col == nullptr)
+        return false;
+
+    auto pdata = qof_query_term_get_pred_data (term);
+    bool ok = false;
+    if (g_strcmp0 (col->pred_type, QOF_TYPE_GUID) == 0)
+        ok = guid_term_to_sql (col->column, (query_guid_t)pdata, sql);
+    else if (g_strcmp0 (col->pred_type, QOF_TYPE_DATE) == 0)
+        ok = date_term_to_sql (col->column, (query_date_t)pdata, sql);
+    else if (g_strcmp0 (col->pred_type, QOF_TYPE_NUMERIC) == 0)
+        ok = numeric_term_to_sql (col->column, (query_numeric_t)pdata, sql);
+    else if (g_strcmp0 (col->pred_type, QOF_TYPE_STRING) == 0)
+        ok = string_term_to_sql (sql_be, col->column, (query_string_t)pdata,
+                                 sql);
+    else if (g_strcmp0 (col->pred_type, QOF_TYPE_CHAR) == 0)
+        ok = char_term_to_sql (sql_be, col->column, (query_char_t)pdata, sql);
+    if (ok && g_str_has_prefix (col->column, "t."))
+        uses_tx = true;
+    return ok;
+}
 
-            GncDateTime time(date_data->date);
-            sql << time.format_iso8601();
-        }
-        else if (strcmp (pPredData->type_name, QOF_TYPE_INT32) == 0)
-        {
-            query_int32_t pData = (query_int32_t)pPredData;
-            sql << pData->val;
-        }
-        else if (strcmp (pPredData->type_name, QOF_TYPE_INT64) == 0)
-        {
-            query_int64_t pData = (query_int64_t)pPredData;
-            sql << pData->val;
-        }
-        else if (strcmp (pPredData->type_name, QOF_TYPE_DOUBLE) == 0)
-        {
-            query_double_t pData = (query_double_t)pPredData;
-            sql << pData->val;
-        }
-        else if (strcmp (pPredData->type_name, QOF_TYPE_BOOLEAN) == 0)
-        {
-            query_boolean_t pData = (query_boolean_t)pPredData;
-            sql << pData->val;
-        }
-        else
+std::string
+gnc_sql_split_query_to_sql (GncSqlBackend* sql_be, QofQuery* query)
+{
+    g_return_val_if_fail (sql_be != nullptr, "");
+    g_return_val_if_fail (query != nullptr, "");
+
+    std::string where;
+    bool uses_tx = false;
+    for (auto or_node = qof_query_get_terms (query); or_node;
+         or_node = or_node->next)
+    {
+        std::string conds;
+        for (auto and_node = static_cast<GList*>(or_node->data); and_node;
+             and_node = and_node->next)
         {
-            PERR ("Unknown query predicate type: %s\n", pPredData->type_name);
+            std::string cond;
+            if (!split_query_term_to_sql (sql_be,
+                                          static_cast<QofQueryTerm*>(and_node->data),
+                                          cond, uses_tx))
+                continue;
+            if (!conds.empty())
+                conds += " AND ";
+            conds += cond;
         }
-
-        sql << ")";
+        /* A group without any conditions matches every split. */
+        if (conds.empty())
+            return "";
+        if (!where.empty())
+            where += " OR ";
+        where += "(" + conds + ")";
     }
+    if (where.empty())
+        return "";
+
+    std::string sql{"SELECT s.guid AS guid FROM " SPLIT_TABLE " s"};
+    if (uses_tx)
+        sql += " INNER JOIN " TRANSACTION_TABLE " t ON t.guid = s.tx_guid";
+    return sql + " WHERE " + where;
 }
 
-typedef struct
+bool
+gnc_sql_split_query_candidates (GncSqlBackend* sql_be, QofQuery* query,
+                                GList** candidates)
 {
-    GncSqlStatementPtr stmt;
-    gboolean has_been_run;
-} split_query_info_t;
+    g_return_val_if_fail (sql_be != nullptr, false);
+    g_return_val_if_fail (candidates != nullptr, false);
+
+    auto sql = gnc_sql_split_query_to_sql (sql_be, query);
+    if (sql.empty())
+        return false;
+    DEBUG ("Selecting candidates with %s", sql.c_str());
+
+    auto stmt = sql_be->create_statement_from_sql (sql);
+    if (stmt == nullptr)
+        return false;
+    auto result = sql_be->execute_select_statement (stmt);
+    if (result == nullptr)
+        return false;
+
+    GList* splits = nullptr;
+    for (auto row : *result)
+    {
+        try
+        {
+            GncGUID guid;
+            auto val = row.get_string_at_col ("guid");
+            if (!string_to_guid (val.c_str(), &guid))
+                continue;
+            auto split = xaccSplitLookup (&guid, sql_be->book());
+            if (split != nullptr)
+                splits = g_list_prepend (splits, split);
+        }
+        catch (std::invalid_argument&) {}
+    }
+    *candidates = splits;
+    return true;
+}
 
 /* ----------------------------------------------------------------- */
 typedef struct
@@ -35,11 +35,15 @@ extern "C"
 #include "qof.h"
 #include "Account.h"
 }
+#include <string>
+
 class GncSqlTransBackend : public GncSqlObjectBackend
 {
 public:
     GncSqlTransBackend();
     void load_all(GncSqlBackend*) override;
+    std::vector<std::string> load_statements() const override;
+    bool load_changed(GncSqlBackend*, const std::vector<GncGUID>&) override;
     void create_tables(GncSqlBackend*) override;
     bool commit (GncSqlBackend* sql_be, QofInstance* inst) override;
 };
@@ -61,6 +65,30 @@ public:
  */
 void gnc_sql_transaction_load_tx_for_account (GncSqlBackend* sql_be,
                                               Account* account);
+/**
+ * Translate a split query into a SELECT of the guids of every split that
+ * could match it. Terms that can't be translated are ignored, so the
+ * result is a superset of the matches and still has to be checked against
+ * the query.
+ *
+ * @param sql_be SQL backend
+ * @param query The query, searching for splits
+ * @return The SQL statement, or an empty string if the terms that could be
+ * translated don't restrict the splits at all.
+ */
+std::string gnc_sql_split_query_to_sql (GncSqlBackend* sql_be, QofQuery* query);
+
+/**
+ * Select the splits that could match a split query from the database.
+ *
+ * @param sql_be SQL backend
+ * @param query The query, searching for splits
+ * @param candidates Set to a list of the splits, owned by the caller
+ * @return false if the query couldn't be translated usefully or the
+ * database query failed.
+ */
+bool gnc_sql_split_query_candidates (GncSqlBackend* sql_be, QofQuery* query,
+                                     GList** candidates);
 typedef struct
 {
     Account* acct;
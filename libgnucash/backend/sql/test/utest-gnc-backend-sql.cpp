@@ -26,11 +26,22 @@ extern "C"
 #include <string.h>
 #include <glib.h>
 #include <unittest-support.h>
+#include <Query.h>
+#include <Transaction.h>
+#include <Split.h>
+#include <gnc-lot.h>
 }
 /* Add specific headers for this class */
 #include "../gnc-sql-connection.hpp"
 #include "../gnc-sql-backend.hpp"
 #include "../gnc-sql-result.hpp"
+#include "../gnc-sql-write-queue.hpp"
+#include "../gnc-sql-read-ahead.hpp"
+#include "../gnc-sql-object-backend.hpp"
+#include "../gnc-transaction-sql.h"
+#include "../gnc-change-log-sql.h"
+#include <algorithm>
+#include <fstream>
 
 static const gchar* suitename = "/backend/sql/gnc-backend-sql";
 void test_suite_gnc_backend_sql (void);
@@ -337,6 +348,229 @@ test_gnc_sql_commit_edit (void)
     g_object_unref (book);
     delete sql_be;
 }
+class GncMockSqlTextStatement : public GncSqlStatement
+{
+public:
+    GncMockSqlTextStatement(const std::string& sql) : m_sql{sql} {}
+    const char* to_sql() const { return m_sql.c_str(); }
+    void add_where_cond (QofIdTypeConst, const PairVec&) {}
+private:
+    std::string m_sql;
+};
+
+/* Records the statements it executes; "FAIL" fails. */
+class GncRecordingSqlConnection : public GncMockSqlConnection
+{
+public:
+    int execute_nonselect_statement (const GncSqlStatementPtr& stmt)
+        noexcept override
+    {
+        m_executed.push_back (stmt->to_sql());
+        return m_executed.back() == "FAIL" ? -1 : 1;
+    }
+    GncSqlStatementPtr create_statement_from_sql (const std::string& sql)
+        const noexcept override {
+        return GncSqlStatementPtr{new GncMockSqlTextStatement{sql}}; }
+    bool rollback_transaction () noexcept override { ++m_rollbacks; return true; }
+    bool commit_transaction () noexcept override { ++m_commits; return true; }
+    StatementVec m_executed;
+    int m_commits = 0;
+    int m_rollbacks = 0;
+};
+
+static void
+test_gnc_sql_write_queue (void)
+{
+    GncRecordingSqlConnection conn;
+    auto journal = g_build_filename (g_get_tmp_dir (), "test-sql-write-queue.journal",
+                                     nullptr);
+    InstanceRef inst1, inst2, inst3, inst4;
+    for (auto inst : {&inst1, &inst2, &inst3, &inst4})
+    {
+        inst->first = GNC_ID_TRANS;
+        guid_replace (&inst->second);
+    }
+    {
+        GncSqlWriteQueue queue{&conn, journal};
+        {
+            /* Hold the writer up so that the updates are still queued. */
+            std::lock_guard<std::mutex> lock{queue.connection_mutex()};
+            queue.enqueue (inst1, false, {"insert 1"});
+            queue.enqueue (inst2, true, {"update 2", "slots 2"});
+            queue.enqueue (inst1, true, {"update 1"});
+            queue.enqueue (inst2, true, {"update 2 again"});
+        }
+        g_assert_cmpint (queue.flush(), ==, ERR_BACKEND_NO_ERR);
+        g_assert_cmpint (conn.m_commits, ==, 3);
+        g_assert_true ((conn.m_executed ==
+                        StatementVec{"insert 1", "update 1", "update 2 again"}));
+        std::ifstream drained{journal};
+        g_assert_true (drained.peek() == std::ifstream::traits_type::eof());
+        drained.close();
+
+        InstanceRefVec failed;
+        queue.enqueue (inst3, false, {"insert 3", "FAIL"});
+        queue.enqueue (inst4, true, {"update 4", "FAIL"});
+        g_assert_cmpint (queue.flush(&failed), ==, ERR_BACKEND_SERVER_ERR);
+        g_assert_cmpint (conn.m_rollbacks, ==, 2);
+        g_assert_cmpuint (failed.size(), ==, 2);
+        g_assert_true (guid_equal (&failed[0].second, &inst3.second));
+        g_assert_true (guid_equal (&failed[1].second, &inst4.second));
+        g_assert_cmpint (queue.flush(), ==, ERR_BACKEND_NO_ERR);
+
+        /* Committed units leave the journal, a later update of an instance
+         * supersedes its failed update. */
+        queue.enqueue (inst1, true, {"update 1 again"});
+        queue.enqueue (inst4, true, {"update 4 again"});
+        g_assert_cmpint (queue.flush(), ==, ERR_BACKEND_NO_ERR);
+    }
+    /* Only the failed unit is kept for the next session. */
+    GncRecordingSqlConnection replay_conn;
+    g_assert_cmpuint (GncSqlWriteQueue::replay_journal (&replay_conn, journal),
+                      ==, 0);
+    g_assert_true ((replay_conn.m_executed == StatementVec{"insert 3", "FAIL"}));
+    g_assert_false (g_file_test (journal, G_FILE_TEST_EXISTS));
+
+    /* A unit cut short by a crash isn't replayed. */
+    std::ofstream crashed{journal, std::ios::binary};
+    crashed << "unit 2\n10 insert\n'a'\n8 update 4\nend\nunit 1\n8 upd";
+    crashed.close();
+    GncRecordingSqlConnection replay_conn2;
+    g_assert_cmpuint (GncSqlWriteQueue::replay_journal (&replay_conn2, journal),
+                      ==, 1);
+    g_assert_true ((replay_conn2.m_executed ==
+                    StatementVec{"insert\n'a'", "update 4"}));
+    g_assert_false (g_file_test (journal, G_FILE_TEST_EXISTS));
+    g_free (journal);
+}
+
+/* A reader for GncSqlReadAhead; records the SELECTs it executes and the end
+ * of its thread as "END", "FAIL" fails. */
+class GncMockSqlReader : public GncRecordingSqlConnection
+{
+public:
+    GncMockSqlReader(StatementVec* selects, std::mutex* mutex) :
+        m_selects{selects}, m_mutex{mutex} {}
+    GncSqlResultPtr execute_select_statement (const GncSqlStatementPtr& stmt)
+        noexcept override
+    {
+        std::string sql{stmt->to_sql()};
+        {
+            std::lock_guard<std::mutex> lock{*m_mutex};
+            m_selects->push_back (sql);
+        }
+        if (sql == "FAIL")
+            return nullptr;
+        return new GncMockSqlResult{this};
+    }
+    void end_thread() noexcept override
+    {
+        std::lock_guard<std::mutex> lock{*m_mutex};
+        m_selects->push_back ("END");
+    }
+private:
+    StatementVec* m_selects;
+    std::mutex* m_mutex;
+};
+
+static void
+test_gnc_sql_read_ahead (void)
+{
+    StatementVec selects;
+    std::mutex mutex;
+    {
+        GncSqlReadAhead read_ahead{
+            std::vector<GncSqlConnection*>{
+                new GncMockSqlReader{&selects, &mutex},
+                new GncMockSqlReader{&selects, &mutex}},
+            StatementVec{"SELECT 1", "FAIL", "SELECT 2", "SELECT 1",
+                         "SELECT 3"}};
+        auto result2 = read_ahead.take ("SELECT 2");
+        g_assert_nonnull (result2);
+        g_assert_cmpuint (result2->size(), ==, 1);
+        delete result2;
+        /* The caller executes failed and unknown statements itself. */
+        g_assert_null (read_ahead.take ("FAIL"));
+        g_assert_null (read_ahead.take ("SELECT 4"));
+        /* Each result is handed out once. */
+        auto result1 = read_ahead.take ("SELECT 1");
+        auto result1b = read_ahead.take ("SELECT 1");
+        g_assert_nonnull (result1);
+        g_assert_nonnull (result1b);
+        g_assert_true (result1 != result1b);
+        g_assert_null (read_ahead.take ("SELECT 1"));
+        delete result1;
+        delete result1b;
+        /* "SELECT 3" is skipped or freed with read_ahead. */
+    }
+    g_assert_cmpint (std::count (selects.begin(), selects.end(), "SELECT 1"),
+                     ==, 2);
+    g_assert_cmpint (std::count (selects.begin(), selects.end(), "FAIL"),
+                     ==, 1);
+    g_assert_cmpint (std::count (selects.begin(), selects.end(), "SELECT 4"),
+                     ==, 0);
+    /* Each reader's thread ends once, after its last statement. */
+    g_assert_cmpint (std::count (selects.begin(), selects.end(), "END"), ==, 2);
+    g_assert_cmpstr (selects.back().c_str(), ==, "END");
+}
+
+static void
+test_gnc_sql_change_log (void)
+{
+    GncRecordingSqlConnection conn;
+    auto sql_be = new GncMockSqlBackend (&conn, nullptr);
+    GncGUID guid;
+    gchar guid_buf[GUID_ENCODING_LENGTH + 1];
+    guid_replace (&guid);
+    guid_to_string_buff (&guid, guid_buf);
+
+    g_assert_true (gnc_sql_change_log_append (sql_be,
+                                              "0123456789abcdef0123456789abcdef",
+                                              GNC_ID_TRANS, &guid,
+                                              OP_DB_DELETE));
+    std::string expected{"INSERT INTO changes (session, obj_type, obj_guid, "
+                         "operation) VALUES "
+                         "('0123456789abcdef0123456789abcdef', 'Trans', '"};
+    expected += guid_buf;
+    expected += "', 2)";
+    g_assert_cmpuint (conn.m_executed.size(), ==, 1);
+    g_assert_cmpstr (conn.m_executed[0].c_str(), ==, expected.c_str());
+
+    /* Without a change log the backend has nothing to poll. */
+    g_assert_false (sql_be->change_log());
+    g_assert_false (sql_be->events_pending());
+    g_assert_false (sql_be->process_events());
+    delete sql_be;
+}
+
+static void
+test_gnc_sql_bulk_write (void)
+{
+    GncRecordingSqlConnection conn;
+    qof_object_initialize ();
+    auto book = qof_book_new ();
+    auto sql_be = new GncMockSqlBackend (&conn, book);
+    auto tx = xaccMallocTransaction (book);
+    auto split = xaccMallocSplit (book);
+    auto lot = gnc_lot_new (book);
+    xaccTransBeginEdit (tx);
+    xaccSplitSetParent (split, tx);
+    xaccSplitSetLot (split, lot);
+
+    /* Only transactions are written piecemeal, and not those in lots. */
+    g_assert_false (sql_be->bulk_write (QOF_INSTANCE (lot)));
+    g_assert_false (sql_be->bulk_write (QOF_INSTANCE (tx)));
+    g_assert_true (conn.m_executed.empty ());
+
+    /* Abandoning the copy rolls back without reporting an error of its own. */
+    sql_be->end_bulk_write (false);
+    g_assert_cmpint (conn.m_rollbacks, ==, 1);
+    g_assert_cmpint (conn.m_commits, ==, 0);
+    g_assert_false (sql_be->check_error ());
+    delete sql_be;
+    g_object_unref (book);
+}
+
 /* handle_and_term
 static void
 handle_and_term (QofQueryTerm* pTerm, GString* sql)// 2
@@ -370,15 +604,59 @@ convert_search_obj (QofIdType objType)// 3
 test_convert_search_obj (Fixture *fixture, gconstpointer pData)
 {
 }*/
-// Make Static
-/* gnc_sql_compile_query_to_sql
-gchar*
-gnc_sql_compile_query_to_sql (GncSqlBackend* sql_be, QofQuery* query)// 3
+/* gnc_sql_split_query_to_sql
+std::string
+gnc_sql_split_query_to_sql (GncSqlBackend* sql_be, QofQuery* query)
 */
-/* static void
-test_gnc_sql_compile_query_to_sql (Fixture *fixture, gconstpointer pData)
+static void
+test_gnc_sql_split_query_to_sql (void)
 {
-}*/
+    GncMockSqlConnection conn;
+    qof_object_initialize ();
+    auto book = qof_book_new ();
+    auto sql_be = new GncMockSqlBackend (&conn, book);
+    GncGUID acct_guid;
+    gchar acct_buf[GUID_ENCODING_LENGTH + 1];
+    guid_replace (&acct_guid);
+    guid_to_string_buff (&acct_guid, acct_buf);
+
+    auto q = qof_query_create_for (GNC_ID_SPLIT);
+    g_assert_true (gnc_sql_split_query_to_sql (sql_be, q).empty ());
+
+    auto guids = g_list_prepend (nullptr, &acct_guid);
+    xaccQueryAddAccountGUIDMatch (q, guids, QOF_GUID_MATCH_ANY, QOF_QUERY_AND);
+    g_list_free (guids);
+    xaccQueryAddDateMatchTT (q, TRUE, 0, FALSE, 0, QOF_QUERY_AND);
+    xaccQueryAddDescriptionMatch (q, "50%", TRUE, FALSE, QOF_COMPARE_CONTAINS,
+                                  QOF_QUERY_AND);
+    /* Case-insensitive matches are left to the engine. */
+    xaccQueryAddMemoMatch (q, "rent", FALSE, FALSE, QOF_COMPARE_CONTAINS,
+                           QOF_QUERY_AND);
+    xaccQueryAddClearedMatch (q, static_cast<cleared_match_t>
+                              (CLEARED_CLEARED | CLEARED_RECONCILED),
+                              QOF_QUERY_AND);
+    auto expected = std::string{"SELECT s.guid AS guid FROM splits s "
+        "INNER JOIN transactions t ON t.guid = s.tx_guid WHERE "
+        "(s.account_guid IN ('"} + acct_buf + "') AND "
+        "(t.post_date IS NULL OR t.post_date >= '1970-01-01 00:00:00') AND "
+        "t.description LIKE %50!%% ESCAPE '!' AND "
+        "s.reconcile_state IN (c,y))";
+    g_assert_cmpstr (gnc_sql_split_query_to_sql (sql_be, q).c_str (), ==,
+                     expected.c_str ());
+
+    /* An OR group that can't be translated matches any split. */
+    auto q2 = qof_query_create_for (GNC_ID_SPLIT);
+    xaccQueryAddMemoMatch (q2, "rent", FALSE, FALSE, QOF_COMPARE_CONTAINS,
+                           QOF_QUERY_AND);
+    auto q3 = qof_query_merge (q, q2, QOF_QUERY_OR);
+    g_assert_true (gnc_sql_split_query_to_sql (sql_be, q3).empty ());
+
+    qof_query_destroy (q3);
+    qof_query_destroy (q2);
+    qof_query_destroy (q);
+    delete sql_be;
+    qof_book_destroy (book);
+}
 /* free_query_cb
 static void
 free_query_cb (const gchar* type, gpointer data_p, gpointer be_data_p)// 2
@@ -857,11 +1135,15 @@ test_suite_gnc_backend_sql (void)
 // GNC_TEST_ADD (suitename, "gnc sql rollback edit", Fixture, nullptr, test_gnc_sql_rollback_edit,  teardown);
 // GNC_TEST_ADD (suitename, "commit cb", Fixture, nullptr, test_commit_cb,  teardown);
     GNC_TEST_ADD_FUNC (suitename, "gnc sql commit edit", test_gnc_sql_commit_edit);
+    GNC_TEST_ADD_FUNC (suitename, "gnc sql write queue", test_gnc_sql_write_queue);
+    GNC_TEST_ADD_FUNC (suitename, "gnc sql read ahead", test_gnc_sql_read_ahead);
+    GNC_TEST_ADD_FUNC (suitename, "gnc sql change log", test_gnc_sql_change_log);
+    GNC_TEST_ADD_FUNC (suitename, "gnc sql bulk write", test_gnc_sql_bulk_write);
 // GNC_TEST_ADD (suitename, "handle and term", Fixture, nullptr, test_handle_and_term,  teardown);
 // GNC_TEST_ADD (suitename, "compile query cb", Fixture, nullptr, test_compile_query_cb,  teardown);
 // GNC_TEST_ADD (suitename, "gnc sql compile query", Fixture, nullptr, test_gnc_sql_compile_query,  teardown);
 // GNC_TEST_ADD (suitename, "convert search obj", Fixture, nullptr, test_convert_search_obj,  teardown);
-// GNC_TEST_ADD (suitename, "gnc sql compile query to sql", Fixture, nullptr, test_gnc_sql_compile_query_to_sql,  teardown);
+    GNC_TEST_ADD_FUNC (suitename, "gnc sql split query to sql", test_gnc_sql_split_query_to_sql);
 // GNC_TEST_ADD (suitename, "free query cb", Fixture, nullptr, test_free_query_cb,  teardown);
 // GNC_TEST_ADD (suitename, "gnc sql free query", Fixture, nullptr, test_gnc_sql_free_query,  teardown);
 // GNC_TEST_ADD (suitename, "run query cb", Fixture, nullptr, test_run_query_cb,  teardown);
@@ -291,6 +291,14 @@ GncXmlBackend::load(QofBook* book, QofBackendLoadType loadType)
     qof_book_mark_session_saved (book);
 }
 
+void
+GncXmlBackend::load_streaming(QofBook* book, const QofBackendSink& sink)
+{
+    m_sink = &sink;
+    load (book, LOAD_TYPE_INITIAL_LOAD);
+    m_sink = nullptr;
+}
+
 void
 GncXmlBackend::sync(QofBook* book)
 {
@@ -39,6 +39,7 @@ public:
                        SessionOpenMode mode) override;
     void session_end() override;
     void load(QofBook* book, QofBackendLoadType loadType) override;
+    void load_streaming(QofBook* book, const QofBackendSink& sink) override;
     /* The XML backend isn't able to do anything with individual instances. */
     void export_coa(QofBook*) override;
     void sync(QofBook* book) override;
@@ -46,6 +47,7 @@ public:
     void commit(QofInstance* instance) override;
     const char * get_filename() { return m_fullpath.c_str(); }
     QofBook* get_book() { return m_book; }
+    const QofBackendSink* get_sink() { return m_sink; }
 
 private:
     bool save_may_clobber_data();
@@ -63,5 +65,6 @@ private:
     int m_lockfd;
 
     QofBook* m_book = nullptr;  /* The primary, main open book */
+    const QofBackendSink* m_sink = nullptr;
 };
 #endif // __GNC_XML_BACKEND_HPP__
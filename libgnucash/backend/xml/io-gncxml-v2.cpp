@@ -301,6 +301,27 @@ add_transaction_local (sixtp_gdv2* data, Transaction* trn)
     return TRUE;
 }
 
+/* Hand a transaction that has just been read to the backend the book is
+ * being streamed to. Once it's written it's dropped so that the book never
+ * holds more than the transactions the sink couldn't take yet.
+ */
+static void
+stream_transaction (sixtp_gdv2* data, Transaction* trn)
+{
+    /* The transaction won't be there for the account tree scrubs after
+     * loading, so give it the same currency and split scrubs now. */
+    xaccTransScrubCurrency (trn);
+    xaccTransScrubSplits (trn);
+    if (!(*data->sink) (QOF_INSTANCE (trn)))
+        return;
+
+    /* Like xaccTransDestroy() but regardless of the transaction being
+     * read-only: it isn't deleted, only not kept. */
+    xaccTransBeginEdit (trn);
+    qof_instance_set_destroying (trn, TRUE);
+    xaccTransCommitEdit (trn);
+}
+
 static gboolean
 add_schedXaction_local (sixtp_gdv2* data, SchedXaction* sx)
 {
@@ -583,6 +604,8 @@ book_callback (const char* tag, gpointer globaldata, gpointer data)
     else if (g_strcmp0 (tag, TRANSACTION_TAG) == 0)
     {
         add_transaction_local (gd, (Transaction*)data);
+        if (gd->sink)
+            stream_transaction (gd, (Transaction*)data);
     }
     else if (g_strcmp0 (tag, SCHEDXACTION_TAG) == 0)
     {
@@ -708,6 +731,7 @@ qof_session_load_from_xml_file_v2_full (
 
     gd = gnc_sixtp_gdv2_new (book, FALSE, file_rw_feedback,
                              xml_be->get_percentage());
+    gd->sink = xml_be->get_sink ();
 
     top_parser = sixtp_new ();
     main_parser = sixtp_new ();
@@ -31,6 +31,7 @@ extern "C"
 #include <stdarg.h>
 #include "gnc-engine.h"
 }
+#include <qof-backend.hpp>
 #include "gnc-xml-helper.h"
 #include "gnc-backend-xml.h"
 
@@ -68,6 +69,7 @@ struct sixtp_gdv2
     countCallbackFn countCallback;
     QofBePercentageFunc gui_display_fn;
     gboolean exporting;
+    const QofBackendSink* sink; /* Set when streaming the book elsewhere. */
 };
 typedef struct _sixtp_child_result sixtp_child_result;
 
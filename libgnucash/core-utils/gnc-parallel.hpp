@@ -0,0 +1,103 @@
+/********************************************************************\
+ * gnc-parallel.hpp -- run independent work items on several threads*
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+#ifndef GNC_PARALLEL_HPP
+#define GNC_PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** Below this many items gnc_parallel_for doesn't bother starting threads. */
+constexpr size_t GNC_PARALLEL_MIN_ITEMS = 1024;
+
+/** Call func(i) for every i in [0, count), spreading the calls over the
+ *  available hardware threads.
+ *
+ *  The calls must be independent of each other: func may be called
+ *  concurrently for different indexes and in any order. Small inputs are
+ *  processed on the calling thread.
+ *
+ *  If any call throws, the remaining work is abandoned and the first
+ *  exception is rethrown on the calling thread once all workers are done.
+ *
+ *  @param count The number of work items.
+ *  @param func A callable taking a size_t index.
+ */
+template <typename Func> void
+gnc_parallel_for (size_t count, Func&& func)
+{
+    auto n_threads = std::min<size_t> (std::thread::hardware_concurrency(),
+                                       count / GNC_PARALLEL_MIN_ITEMS);
+    if (n_threads < 2)
+    {
+        for (size_t i = 0; i < count; ++i)
+            func (i);
+        return;
+    }
+
+    /* Hand out the items in chunks so that uneven work per item still
+     * keeps all threads busy without contending on every item. */
+    const size_t chunk = std::max<size_t> (count / (n_threads * 8), 1);
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto worker = [&]()
+    {
+        while (!failed)
+        {
+            auto begin = next.fetch_add (chunk);
+            if (begin >= count)
+                break;
+            auto end = std::min (begin + chunk, count);
+            try
+            {
+                for (auto i = begin; i < end; ++i)
+                    func (i);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock (error_mutex);
+                if (!error)
+                    error = std::current_exception();
+                failed = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve (n_threads - 1);
+    for (size_t t = 1; t < n_threads; ++t)
+        threads.emplace_back (worker);
+    worker ();
+    for (auto& thread : threads)
+        thread.join();
+
+    if (error)
+        std::rethrow_exception (error);
+}
+
+#endif /* GNC_PARALLEL_HPP */
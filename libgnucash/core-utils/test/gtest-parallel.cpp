@@ -0,0 +1,57 @@
+/********************************************************************\
+ * gtest-parallel.cpp -- unit tests for gnc_parallel_for            *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+#include <gnc-parallel.hpp>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+TEST(GncParallelFor, visits_every_index_once)
+{
+    const size_t count = GNC_PARALLEL_MIN_ITEMS * 16 + 7;
+    std::vector<int> visits (count, 0);
+    gnc_parallel_for (count, [&visits](size_t i) { ++visits[i]; });
+    EXPECT_EQ (count, static_cast<size_t>(std::accumulate (visits.begin(), visits.end(), 0)));
+    EXPECT_EQ (visits.end(), std::find_if (visits.begin(), visits.end(),
+                                           [](int v) { return v != 1; }));
+}
+
+TEST(GncParallelFor, small_input)
+{
+    std::vector<size_t> order;
+    gnc_parallel_for (5, [&order](size_t i) { order.push_back (i); });
+    EXPECT_EQ ((std::vector<size_t>{0, 1, 2, 3, 4}), order);
+    gnc_parallel_for (0, [](size_t) { FAIL(); });
+}
+
+TEST(GncParallelFor, rethrows)
+{
+    const size_t count = GNC_PARALLEL_MIN_ITEMS * 16;
+    EXPECT_THROW (gnc_parallel_for (count, [](size_t i)
+                                    {
+                                        if (i == 4711)
+                                            throw std::invalid_argument ("bad item");
+                                    }),
+                  std::invalid_argument);
+}
@@ -3855,6 +3855,80 @@ xaccAccountGetNoclosingBalanceAsOfDateInCurrency(
        report_commodity, include_children);
 }
 
+static void
+account_add_balances_as_of_dates (Account *acc, const time64 *dates,
+                                  size_t n_dates, gboolean ignore_closing,
+                                  gnc_commodity *report_commodity,
+                                  gnc_numeric *balances)
+{
+    auto priv = GET_PRIVATE(acc);
+    auto commodity = xaccAccountGetCommodity (acc);
+    auto fraction = gnc_commodity_get_fraction (report_commodity);
+    Split *latest = nullptr;
+    GList *node;
+    size_t i;
+
+    xaccAccountSortSplits (acc, TRUE); /* just in case, normally a noop */
+    xaccAccountRecomputeBalance (acc); /* just in case, normally a noop */
+
+    node = priv->splits;
+    for (i = 0; i < n_dates; i++)
+    {
+        gnc_numeric balance;
+
+        for (; node; node = node->next)
+        {
+            auto split = static_cast<Split*>(node->data);
+            if (xaccTransGetDate (xaccSplitGetParent (split)) > dates[i])
+                break;
+            latest = split;
+        }
+
+        if (!latest)
+            continue;
+
+        balance = ignore_closing ? xaccSplitGetNoclosingBalance (latest) :
+            xaccSplitGetBalance (latest);
+        balance = xaccAccountConvertBalanceToCurrencyAsOfDate
+            (acc, balance, commodity, report_commodity, dates[i]);
+        balances[i] = gnc_numeric_add (balances[i], balance, fraction,
+                                       GNC_HOW_RND_ROUND_HALF_UP);
+    }
+}
+
+void
+xaccAccountGetBalancesAsOfDates (Account *acc, const time64 *dates,
+                                 size_t n_dates, gboolean ignore_closing,
+                                 gnc_commodity *report_commodity,
+                                 gboolean include_children,
+                                 gnc_numeric *balances)
+{
+    g_return_if_fail (GNC_IS_ACCOUNT(acc));
+    g_return_if_fail (dates || !n_dates);
+    g_return_if_fail (balances || !n_dates);
+
+    for (size_t i = 0; i < n_dates; i++)
+        balances[i] = gnc_numeric_zero ();
+
+    if (!report_commodity)
+        report_commodity = xaccAccountGetCommodity (acc);
+    if (!report_commodity)
+        return;
+
+    account_add_balances_as_of_dates (acc, dates, n_dates, ignore_closing,
+                                      report_commodity, balances);
+
+    if (include_children)
+    {
+        auto descendants = gnc_account_get_descendants (acc);
+        for (auto node = descendants; node; node = node->next)
+            account_add_balances_as_of_dates (static_cast<Account*>(node->data),
+                                              dates, n_dates, ignore_closing,
+                                              report_commodity, balances);
+        g_list_free (descendants);
+    }
+}
+
 gnc_numeric
 xaccAccountGetBalanceChangeForPeriod (Account *acc, time64 t1, time64 t2,
                                       gboolean recurse)
@@ -621,6 +621,29 @@ gnc_numeric xaccAccountGetNoclosingBalanceChangeForPeriod (
 gnc_numeric xaccAccountGetBalanceChangeForPeriod (
     Account *acc, time64 date1, time64 date2, gboolean recurse);
 
+/** Get the balances of an account as of each of several dates, walking
+ *  its splits only once instead of once per date.
+ *
+ *  The balance as of a date includes the splits posted on or before it.
+ *  Each balance is converted into report_commodity with the price
+ *  nearest to its date.
+ *
+ *  @param acc The account.
+ *  @param dates The dates, sorted in increasing order.
+ *  @param n_dates The number of dates.
+ *  @param ignore_closing If TRUE, closing transactions are left out.
+ *  @param report_commodity The commodity of the balances. If NULL the
+ *  account's commodity is used.
+ *  @param include_children If TRUE, the balances of all descendants are
+ *  added in.
+ *  @param balances Array of n_dates values which receives the balances.
+ */
+void xaccAccountGetBalancesAsOfDates (Account *acc, const time64 *dates,
+                                      size_t n_dates, gboolean ignore_closing,
+                                      gnc_commodity *report_commodity,
+                                      gboolean include_children,
+                                      gnc_numeric *balances);
+
 /** @} */
 
 /** @name Account Children and Parents.
@@ -88,11 +88,13 @@ xaccAccountTreeScrubOrphans (Account *acc, QofPercentageFunc percentagefunc)
     if (abort_now)
         (percentagefunc)(NULL, -1.0);
 
+    QOF_TRACE_BEGIN ("scrub orphans");
     scrub_depth ++;
     xaccAccountScrubOrphans (acc, percentagefunc);
     gnc_account_foreach_descendant(acc,
                                    (AccountCb)xaccAccountScrubOrphans, percentagefunc);
     scrub_depth--;
+    QOF_TRACE_END ("scrub orphans");
 }
 
 static void
@@ -329,11 +331,13 @@ xaccAccountTreeScrubImbalance (Account *acc, QofPercentageFunc percentagefunc)
     if (abort_now)
         (percentagefunc)(NULL, -1.0);
 
+    QOF_TRACE_BEGIN ("scrub imbalance");
     scrub_depth++;
     xaccAccountScrubImbalance (acc, percentagefunc);
     gnc_account_foreach_descendant(acc,
                                    (AccountCb)xaccAccountScrubImbalance, percentagefunc);
     scrub_depth--;
+    QOF_TRACE_END ("scrub imbalance");
 }
 
 void
@@ -29,6 +29,12 @@
 #include <glib.h>
 #include <glib/gstdio.h>
 #include <string.h>
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>
+#endif
+#ifdef G_OS_WIN32
+# include <io.h>
+#endif
 
 #include "Account.h"
 #include "Transaction.h"
@@ -81,14 +87,49 @@ static QofLogModule log_module = "gnc.translog";
  * (-) hack alert -- something better than just the account name
  *     is needed for identifying the account.
  */
+/*
+ * xaccTransWriteLog only formats a record into memory and hands it
+ * to a writer thread through a small bounded queue, so that commits
+ * don't wait for the disk.  The writer writes and flushes whatever has piled up
+ * as soon as it can, so a crash of GnuCash itself loses at most the
+ * records still in the queue, and forces the file to disk (fsync) at
+ * most once per LOG_SYNC_INTERVAL, so a burst of commits shares one
+ * sync instead of paying for one each.
+ *
+ * The optional binary format (see xaccLogSetBinary) writes the same
+ * fields without any text conversion.  After BINARY_LOG_MAGIC each
+ * record is a little-endian guint32 byte count followed by:
+ *   flag (1 byte), trans guid (16 bytes), time_now, date_entered,
+ *   date_posted (gint64 each), num, description, notes (strings),
+ *   split count (guint32) and then per split:
+ *   split guid, account guid (16 bytes each, the account's is all zero
+ *   when it has none), acc_name, memo, action (strings), reconciled
+ *   (1 byte), amount num/denom, value num/denom and date_reconciled
+ *   (gint64 each).
+ * Strings are a guint32 byte count followed by the bytes, without a
+ * terminating nul.  xaccLogConvertToText turns it back into the text
+ * format.
+ */
 /* ------------------------------------------------------------------ */
 
+#define BINARY_LOG_MAGIC "GnuCash binary transaction log 1\n"
+#define LOG_QUEUE_MAX 256
+#define LOG_SYNC_INTERVAL G_TIME_SPAN_SECOND
 
 static int gen_logs = 1;
+static gboolean binary_logs = FALSE;
 static FILE * trans_log = NULL; /**< current log file handle */
 static char * trans_log_name = NULL; /**< current log file name */
 static char * log_base_name = NULL;
 
+/* The writer thread and its queue of formatted records. */
+static GThread *log_writer = NULL;
+static GMutex log_mutex;
+static GCond log_work;          /**< Signals the writer. */
+static GCond log_space;         /**< Signals a writer waiting for room. */
+static GQueue log_pending = G_QUEUE_INIT;  /**< GByteArray records */
+static gboolean log_stop = FALSE;
+
 /********************************************************************\
 \********************************************************************/
 
@@ -101,6 +142,25 @@ void xaccLogEnable  (void)
     gen_logs = 1;
 }
 
+/* GNC_BINARY_TRANSLOG only sets the default format. */
+static void
+init_log_format (void)
+{
+    static gboolean initialized = FALSE;
+    if (initialized) return;
+    initialized = TRUE;
+    binary_logs = g_getenv ("GNC_BINARY_TRANSLOG") != NULL;
+}
+
+void
+xaccLogSetBinary (gboolean binary)
+{
+    init_log_format ();
+    if (binary_logs == binary) return;
+    binary_logs = binary;
+    xaccReopenLog ();
+}
+
 /********************************************************************\
 \********************************************************************/
 
@@ -155,6 +215,102 @@ xaccFileIsCurrentLog (const gchar *name)
 /********************************************************************\
 \********************************************************************/
 
+static void
+sync_log (FILE *file)
+{
+    int fd = fileno (file);
+#ifdef G_OS_WIN32
+    if (_commit (fd) != 0)
+#else
+    if (fsync (fd) != 0)
+#endif
+        PWARN ("Failed to sync the transaction log: %s", g_strerror (errno));
+}
+
+/* Write whatever is queued, flushing after each batch and syncing at
+ * most once per LOG_SYNC_INTERVAL or when stopping. */
+static gpointer
+log_writer_thread (gpointer data)
+{
+    FILE *file = data;
+    gint64 last_sync = g_get_monotonic_time ();
+    gboolean dirty = FALSE;
+
+    g_mutex_lock (&log_mutex);
+    while (TRUE)
+    {
+        GQueue batch;
+        GByteArray *record;
+
+        while (!log_stop && g_queue_is_empty (&log_pending))
+        {
+            if (!dirty)
+                g_cond_wait (&log_work, &log_mutex);
+            else if (!g_cond_wait_until (&log_work, &log_mutex,
+                                         last_sync + LOG_SYNC_INTERVAL))
+                break;
+        }
+        if (log_stop && g_queue_is_empty (&log_pending))
+            break;
+
+        /* Take the whole queue; this is the group in the group commit. */
+        batch = log_pending;
+        g_queue_init (&log_pending);
+        g_cond_broadcast (&log_space);
+        g_mutex_unlock (&log_mutex);
+
+        while ((record = g_queue_pop_head (&batch)))
+        {
+            if (fwrite (record->data, 1, record->len, file) != record->len)
+                PWARN ("Failed to write the transaction log: %s",
+                       g_strerror (errno));
+            g_byte_array_unref (record);
+        }
+        fflush (file);
+        dirty = TRUE;
+
+        if (g_get_monotonic_time () - last_sync >= LOG_SYNC_INTERVAL)
+        {
+            sync_log (file);
+            last_sync = g_get_monotonic_time ();
+            dirty = FALSE;
+        }
+        g_mutex_lock (&log_mutex);
+    }
+    g_mutex_unlock (&log_mutex);
+
+    if (dirty)
+        sync_log (file);
+    return NULL;
+}
+
+static void
+queue_record (GByteArray *record)
+{
+    g_mutex_lock (&log_mutex);
+    /* Don't let a bulk import run away from the disk. */
+    while (g_queue_get_length (&log_pending) >= LOG_QUEUE_MAX)
+        g_cond_wait (&log_space, &log_mutex);
+    g_queue_push_tail (&log_pending, record);
+    g_cond_signal (&log_work);
+    g_mutex_unlock (&log_mutex);
+}
+
+/********************************************************************\
+\********************************************************************/
+
+static void
+append_text_header (GString *str)
+{
+    /*  Note: this must match src/import-export/log-replay/gnc-log-replay.c */
+    g_string_append (str, "mod\ttrans_guid\tsplit_guid\ttime_now\t"
+                     "date_entered\tdate_posted\t"
+                     "acc_guid\tacc_name\tnum\tdescription\t"
+                     "notes\tmemo\taction\treconciled\t"
+                     "amount\tvalue\tdate_reconciled\n");
+    g_string_append (str, "-----------------\n");
+}
+
 void
 xaccOpenLog (void)
 {
@@ -169,13 +325,14 @@ xaccOpenLog (void)
     if (trans_log) return;
 
     if (!log_base_name) log_base_name = g_strdup ("translog");
+    init_log_format ();
 
     /* tag each filename with a timestamp */
     timestamp = gnc_date_timestamp ();
 
     filename = g_strconcat (log_base_name, ".", timestamp, ".log", NULL);
 
-    trans_log = g_fopen (filename, "a");
+    trans_log = g_fopen (filename, binary_logs ? "ab" : "a");
     if (!trans_log)
     {
         int norr = errno;
@@ -195,13 +352,21 @@ xaccOpenLog (void)
     g_free (filename);
     g_free (timestamp);
 
-    /*  Note: this must match src/import-export/log-replay/gnc-log-replay.c */
-    fprintf (trans_log, "mod\ttrans_guid\tsplit_guid\ttime_now\t"
-             "date_entered\tdate_posted\t"
-             "acc_guid\tacc_name\tnum\tdescription\t"
-             "notes\tmemo\taction\treconciled\t"
-             "amount\tvalue\tdate_reconciled\n");
-    fprintf (trans_log, "-----------------\n");
+    if (binary_logs)
+    {
+        fputs (BINARY_LOG_MAGIC, trans_log);
+    }
+    else
+    {
+        GString *header = g_string_new (NULL);
+        append_text_header (header);
+        fputs (header->str, trans_log);
+        g_string_free (header, TRUE);
+    }
+    fflush (trans_log);
+
+    log_stop = FALSE;
+    log_writer = g_thread_new ("gnc-translog", log_writer_thread, trans_log);
 }
 
 /********************************************************************\
@@ -211,7 +376,15 @@ void
 xaccCloseLog (void)
 {
     if (!trans_log) return;
-    fflush (trans_log);
+
+    /* Let the writer drain the queue and sync before closing. */
+    g_mutex_lock (&log_mutex);
+    log_stop = TRUE;
+    g_cond_signal (&log_work);
+    g_mutex_unlock (&log_mutex);
+    g_thread_join (log_writer);
+    log_writer = NULL;
+
     fclose (trans_log);
     trans_log = NULL;
 }
@@ -219,36 +392,61 @@ xaccCloseLog (void)
 /********************************************************************\
 \********************************************************************/
 
-void
-xaccTransWriteLog (Transaction *trans, char flag)
+static void
+append_text_split (GString *str, char flag, const char *trans_guid_str,
+                   const char *split_guid_str, const char *dnow,
+                   const char *dent, const char *dpost,
+                   const char *acc_guid_str, const char *accname,
+                   const char *num, const char *description,
+                   const char *notes, const char *memo, const char *action,
+                   char reconciled, gnc_numeric amt, gnc_numeric val,
+                   const char *drecn)
 {
+    /* use tab-separated fields */
+    g_string_append_printf (str,
+                            "%c\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t"
+                            "%s\t%s\t%s\t%s\t%c\t%" G_GINT64_FORMAT "/%" G_GINT64_FORMAT "\t%" G_GINT64_FORMAT "/%" G_GINT64_FORMAT "\t%s\n",
+                            flag,
+                            trans_guid_str, split_guid_str,  /* trans+split make up unique id */
+                            dnow, dent, dpost,
+                            acc_guid_str,
+                            accname ? accname : "",
+                            num ? num : "",
+                            description ? description : "",
+                            notes ? notes : "",
+                            memo ? memo : "",
+                            action ? action : "",
+                            reconciled,
+                            gnc_numeric_num(amt),
+                            gnc_numeric_denom(amt),
+                            gnc_numeric_num(val),
+                            gnc_numeric_denom(val),
+                            drecn);
+}
+
+static GByteArray *
+format_text_record (Transaction *trans, char flag)
+{
+    GString *str = g_string_sized_new (256);
     GList *node;
     char trans_guid_str[GUID_ENCODING_LENGTH + 1];
     char split_guid_str[GUID_ENCODING_LENGTH + 1];
     const char *trans_notes;
     char dnow[100], dent[100], dpost[100], drecn[100];
-
-    if (!gen_logs)
-    {
-         PINFO ("Attempt to write disabled transaction log");
-	 return;
-    }
-    if (!trans_log) return;
+    gsize len;
 
     gnc_time64_to_iso8601_buff (gnc_time(NULL), dnow);
     gnc_time64_to_iso8601_buff (trans->date_entered, dent);
     gnc_time64_to_iso8601_buff (trans->date_posted, dpost);
     guid_to_string_buff (xaccTransGetGUID(trans), trans_guid_str);
     trans_notes = xaccTransGetNotes(trans);
-    fprintf (trans_log, "===== START\n");
+    g_string_append (str, "===== START\n");
 
     for (node = trans->splits; node; node = node->next)
     {
-        time64 time;
         Split *split = node->data;
         const char * accname = "";
         char acc_guid_str[GUID_ENCODING_LENGTH + 1];
-        gnc_numeric amt, val;
 
         if (xaccSplitGetAccount(split))
         {
@@ -262,42 +460,301 @@ xaccTransWriteLog (Transaction *trans, char flag)
         }
 
         gnc_time64_to_iso8601_buff (split->date_reconciled, drecn);
-
         guid_to_string_buff (xaccSplitGetGUID(split), split_guid_str);
-        amt = xaccSplitGetAmount (split);
-        val = xaccSplitGetValue (split);
-
-        /* use tab-separated fields */
-        fprintf (trans_log,
-                 "%c\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t"
-                 "%s\t%s\t%s\t%s\t%c\t%" G_GINT64_FORMAT "/%" G_GINT64_FORMAT "\t%" G_GINT64_FORMAT "/%" G_GINT64_FORMAT "\t%s\n",
-                 flag,
-                 trans_guid_str, split_guid_str,  /* trans+split make up unique id */
-                 /* Note that the next three strings always exist,
-                 		* so we don't need to test them. */
-                 dnow,
-                 dent,
-                 dpost,
-                 acc_guid_str,
-                 accname ? accname : "",
-                 trans->num ? trans->num : "",
-                 trans->description ? trans->description : "",
-                 trans_notes ? trans_notes : "",
-                 split->memo ? split->memo : "",
-                 split->action ? split->action : "",
-                 split->reconciled,
-                 gnc_numeric_num(amt),
-                 gnc_numeric_denom(amt),
-                 gnc_numeric_num(val),
-                 gnc_numeric_denom(val),
-                 /* The next string always exists. No need to test it. */
-                 drecn);
+
+        append_text_split (str, flag, trans_guid_str, split_guid_str,
+                           dnow, dent, dpost, acc_guid_str, accname,
+                           trans->num, trans->description, trans_notes,
+                           split->memo, split->action, split->reconciled,
+                           xaccSplitGetAmount (split),
+                           xaccSplitGetValue (split), drecn);
     }
 
-    fprintf (trans_log, "===== END\n");
+    g_string_append (str, "===== END\n");
 
-    /* get data out to the disk */
-    fflush (trans_log);
+    len = str->len;
+    return g_byte_array_new_take ((guint8*)g_string_free (str, FALSE), len);
+}
+
+/********************************************************************\
+\********************************************************************/
+
+static void
+put_u32 (GByteArray *buf, guint32 val)
+{
+    val = GUINT32_TO_LE (val);
+    g_byte_array_append (buf, (const guint8*)&val, sizeof (val));
+}
+
+static void
+put_i64 (GByteArray *buf, gint64 val)
+{
+    val = GINT64_TO_LE (val);
+    g_byte_array_append (buf, (const guint8*)&val, sizeof (val));
+}
+
+static void
+put_guid (GByteArray *buf, const GncGUID *guid)
+{
+    static const GncGUID null_guid;
+    g_byte_array_append (buf, (guid ? guid : &null_guid)->reserved,
+                         GUID_DATA_SIZE);
+}
+
+static void
+put_str (GByteArray *buf, const char *str)
+{
+    guint32 len = str ? strlen (str) : 0;
+    put_u32 (buf, len);
+    if (len)
+        g_byte_array_append (buf, (const guint8*)str, len);
+}
+
+static GByteArray *
+format_binary_record (Transaction *trans, char flag)
+{
+    GByteArray *buf = g_byte_array_sized_new (256);
+    GList *node;
+    guint32 len;
+
+    put_u32 (buf, 0);           /* The record length, filled in below. */
+    g_byte_array_append (buf, (const guint8*)&flag, 1);
+    put_guid (buf, xaccTransGetGUID (trans));
+    put_i64 (buf, gnc_time (NULL));
+    put_i64 (buf, trans->date_entered);
+    put_i64 (buf, trans->date_posted);
+    put_str (buf, trans->num);
+    put_str (buf, trans->description);
+    put_str (buf, xaccTransGetNotes (trans));
+    put_u32 (buf, g_list_length (trans->splits));
+
+    for (node = trans->splits; node; node = node->next)
+    {
+        Split *split = node->data;
+        Account *acc = xaccSplitGetAccount (split);
+        gnc_numeric amt = xaccSplitGetAmount (split);
+        gnc_numeric val = xaccSplitGetValue (split);
+
+        put_guid (buf, xaccSplitGetGUID (split));
+        put_guid (buf, acc ? xaccAccountGetGUID (acc) : NULL);
+        put_str (buf, acc ? xaccAccountGetName (acc) : NULL);
+        put_str (buf, split->memo);
+        put_str (buf, split->action);
+        g_byte_array_append (buf, (const guint8*)&split->reconciled, 1);
+        put_i64 (buf, gnc_numeric_num (amt));
+        put_i64 (buf, gnc_numeric_denom (amt));
+        put_i64 (buf, gnc_numeric_num (val));
+        put_i64 (buf, gnc_numeric_denom (val));
+        put_i64 (buf, split->date_reconciled);
+    }
+
+    len = GUINT32_TO_LE (buf->len - sizeof (guint32));
+    memcpy (buf->data, &len, sizeof (len));
+    return buf;
+}
+
+void
+xaccTransWriteLog (Transaction *trans, char flag)
+{
+    if (!gen_logs)
+    {
+         PINFO ("Attempt to write disabled transaction log");
+	 return;
+    }
+    if (!trans_log) return;
+
+    /* The record has to be built now, the transaction keeps changing. */
+    queue_record (binary_logs ? format_binary_record (trans, flag) :
+                  format_text_record (trans, flag));
+}
+
+/********************************************************************\
+\********************************************************************/
+
+typedef struct
+{
+    const guint8 *pos;
+    const guint8 *end;
+    gboolean ok;
+} LogReader;
+
+static const guint8 *
+get_bytes (LogReader *reader, gsize len)
+{
+    const guint8 *bytes = reader->pos;
+    if (!reader->ok || (gsize)(reader->end - reader->pos) < len)
+    {
+        reader->ok = FALSE;
+        return NULL;
+    }
+    reader->pos += len;
+    return bytes;
+}
+
+static guint32
+get_u32 (LogReader *reader)
+{
+    guint32 val = 0;
+    const guint8 *bytes = get_bytes (reader, sizeof (val));
+    if (bytes)
+        memcpy (&val, bytes, sizeof (val));
+    return GUINT32_FROM_LE (val);
+}
+
+static gint64
+get_i64 (LogReader *reader)
+{
+    gint64 val = 0;
+    const guint8 *bytes = get_bytes (reader, sizeof (val));
+    if (bytes)
+        memcpy (&val, bytes, sizeof (val));
+    return GINT64_FROM_LE (val);
+}
+
+static char
+get_char (LogReader *reader)
+{
+    const guint8 *bytes = get_bytes (reader, 1);
+    return bytes ? (char)*bytes : '\0';
+}
+
+/* Read a guid as a string, leaving it empty for the null guid. */
+static void
+get_guid_str (LogReader *reader, char *str)
+{
+    GncGUID guid;
+    const guint8 *bytes = get_bytes (reader, GUID_DATA_SIZE);
+    str[0] = '\0';
+    if (!bytes)
+        return;
+    memcpy (guid.reserved, bytes, GUID_DATA_SIZE);
+    if (!guid_equal (&guid, guid_null ()))
+        guid_to_string_buff (&guid, str);
+}
+
+static char *
+get_str (LogReader *reader)
+{
+    guint32 len = get_u32 (reader);
+    const guint8 *bytes = get_bytes (reader, len);
+    return bytes ? g_strndup ((const char*)bytes, len) : NULL;
+}
+
+static gboolean
+binary_record_to_text (LogReader *reader, GString *out)
+{
+    char flag;
+    char trans_guid_str[GUID_ENCODING_LENGTH + 1];
+    char dnow[100], dent[100], dpost[100];
+    char *num, *description, *notes;
+    guint32 n_splits, i;
+
+    flag = get_char (reader);
+    get_guid_str (reader, trans_guid_str);
+    gnc_time64_to_iso8601_buff (get_i64 (reader), dnow);
+    gnc_time64_to_iso8601_buff (get_i64 (reader), dent);
+    gnc_time64_to_iso8601_buff (get_i64 (reader), dpost);
+    num = get_str (reader);
+    description = get_str (reader);
+    notes = get_str (reader);
+    n_splits = get_u32 (reader);
+
+    g_string_append (out, "===== START\n");
+    for (i = 0; i < n_splits && reader->ok; i++)
+    {
+        char split_guid_str[GUID_ENCODING_LENGTH + 1];
+        char acc_guid_str[GUID_ENCODING_LENGTH + 1];
+        char drecn[100];
+        char *accname, *memo, *action;
+        char reconciled;
+        gint64 amt_num, amt_denom, val_num, val_denom;
+
+        get_guid_str (reader, split_guid_str);
+        get_guid_str (reader, acc_guid_str);
+        accname = get_str (reader);
+        memo = get_str (reader);
+        action = get_str (reader);
+        reconciled = get_char (reader);
+        amt_num = get_i64 (reader);
+        amt_denom = get_i64 (reader);
+        val_num = get_i64 (reader);
+        val_denom = get_i64 (reader);
+        gnc_time64_to_iso8601_buff (get_i64 (reader), drecn);
+
+        if (reader->ok)
+            append_text_split (out, flag, trans_guid_str, split_guid_str,
+                               dnow, dent, dpost, acc_guid_str, accname,
+                               num, description, notes, memo, action,
+                               reconciled,
+                               gnc_numeric_create (amt_num, amt_denom),
+                               gnc_numeric_create (val_num, val_denom),
+                               drecn);
+        g_free (accname);
+        g_free (memo);
+        g_free (action);
+    }
+    g_string_append (out, "===== END\n");
+
+    g_free (num);
+    g_free (description);
+    g_free (notes);
+    return reader->ok && reader->pos == reader->end;
+}
+
+gboolean
+xaccLogConvertToText (FILE *in, FILE *out)
+{
+    char magic[sizeof (BINARY_LOG_MAGIC) - 1];
+    GString *text;
+    GByteArray *record;
+    gboolean ok = TRUE;
+
+    g_return_val_if_fail (in && out, FALSE);
+
+    if (fread (magic, 1, sizeof (magic), in) != sizeof (magic) ||
+        memcmp (magic, BINARY_LOG_MAGIC, sizeof (magic)) != 0)
+    {
+        PERR ("Not a binary transaction log");
+        return FALSE;
+    }
+
+    text = g_string_sized_new (1024);
+    record = g_byte_array_new ();
+    append_text_header (text);
+    if (fwrite (text->str, 1, text->len, out) != text->len)
+        ok = FALSE;
+    while (ok)
+    {
+        guint32 len;
+        LogReader reader;
+
+        if (fread (&len, 1, sizeof (len), in) != sizeof (len))
+            break;
+        len = GUINT32_FROM_LE (len);
+        g_byte_array_set_size (record, len);
+        if (fread (record->data, 1, len, in) != len)
+        {
+            /* Cut short by a crash while it was being written. */
+            PWARN ("Ignoring a truncated record at the end of the log");
+            break;
+        }
+
+        reader.pos = record->data;
+        reader.end = record->data + len;
+        reader.ok = TRUE;
+        g_string_truncate (text, 0);
+        if (!binary_record_to_text (&reader, text))
+        {
+            PERR ("Corrupted record in the binary transaction log");
+            ok = FALSE;
+        }
+        else if (fwrite (text->str, 1, text->len, out) != text->len)
+            ok = FALSE;
+    }
+
+    g_byte_array_unref (record);
+    g_string_free (text, TRUE);
+    return ok;
 }
 
 /************************ END OF ************************************\
@@ -43,6 +43,7 @@
 #ifndef XACC_TRANS_LOG_H
 #define XACC_TRANS_LOG_H
 
+#include <stdio.h>
 #include "Account.h"
 #include "Transaction.h"
 
@@ -81,6 +82,25 @@ void    xaccLogSetBaseName (const char *);
 /** Test a filename to see if it is the name of the current logfile */
 gboolean xaccFileIsCurrentLog (const gchar *name);
 
+/** The xaccLogSetBinary() method selects the compact binary record
+ *    format instead of the tab-separated text for the log files opened
+ *    from now on.  An open log is closed and a new one opened in the
+ *    selected format.  The default is text unless the environment
+ *    variable GNC_BINARY_TRANSLOG is set.
+ */
+void    xaccLogSetBinary (gboolean binary);
+
+/** Convert a binary log to the tab-separated text format, header
+ *  included, so that it can be read or replayed.  A record cut short
+ *  at the end of the file is ignored.
+ *
+ * @param in The binary log, positioned at its start.
+ * @param out Where the text is written.
+ * @return FALSE if in isn't a binary log, a record is corrupted or
+ * writing out fails.
+ */
+gboolean xaccLogConvertToText (FILE *in, FILE *out);
+
 #endif /* XACC_TRANS_LOG_H */
 /** @} */
 /** @} */
@@ -71,8 +71,24 @@ typedef struct GncBudgetPrivate
 
     /* Number of periods */
     guint  num_periods;
+
+    /* The amounts are stored in the budget's KVP under account guid and
+     * period number. Looking them up there means formatting both and
+     * walking the frames for every cell, so the amounts are also kept in
+     * a dense per-account array of PeriodData, keyed by account guid and
+     * filled from the KVP the first time an account is accessed. The
+     * arrays are dropped when an edit of the budget is committed, so
+     * amounts written to the KVP directly, e.g. by a backend loading the
+     * slots, are seen after the next commit. */
+    GHashTable *acct_hash;
 } GncBudgetPrivate;
 
+typedef struct
+{
+    gboolean value_is_set;
+    gnc_numeric value;
+} PeriodData;
+
 #define GET_PRIVATE(o) \
     ((GncBudgetPrivate*)g_type_instance_get_private((GTypeInstance*)o, GNC_TYPE_BUDGET))
 
@@ -95,6 +111,10 @@ gnc_budget_init(GncBudget* budget)
     priv->description = CACHE_INSERT("");
 
     priv->num_periods = 12;
+    priv->acct_hash = g_hash_table_new_full (guid_hash_to_guint,
+                                             guid_g_hash_table_equal,
+                                             (GDestroyNotify) guid_free,
+                                             g_free);
     date = gnc_g_date_new_today ();
     g_date_subtract_days(date, g_date_get_day(date) - 1);
     recurrenceSet(&priv->recurrence, 1, PERIOD_MONTH, date, WEEKEND_ADJ_NONE);
@@ -110,6 +130,7 @@ gnc_budget_dispose (GObject *budgetp)
 static void
 gnc_budget_finalize(GObject* budgetp)
 {
+    g_hash_table_destroy (GET_PRIVATE(budgetp)->acct_hash);
     G_OBJECT_CLASS(gnc_budget_parent_class)->finalize(budgetp);
 }
 
@@ -239,6 +260,7 @@ gnc_budget_class_init(GncBudgetClass* klass)
 static void commit_err (QofInstance *inst, QofBackendError errcode)
 {
     PERR ("Failed to commit: %d", errcode);
+    g_hash_table_remove_all (GET_PRIVATE(inst)->acct_hash);
     gnc_engine_signal_commit_error( errcode );
 }
 
@@ -267,7 +289,12 @@ gnc_budget_free(QofInstance *inst)
     g_object_unref(budget);
 }
 
-static void noop (QofInstance *inst) {}
+static void
+budget_done (QofInstance *inst)
+{
+    /* The KVP may have been changed without set/unset during the edit. */
+    g_hash_table_remove_all (GET_PRIVATE(inst)->acct_hash);
+}
 
 void
 gnc_budget_begin_edit(GncBudget *bgt)
@@ -280,7 +307,7 @@ gnc_budget_commit_edit(GncBudget *bgt)
 {
     if (!qof_commit_edit(QOF_INSTANCE(bgt))) return;
     qof_commit_edit_part2(QOF_INSTANCE(bgt), commit_err,
-                          noop, gnc_budget_free);
+                          budget_done, gnc_budget_free);
 }
 
 GncBudget*
@@ -458,6 +485,8 @@ gnc_budget_set_num_periods(GncBudget* budget, guint num_periods)
 
     gnc_budget_begin_edit(budget);
     priv->num_periods = num_periods;
+    /* The per-account arrays are sized by the number of periods. */
+    g_hash_table_remove_all (priv->acct_hash);
     qof_instance_set_dirty(&budget->inst);
     gnc_budget_commit_edit(budget);
 
@@ -481,6 +510,50 @@ make_period_path (const Account *account, guint period_num, char *path1, char *p
     g_sprintf (path2, "%d", period_num);
 }
 
+static PeriodData
+read_period_data_from_kvp (const GncBudget *budget, const Account *account,
+                           guint period_num)
+{
+    PeriodData data = { FALSE, { 0, 1 } };
+    gchar path_part_one [GUID_ENCODING_LENGTH + 1];
+    gchar path_part_two [GNC_BUDGET_MAX_NUM_PERIODS_DIGITS];
+    GValue v = G_VALUE_INIT;
+
+    make_period_path (account, period_num, path_part_one, path_part_two);
+    qof_instance_get_kvp (QOF_INSTANCE (budget), &v, 2, path_part_one, path_part_two);
+    if (G_VALUE_HOLDS_BOXED (&v) && g_value_get_boxed (&v))
+    {
+        data.value_is_set = TRUE;
+        data.value = *(gnc_numeric*)g_value_get_boxed (&v);
+    }
+    g_value_unset (&v);
+    return data;
+}
+
+/* Returns the cached amount of the period, reading the account's amounts
+ * from the KVP if they aren't cached yet. */
+static PeriodData*
+get_period_data (const GncBudget *budget, const Account *account,
+                 guint period_num)
+{
+    GncBudgetPrivate *priv = GET_PRIVATE(budget);
+    const GncGUID *guid = xaccAccountGetGUID (account);
+    PeriodData *row;
+
+    if (period_num >= priv->num_periods)
+        return NULL;
+
+    row = g_hash_table_lookup (priv->acct_hash, guid);
+    if (!row)
+    {
+        row = g_new0 (PeriodData, priv->num_periods);
+        for (guint i = 0; i < priv->num_periods; ++i)
+            row[i] = read_period_data_from_kvp (budget, account, i);
+        g_hash_table_insert (priv->acct_hash, guid_copy (guid), row);
+    }
+    return &row[period_num];
+}
+
 /* period_num is zero-based */
 /* What happens when account is deleted, after we have an entry for it? */
 void
@@ -489,6 +562,7 @@ gnc_budget_unset_account_period_value(GncBudget *budget, const Account *account,
 {
     gchar path_part_one [GUID_ENCODING_LENGTH + 1];
     gchar path_part_two [GNC_BUDGET_MAX_NUM_PERIODS_DIGITS];
+    PeriodData *data;
 
     g_return_if_fail (budget != NULL);
     g_return_if_fail (account != NULL);
@@ -496,6 +570,9 @@ gnc_budget_unset_account_period_value(GncBudget *budget, const Account *account,
 
     gnc_budget_begin_edit(budget);
     qof_instance_set_kvp (QOF_INSTANCE (budget), NULL, 2, path_part_one, path_part_two);
+    data = get_period_data (budget, account, period_num);
+    if (data)
+        data->value_is_set = FALSE;
     qof_instance_set_dirty(&budget->inst);
     gnc_budget_commit_edit(budget);
 
@@ -511,6 +588,7 @@ gnc_budget_set_account_period_value(GncBudget *budget, const Account *account,
 {
     gchar path_part_one [GUID_ENCODING_LENGTH + 1];
     gchar path_part_two [GNC_BUDGET_MAX_NUM_PERIODS_DIGITS];
+    PeriodData *data;
 
     /* Watch out for an off-by-one error here:
      * period_num starts from 0 while num_periods starts from 1 */
@@ -526,14 +604,21 @@ gnc_budget_set_account_period_value(GncBudget *budget, const Account *account,
     make_period_path (account, period_num, path_part_one, path_part_two);
 
     gnc_budget_begin_edit(budget);
+    data = get_period_data (budget, account, period_num);
     if (gnc_numeric_check(val))
+    {
         qof_instance_set_kvp (QOF_INSTANCE (budget), NULL, 2, path_part_one, path_part_two);
+        data->value_is_set = FALSE;
+    }
     else
     {
         GValue v = G_VALUE_INIT;
         g_value_init (&v, GNC_TYPE_NUMERIC);
         g_value_set_boxed (&v, &val);
         qof_instance_set_kvp (QOF_INSTANCE (budget), &v, 2, path_part_one, path_part_two);
+        g_value_unset (&v);
+        data->value_is_set = TRUE;
+        data->value = val;
     }
     qof_instance_set_dirty(&budget->inst);
     gnc_budget_commit_edit(budget);
@@ -550,19 +635,15 @@ gnc_budget_is_account_period_value_set(const GncBudget *budget,
                                        const Account *account,
                                        guint period_num)
 {
-    GValue v = G_VALUE_INIT;
-    gchar path_part_one [GUID_ENCODING_LENGTH + 1];
-    gchar path_part_two [GNC_BUDGET_MAX_NUM_PERIODS_DIGITS];
-    gconstpointer ptr = NULL;
+    PeriodData *data;
 
     g_return_val_if_fail(GNC_IS_BUDGET(budget), FALSE);
     g_return_val_if_fail(account, FALSE);
 
-    make_period_path (account, period_num, path_part_one, path_part_two);
-    qof_instance_get_kvp (QOF_INSTANCE (budget), &v, 2, path_part_one, path_part_two);
-    if (G_VALUE_HOLDS_BOXED (&v))
-        ptr = g_value_get_boxed (&v);
-    return (ptr != NULL);
+    data = get_period_data (budget, account, period_num);
+    if (!data)
+        return read_period_data_from_kvp (budget, account, period_num).value_is_set;
+    return data->value_is_set;
 }
 
 gnc_numeric
@@ -570,22 +651,15 @@ gnc_budget_get_account_period_value(const GncBudget *budget,
                                     const Account *account,
                                     guint period_num)
 {
-    gnc_numeric *numeric = NULL;
-    gchar path_part_one [GUID_ENCODING_LENGTH + 1];
-    gchar path_part_two [GNC_BUDGET_MAX_NUM_PERIODS_DIGITS];
-    GValue v = G_VALUE_INIT;
+    PeriodData *data;
 
     g_return_val_if_fail(GNC_IS_BUDGET(budget), gnc_numeric_zero());
     g_return_val_if_fail(account, gnc_numeric_zero());
 
-    make_period_path (account, period_num, path_part_one, path_part_two);
-    qof_instance_get_kvp (QOF_INSTANCE (budget), &v, 2, path_part_one, path_part_two);
-    if (G_VALUE_HOLDS_BOXED (&v))
-        numeric = (gnc_numeric*)g_value_get_boxed (&v);
-
-    if (numeric)
-        return *numeric;
-    return gnc_numeric_zero();
+    data = get_period_data (budget, account, period_num);
+    if (!data)
+        return read_period_data_from_kvp (budget, account, period_num).value;
+    return data->value;
 }
 
 
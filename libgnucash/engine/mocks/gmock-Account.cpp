@@ -60,6 +60,14 @@ xaccAccountForEachTransaction(const Account *acc, TransactionCallback proc,
     return mockaccount ? mockaccount->for_each_transaction(proc, data) : 0;
 }
 
+SplitList *
+xaccAccountGetSplitList (const Account *acc)
+{
+    SCOPED_TRACE("");
+    auto mockaccount = gnc_mockaccount(acc);
+    return mockaccount ? mockaccount->get_split_list() : nullptr;
+}
+
 GncImportMatchMap *
 gnc_account_imap_create_imap (Account *acc)
 {
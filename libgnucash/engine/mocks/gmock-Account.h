@@ -43,6 +43,7 @@ public:
     MOCK_METHOD0(commit_edit, void());
     MOCK_CONST_METHOD0(get_book, QofBook*());
     MOCK_CONST_METHOD2(for_each_transaction, gint(TransactionCallback, void*));
+    MOCK_CONST_METHOD0(get_split_list, SplitList*());
     MOCK_METHOD0(create_imap, GncImportMatchMap*());
 
 protected:
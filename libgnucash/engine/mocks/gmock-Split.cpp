@@ -15,16 +15,49 @@ typedef struct _MockSplitClass MockSplitClass;
 
 G_DEFINE_TYPE(MockSplit, gnc_mocksplit, QOF_TYPE_INSTANCE);
 
+enum
+{
+    PROP_0,
+    PROP_ONLINE_ID,
+};
+
 static void
 gnc_mocksplit_init (MockSplit *inst)
 {
     // function is unused, initialization is done in the MockSplit's C++ constructor
 }
 
+static void
+gnc_mocksplit_get_property (GObject* object, guint prop_id, GValue* value, GParamSpec* pspec)
+{
+    switch (prop_id)
+    {
+    case PROP_ONLINE_ID:
+        // mock splits never carry an online id
+        g_value_set_string (value, nullptr);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+        break;
+    }
+}
+
 static void
 gnc_mocksplit_class_init (MockSplitClass *klass)
 {
-    // function is unused, class functions are defined in C++ code
+    GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+    // all other class functions are defined in C++ code
+    gobject_class->get_property = gnc_mocksplit_get_property;
+
+    g_object_class_install_property
+    (gobject_class,
+     PROP_ONLINE_ID,
+     g_param_spec_string ("online-id",
+                          "Online ID",
+                          "The online ID of the split, always unset for mock splits.",
+                          nullptr,
+                          G_PARAM_READABLE));
 }
 
 
@@ -53,6 +53,7 @@ extern "C"
 #include "qofinstance-p.h"
 #include <string>
 #include <algorithm>
+#include <functional>
 #include <vector>
 /* NOTE: The following comments were musings by the original developer about how
  * some additional API might work. The compile/free/run_query functions were
@@ -86,14 +87,6 @@ extern "C"
  *    continue functioning even when disconnected from the server:
  *    this is because it will have its local cache of data from which to work.
  *
- * The events_pending() routines should return true if there are
- *    external events which need to be processed to bring the
- *    engine up to date with the backend.
- *
- * The process_events() routine should process any events indicated
- *    by the events_pending() routine. It should return TRUE if
- *    the engine was changed while engine events were suspended.
- *
  * For support of book partitioning, use special "Book"  begin_edit()
  *    and commit_edit() QOF_ID types.
  *
@@ -169,6 +162,10 @@ typedef enum
 } QofBackendLoadType;
 
 using GModuleVec = std::vector<GModule*>;
+/** Receives objects as a book is read for copying it into another backend;
+ * returns true if the object was written and may be dropped from the book.
+ */
+using QofBackendSink = std::function<bool(QofInstance*)>;
 struct QofBackend
 {
 public:
@@ -250,6 +247,55 @@ public:
  *   database with it. Implemented only in the XML backend at present.
  */
     virtual void export_coa(QofBook *) {}
+/**   Let the data store narrow down the objects a query has to examine.
+ *
+ *   The backend may return any list of the book's objects of the query's
+ *   search type that contains every object matching the query; the engine
+ *   still checks each candidate against the query, so a backend can safely
+ *   ignore terms it can't evaluate. Only used for queries that requested it
+ *   with qof_query_set_backend_search().
+ *   @param query The query to run.
+ *   @param book The book being searched.
+ *   @param candidates Set to the candidate list, owned by the caller.
+ *   @return false if the backend can't help, in which case every object in
+ *   the book is checked.
+ */
+    virtual bool select_candidates(QofQuery*, QofBook*, GList**)
+    {
+        return false;
+    }
+/**   Load the book like load(book, LOAD_TYPE_INITIAL_LOAD), handing each
+ *   transaction to @a sink as soon as it has been read. Transactions the sink
+ *   accepts are destroyed, so the book is incomplete afterward and is only
+ *   good for finishing the copy. Backends that can't do that just load.
+ */
+    virtual void load_streaming(QofBook* book, const QofBackendSink&)
+    {
+        load (book, LOAD_TYPE_INITIAL_LOAD);
+    }
+/**   Start copying @a book into this backend's new, empty data store.
+ *   @return false if the backend can't write a book a piece at a time, or
+ *   with an error set if it couldn't start.
+ */
+    virtual bool begin_bulk_write(QofBook*) { return false; }
+/**   Write one object of the book passed to begin_bulk_write().
+ *   @return true if the object was written; the others are written by
+ *   end_bulk_write().
+ */
+    virtual bool bulk_write(QofInstance*) { return false; }
+/**   Write whatever is left in the book and finish the copy, or abandon it if
+ *   passed false because reading the book failed.
+ */
+    virtual void end_bulk_write(bool) {}
+/**   Report whether other users changed the data store since the book was
+ *   loaded or last brought up to date, i.e. whether process_events() has
+ *   anything to do. Polled periodically by the GUI.
+ */
+    virtual bool events_pending() { return false; }
+/**   Apply the changes found by events_pending() to the book.
+ *   @return true if the engine was changed.
+ */
+    virtual bool process_events() { return false; }
 /** Set the error value only if there isn't already an error already.
  */
     void set_error(QofBackendError err);
@@ -481,6 +481,7 @@ qof_book_mark_session_saved (QofBook *book)
 void qof_book_mark_session_dirty (QofBook *book)
 {
     if (!book) return;
+    book->change_generation++;
     if (!book->session_dirty)
     {
         /* Set the session dirty upfront, because the callback will check. */
@@ -500,6 +501,13 @@ qof_book_print_dirty (const QofBook *book)
     (book, (QofCollectionForeachCB)qof_collection_print_dirty, NULL);
 }
 
+gint64
+qof_book_get_change_generation (const QofBook *book)
+{
+    if (!book) return 0;
+    return book->change_generation;
+}
+
 time64
 qof_book_get_session_dirty_time (const QofBook *book)
 {
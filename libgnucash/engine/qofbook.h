@@ -161,6 +161,10 @@ struct _QofBook
     gint cached_num_days_autoreadonly;
     /* Whether the above cached value is valid. */
     gboolean cached_num_days_autoreadonly_isvalid;
+
+    /* Incremented each time a change is committed to the book, see
+     * qof_book_get_change_generation(). */
+    gint64 change_generation;
 };
 
 struct _QofBookClass
@@ -322,6 +326,14 @@ gboolean qof_book_shutting_down (const QofBook *book);
  */
 gboolean qof_book_session_not_saved (const QofBook *book);
 
+/** qof_book_get_change_generation() returns a counter that is
+ * incremented each time a change to any object in the book is
+ * committed. It never decreases, so callers can cache results derived
+ * from the book and recompute them only once the counter has moved
+ * on.
+ */
+gint64 qof_book_get_change_generation (const QofBook *book);
+
 /* The following functions are not useful in scripting languages */
 #ifndef SWIG
 
@@ -1017,7 +1017,10 @@ qof_commit_edit_part2(QofInstance *inst,
         }
         while (errcode != ERR_BACKEND_NO_ERR);
 
-        be->commit(inst);
+        {
+            QOF_TRACE_SCOPE ("commit");
+            be->commit(inst);
+        }
         errcode = be->get_error();
         if (errcode != ERR_BACKEND_NO_ERR)
         {
@@ -58,6 +58,9 @@ extern "C"
 #include <vector>
 #include <memory>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
 
 #define QOF_LOG_MAX_CHARS 50
 #define QOF_LOG_MAX_CHARS_WITH_ALLOWANCE 100
@@ -92,6 +95,10 @@ struct ModuleEntry
 };
 
 static ModuleEntryPtr _modules = NULL;
+/* The most verbose level set for any module. Anything more verbose is
+ * rejected by qof_log_check without walking the module tree, which keeps
+ * disabled ENTER/LEAVE/DEBUG calls cheap. */
+static QofLogLevel max_level = default_level;
 
 static ModuleEntry*
 get_modules()
@@ -280,6 +287,10 @@ qof_log_shutdown (void)
     {
         _modules = nullptr;
     }
+    max_level = default_level;
+
+    qof_trace_write ();
+    qof_trace_init_filename (nullptr);
 
     if (previous_handler != NULL)
     {
@@ -315,6 +326,8 @@ qof_log_set_level(QofLogModule log_module, QofLogLevel level)
         }
     }
     module->m_level = level;
+    if (level > max_level)
+        max_level = level;
 }
 
 
@@ -322,6 +335,9 @@ gboolean
 qof_log_check(QofLogModule domain, QofLogLevel level)
 {
 
+    if (level > max_level)
+        return FALSE;
+
     auto module = get_modules();
     // If the level is < the default then no need to look further.
     if (level < module->m_level)
@@ -468,15 +484,24 @@ qof_log_parse_log_config(const char *filename)
             gchar *key = outputs[output_idx];
             gchar *value;
 
-            if (g_ascii_strcasecmp("to", key) != 0)
+            if (g_ascii_strcasecmp("to", key) != 0 &&
+                g_ascii_strcasecmp("trace", key) != 0)
             {
                 g_warning("unknown key [%s] in [outputs], skipping", key);
                 continue;
             }
 
             value = g_key_file_get_string(conf, output_group, key, NULL);
-            g_debug("setting [output].to=[%s]", value);
-            qof_log_init_filename_special(value);
+            if (g_ascii_strcasecmp("trace", key) == 0)
+            {
+                g_debug("setting [output].trace=[%s]", value);
+                qof_trace_init_filename(value);
+            }
+            else
+            {
+                g_debug("setting [output].to=[%s]", value);
+                qof_log_init_filename_special(value);
+            }
             g_free(value);
         }
         g_strfreev(outputs);
@@ -493,6 +518,167 @@ qof_log_set_default(QofLogLevel log_level)
     qof_log_set_level("qof.unknown", log_level);
 }
 
+/* Span tracing. Each thread records into its own fixed-size ring buffer;
+ * when a buffer is full the oldest events are overwritten. A buffer's lock
+ * is only contended while qof_trace_write copies it. The buffers are owned
+ * by a global list so that the events of finished threads can still be
+ * written out. */
+
+struct TraceEvent
+{
+    QofLogModule module;
+    const char *name;
+    gint64 ns;
+    gint64 dur;                 // Only for complete ('X') events.
+    char phase;
+};
+
+struct TraceBuffer
+{
+    explicit TraceBuffer (unsigned tid) : m_tid{tid} { m_events.reserve (trace_buffer_size); }
+    static constexpr size_t trace_buffer_size = 1 << 16;
+    unsigned m_tid;
+    std::mutex m_mutex;         // Protects m_next and m_events.
+    size_t m_next = 0;
+    std::vector<TraceEvent> m_events;
+};
+
+using TraceBufferPtr = std::shared_ptr<TraceBuffer>;
+
+static std::atomic<bool> trace_on{false};
+static std::mutex trace_mutex;
+static std::string trace_filename;
+static std::vector<TraceBufferPtr> trace_buffers;
+static const auto trace_epoch = std::chrono::steady_clock::now();
+
+static TraceBuffer&
+trace_buffer (void)
+{
+    thread_local TraceBufferPtr buffer = []()
+        {
+            std::lock_guard<std::mutex> lock (trace_mutex);
+            auto buf = std::make_shared<TraceBuffer>(trace_buffers.size() + 1);
+            trace_buffers.push_back (buf);
+            return buf;
+        }();
+    return *buffer;
+}
+
+gint64
+qof_trace_now (void)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>
+        (std::chrono::steady_clock::now() - trace_epoch).count();
+}
+
+static void
+trace_record (QofLogModule log_module, const char *name, char phase,
+              gint64 ns, gint64 dur = 0)
+{
+    auto& buf = trace_buffer ();
+    TraceEvent event{log_module, name, ns, dur, phase};
+    std::lock_guard<std::mutex> lock (buf.m_mutex);
+    if (buf.m_events.size() < TraceBuffer::trace_buffer_size)
+        buf.m_events.push_back (event);
+    else
+        buf.m_events[buf.m_next] = event;
+    buf.m_next = (buf.m_next + 1) % TraceBuffer::trace_buffer_size;
+}
+
+void
+qof_trace_init_filename (const char *filename)
+{
+    std::lock_guard<std::mutex> lock (trace_mutex);
+    trace_filename = filename ? filename : "";
+    trace_on = !trace_filename.empty();
+}
+
+gboolean
+qof_trace_enabled (void)
+{
+    return trace_on.load (std::memory_order_relaxed);
+}
+
+void
+qof_trace_begin (QofLogModule log_module, const char *name)
+{
+    trace_record (log_module, name, 'B', qof_trace_now ());
+}
+
+void
+qof_trace_end (QofLogModule log_module, const char *name)
+{
+    trace_record (log_module, name, 'E', qof_trace_now ());
+}
+
+void
+qof_trace_complete (QofLogModule log_module, const char *name, gint64 start_ns)
+{
+    trace_record (log_module, name, 'X', start_ns, qof_trace_now () - start_ns);
+}
+
+static void
+trace_write_string (FILE *file, const char *str)
+{
+    fputc ('"', file);
+    for (auto c = str ? str : ""; *c; ++c)
+    {
+        if (*c == '"' || *c == '\\')
+            fputc ('\\', file);
+        if (static_cast<unsigned char>(*c) >= 0x20)
+            fputc (*c, file);
+    }
+    fputc ('"', file);
+}
+
+void
+qof_trace_write (void)
+{
+    std::lock_guard<std::mutex> lock (trace_mutex);
+    if (trace_filename.empty())
+        return;
+
+    auto file = g_fopen (trace_filename.c_str(), "w");
+    if (!file)
+    {
+        g_warning ("Cannot open trace output file \"%s\".", trace_filename.c_str());
+        return;
+    }
+
+    /* Chrome trace-event format, timestamps in microseconds. Each buffer
+     * is copied under its lock so that running threads can keep recording
+     * while the file is written. */
+    const char *sep = "";
+    fputs ("{\"traceEvents\":[", file);
+    for (const auto& buf : trace_buffers)
+    {
+        std::vector<TraceEvent> events;
+        size_t first;
+        {
+            std::lock_guard<std::mutex> buf_lock (buf->m_mutex);
+            events = buf->m_events;
+            first = events.size() < TraceBuffer::trace_buffer_size ? 0 : buf->m_next;
+        }
+        auto count = events.size();
+        for (size_t i = 0; i < count; ++i)
+        {
+            const auto& event = events[(first + i) % count];
+            fprintf (file, "%s\n{\"ph\":\"%c\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,",
+                     sep, event.phase, buf->m_tid, event.ns / 1000.0);
+            if (event.phase == 'X')
+                fprintf (file, "\"dur\":%.3f,", event.dur / 1000.0);
+            fputs ("\"cat\":", file);
+            trace_write_string (file, event.module);
+            fputs (",\"name\":", file);
+            trace_write_string (file, event.name);
+            fputc ('}', file);
+            sep = ",";
+        }
+    }
+    fputs ("\n]}\n", file);
+    fclose (file);
+}
+
 const gchar*
 qof_log_level_to_string(QofLogLevel log_level)
 {
@@ -152,6 +152,7 @@ void qof_log_init_filename_special(const char *log_to_filename);
     [output]
     # to=["stderr"|"stdout"|filename]
     to=stderr
+    # trace=filename, see qof_trace_init_filename()
  @endverbatim
  **/
 void qof_log_parse_log_config(const char *filename);
@@ -173,6 +174,85 @@ gboolean qof_log_check(QofLogModule log_module, QofLogLevel log_level);
 /** Set the default level for QOF-related log paths. **/
 void qof_log_set_default(QofLogLevel log_level);
 
+/** @name Span tracing
+ *
+ * Independent of the text log, spans can be recorded into per-thread
+ * ring buffers with nanosecond timestamps and written out as a Chrome
+ * trace-event JSON file (load it in chrome://tracing or Perfetto).
+ * While tracing is off a span costs one function call. ENTER and LEAVE
+ * don't record spans; only the places that mark one explicitly do: book
+ * loads and saves, instance commits, queries, scrubbing, report runs and
+ * register loads.
+ *
+ * In C++ QOF_TRACE_SCOPE records a span covering the rest of the enclosing
+ * scope, however it is left. In C QOF_TRACE_BEGIN and QOF_TRACE_END mark
+ * a span; use them only where nothing between them can return or jump
+ * out. Span names and modules are stored by pointer, so they must be
+ * string literals or otherwise live until the trace is written.
+ * @{
+ */
+
+/** Start recording spans; they are written to @a filename by
+ * qof_trace_write() and at qof_log_shutdown(). A NULL or empty
+ * @a filename stops recording. */
+void qof_trace_init_filename (const char *filename);
+
+/** TRUE if spans are being recorded. */
+gboolean qof_trace_enabled (void);
+
+/** Record the start of span @a name in @a log_module. */
+void qof_trace_begin (QofLogModule log_module, const char *name);
+
+/** Record the end of span @a name in @a log_module. */
+void qof_trace_end (QofLogModule log_module, const char *name);
+
+/** The current trace clock, in nanoseconds. */
+gint64 qof_trace_now (void);
+
+/** Record span @a name in @a log_module, from @a start_ns, a value of
+ * qof_trace_now(), until now. */
+void qof_trace_complete (QofLogModule log_module, const char *name,
+                         gint64 start_ns);
+
+/** Write the recorded spans of all threads to the trace file. */
+void qof_trace_write (void);
+
+#define QOF_TRACE_BEGIN(name) do { \
+    if (qof_trace_enabled()) \
+        qof_trace_begin (log_module, name); \
+} while (0)
+
+#define QOF_TRACE_END(name) do { \
+    if (qof_trace_enabled()) \
+        qof_trace_end (log_module, name); \
+} while (0)
+
+#ifdef __cplusplus
+/** Records a span from its construction to its destruction. */
+class QofTraceSpan
+{
+public:
+    QofTraceSpan (QofLogModule log_module, const char *name) :
+        m_module{log_module}, m_name{name},
+        m_start{qof_trace_enabled() ? qof_trace_now() : -1} {}
+    ~QofTraceSpan ()
+    {
+        if (m_start >= 0)
+            qof_trace_complete (m_module, m_name, m_start);
+    }
+    QofTraceSpan (const QofTraceSpan&) = delete;
+    QofTraceSpan& operator= (const QofTraceSpan&) = delete;
+private:
+    QofLogModule m_module;
+    const char *m_name;
+    gint64 m_start;
+};
+
+#define QOF_TRACE_SCOPE(name) QofTraceSpan qof_trace_span_ (log_module, name)
+#endif
+
+/** @} */
+
 #define PRETTY_FUNC_NAME qof_log_prettify(G_STRFUNC)
 
 #ifdef _MSC_VER
@@ -93,6 +93,9 @@ struct _QofQuery
     /* The maximum number of results to return */
     gint              max_results;
 
+    /* Whether the backend may preselect the objects to check */
+    gboolean          backend_search;
+
     /* list of books that will be participating in the query */
     GList *           books;
 
@@ -824,22 +827,20 @@ static void qof_query_run_cb(QofQueryCB* qcb, gpointer cb_arg)
     for (node = qcb->query->books; node; node = node->next)
     {
         QofBook* book = static_cast<QofBook*>(node->data);
-#ifdef QOF_BACKEND_QUERY
-        QofBackend* be = book->backend;
-
+        QofBackend* be = qof_book_get_backend (book);
+        GList* candidates = NULL;
 
-        if (be)
+        /* Let the backend weed out objects that can't match, then check
+         * what's left as usual. */
+        if (qcb->query->backend_search && be &&
+            be->select_candidates (qcb->query, book, &candidates))
         {
-            gpointer compiled_query = g_hash_table_lookup (qcb->query->be_compiled,
-                                      book);
-
-            if (compiled_query && be->run_query)
-            {
-                (be->run_query) (be, compiled_query);
-            }
+            g_list_foreach (candidates, check_item_cb, qcb);
+            g_list_free (candidates);
+            continue;
         }
-#endif
-        /* And then iterate over all the objects */
+
+        /* Otherwise iterate over all the objects */
         qof_object_foreach (qcb->query->search_for, book,
                             (QofInstanceForeachCB) check_item_cb, qcb);
     }
@@ -847,8 +848,12 @@ static void qof_query_run_cb(QofQueryCB* qcb, gpointer cb_arg)
 
 GList * qof_query_run (QofQuery *q)
 {
+    GList *result;
+
     /* Just a wrapper */
-    return qof_query_run_internal(q, qof_query_run_cb, NULL);
+    QOF_TRACE_SCOPE ("query");
+    result = qof_query_run_internal(q, qof_query_run_cb, NULL);
+    return result;
 }
 
 static void qof_query_run_subq_cb(QofQueryCB* qcb, gpointer cb_arg)
@@ -1150,6 +1155,7 @@ qof_query_merge(QofQuery *q1, QofQuery *q2, QofQueryOp op)
             g_list_concat(copy_or_terms(q1->terms), copy_or_terms(q2->terms));
         retval->books           = merge_books (q1->books, q2->books);
         retval->max_results    = q1->max_results;
+        retval->backend_search = q1->backend_search && q2->backend_search;
         retval->changed        = 1;
         break;
 
@@ -1157,6 +1163,7 @@ qof_query_merge(QofQuery *q1, QofQuery *q2, QofQueryOp op)
         retval = qof_query_create();
         retval->books          = merge_books (q1->books, q2->books);
         retval->max_results    = q1->max_results;
+        retval->backend_search = q1->backend_search && q2->backend_search;
         retval->changed        = 1;
 
         /* g_list_append() can take forever, so let's build the list in
@@ -1274,6 +1281,12 @@ void qof_query_set_max_results (QofQuery *q, int n)
     q->max_results = n;
 }
 
+void qof_query_set_backend_search (QofQuery *q, gboolean use_backend)
+{
+    if (!q) return;
+    q->backend_search = use_backend;
+}
+
 void qof_query_add_guid_list_match (QofQuery *q, QofQueryParamList *param_list,
                                     GList *guid_list, QofGuidMatch options,
                                     QofQueryOp op)
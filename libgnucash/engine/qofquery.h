@@ -360,6 +360,15 @@ void qof_query_set_sort_increasing (QofQuery *q, gboolean prim_inc,
  */
 void qof_query_set_max_results (QofQuery *q, int n);
 
+/**
+ * Allow the books' backends to narrow down the objects the query has to
+ * check.  A SQL backend can then select the candidates in the database
+ * instead of the query walking every object in memory.  The results are
+ * the same except for changes that haven't been committed to the backend
+ * yet, so only set this on queries for which that doesn't matter.
+ */
+void qof_query_set_backend_search (QofQuery *q, gboolean use_backend);
+
 /** Compare two queries for equality.
  * Query terms are compared each to each.
  * This is a simplistic
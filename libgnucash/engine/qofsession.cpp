@@ -522,13 +522,13 @@ QofSessionImpl::swap_books (QofSessionImpl & other) noexcept
 bool
 QofSessionImpl::events_pending () const noexcept
 {
-    return false;
+    return m_backend && m_backend->events_pending ();
 }
 
 bool
 QofSessionImpl::process_events () const noexcept
 {
-    return false;
+    return m_backend && m_backend->process_events ();
 }
 
 /* XXX This exports the list of accounts to a file.  It does not
@@ -557,6 +557,59 @@ QofSessionImpl::export_session (QofSessionImpl & real_session,
     return true;
 }
 
+bool
+QofSessionImpl::stream_to (QofSessionImpl & dest,
+                           QofPercentageFunc percentage_func) noexcept
+{
+    /* Like load(), we need an empty book to load into. */
+    g_return_val_if_fail (m_book && qof_book_empty (m_book), false);
+    if (!(m_backend && dest.m_backend)) return false;
+    ENTER ("sess=%p uri=%s dest=%s", this, m_uri.c_str (), dest.m_uri.c_str ());
+
+    clear_error ();
+    dest.clear_error ();
+    dest.m_backend->set_percentage (percentage_func);
+    if (!dest.m_backend->begin_bulk_write (m_book))
+    {
+        if (dest.m_backend->check_error ())
+        {
+            dest.push_error (dest.m_backend->get_error (), {});
+            LEAVE ("Failed to start writing");
+            return false;
+        }
+        /* The destination can only write a whole book: do a plain Save As. */
+        load (percentage_func);
+        if (qof_book_empty (m_book))
+        {
+            LEAVE ("Failed to load");
+            return false;
+        }
+        swap_books (dest);
+        qof_book_mark_session_dirty (dest.m_book);
+        dest.save (percentage_func);
+        swap_books (dest);
+        LEAVE ("Saved the whole book");
+        return dest.m_last_err == ERR_BACKEND_NO_ERR;
+    }
+
+    qof_book_set_backend (m_book, m_backend);
+    m_backend->set_percentage (percentage_func);
+    m_backend->load_streaming (m_book, [&dest](QofInstance* inst)
+                               {
+                                   return dest.m_backend->bulk_write (inst);
+                               });
+    auto err = m_backend->get_error ();
+    push_error (err, {});
+    /* The same errors as in load() only ask the user for a decision. */
+    auto loaded = err == ERR_BACKEND_NO_ERR || err == ERR_FILEIO_FILE_TOO_OLD ||
+        err == ERR_FILEIO_NO_ENCODING || err == ERR_FILEIO_FILE_UPGRADE ||
+        err == ERR_SQL_DB_TOO_OLD || err == ERR_SQL_DB_TOO_NEW;
+    dest.m_backend->end_bulk_write (loaded);
+    dest.push_error (dest.m_backend->get_error (), {});
+    LEAVE ("sess=%p", this);
+    return loaded && dest.m_last_err == ERR_BACKEND_NO_ERR;
+}
+
 /* C Wrapper Functions */
 /* ====================================================================== */
 
@@ -622,6 +675,7 @@ qof_session_load (QofSession *session,
                   QofPercentageFunc percentage_func)
 {
     if (!session) return;
+    QOF_TRACE_SCOPE ("load");
     session->load (percentage_func);
 }
 
@@ -630,6 +684,7 @@ qof_session_save (QofSession *session,
                   QofPercentageFunc percentage_func)
 {
     if (!session) return;
+    QOF_TRACE_SCOPE ("save");
     session->save (percentage_func);
 }
 
@@ -685,6 +740,14 @@ qof_session_export (QofSession *tmp_session,
     return tmp_session->export_session (*real_session, percentage_func);
 }
 
+gboolean
+qof_session_stream_to (QofSession *session, QofSession *dest,
+                       QofPercentageFunc percentage_func)
+{
+    if (!session || !dest || session == dest) return FALSE;
+    return session->stream_to (*dest, percentage_func);
+}
+
 /* ================= Static function access for testing ================= */
 
 void init_static_qofsession_pointers (void);
@@ -306,6 +306,19 @@ gboolean qof_session_export (QofSession *tmp_session,
                              QofSession *real_session,
                              QofPercentageFunc percentage_func);
 
+/** Copy the data of a session that has been begun but not loaded into the
+ *  new, empty data store of @a dest, writing transactions to @a dest as they
+ *  are read when both backends support it so that they needn't all be held
+ *  in memory. Otherwise the whole book is loaded and saved.
+ *
+ *  Afterward the book of @a session may be incomplete; end the session
+ *  without saving it.
+ *
+ *  @return TRUE if everything was copied; the sessions hold the errors.
+ */
+gboolean qof_session_stream_to (QofSession *session, QofSession *dest,
+                                QofPercentageFunc percentage_func);
+
 /** Return a list of strings for the registered access methods. The owner is
  *  responsible for freeing the list but not the strings.
  */
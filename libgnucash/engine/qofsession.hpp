@@ -51,6 +51,7 @@ struct QofSessionImpl
     void safe_save (QofPercentageFunc) noexcept;
     bool save_in_progress () const noexcept;
     bool export_session (QofSessionImpl & real_session, QofPercentageFunc) noexcept;
+    bool stream_to (QofSessionImpl & dest, QofPercentageFunc) noexcept;
 
     bool events_pending () const noexcept;
     bool process_events () const noexcept;
@@ -0,0 +1,452 @@
+/********************************************************************
+ * benchmark-engine.cpp: time common engine operations on a large   *
+ * generated book.                                                  *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, you can retrieve it from        *
+ * https://www.gnu.org/licenses/old-licenses/gpl-2.0.html            *
+ * or contact:                                                      *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+
+/* Not a test: build and run it with "make benchmark". The book is
+ * generated from a fixed seed, so runs with the same scale options
+ * measure the same data and their results can be compared between
+ * releases. The results are written as JSON in the layout used by
+ * Google Benchmark. At the end the book is saved to and loaded from
+ * an XML file and, when GnuCash is built with libdbi, a SQLite file,
+ * using the backend modules of the build tree.
+ */
+
+extern "C"
+{
+#include <config.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include "qof.h"
+#include "cashobjects.h"
+#include "Account.h"
+#include "Query.h"
+#include "Scrub.h"
+#include "Transaction.h"
+#include "TransLog.h"
+#include "gnc-commodity.h"
+#include "gnc-pricedb.h"
+}
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+struct BookScale
+{
+    int accounts = 1000;
+    int transactions = 200000;
+    int prices = 100000;
+    int commodities = 50;
+    unsigned seed = 42;
+};
+
+struct BenchBook
+{
+    QofBook *book;
+    Account *root;
+    gnc_commodity *currency;
+    std::vector<gnc_commodity*> commodities;
+    std::vector<Account*> leaves;
+    std::vector<Transaction*> transactions;
+};
+
+struct BenchResult
+{
+    std::string name;
+    int iterations;
+    double ns_per_iteration;
+};
+
+static const char *words[] =
+{
+    "grocery", "rent", "salary", "fuel", "insurance", "coffee", "books",
+    "electricity", "water", "phone", "internet", "restaurant", "pharmacy",
+    "hardware", "garden", "train", "taxi", "hotel", "flight", "dividend",
+    "interest", "tax", "gift", "repair", "clothing", "cinema", "music",
+    "software", "charity", "bakery"
+};
+
+static constexpr time64 start_date = 1262304000; /* 2010-01-01 */
+static constexpr time64 date_range = 10 * 365 * 24 * 3600;
+
+static BenchBook
+generate_book (const BookScale& scale)
+{
+    std::mt19937 gen{scale.seed};
+    auto uniform = [&gen](int lo, int hi)
+        { return std::uniform_int_distribution<int>{lo, hi}(gen); };
+
+    BenchBook bb;
+    bb.book = qof_book_new ();
+    bb.root = gnc_account_create_root (bb.book);
+
+    auto table = gnc_commodity_table_get_table (bb.book);
+    gnc_commodity_table_add_default_data (table, bb.book);
+    bb.currency = gnc_commodity_table_lookup (table, GNC_COMMODITY_NS_CURRENCY, "USD");
+    for (int i = 0; i < scale.commodities; ++i)
+    {
+        auto mnemonic = "BENCH" + std::to_string (i);
+        auto comm = gnc_commodity_new (bb.book, mnemonic.c_str(), "BENCH",
+                                       mnemonic.c_str(), nullptr, 10000);
+        bb.commodities.push_back (gnc_commodity_table_insert (table, comm));
+    }
+
+    /* A two level tree: a few placeholders with the leaves below them. */
+    static const GNCAccountType types[] =
+        { ACCT_TYPE_BANK, ACCT_TYPE_ASSET, ACCT_TYPE_LIABILITY,
+          ACCT_TYPE_INCOME, ACCT_TYPE_EXPENSE };
+    std::vector<Account*> parents;
+    auto n_parents = std::max (scale.accounts / 50, 1);
+    for (int i = 0; i < n_parents; ++i)
+    {
+        auto acc = xaccMallocAccount (bb.book);
+        xaccAccountBeginEdit (acc);
+        xaccAccountSetName (acc, ("Parent " + std::to_string (i)).c_str());
+        xaccAccountSetType (acc, types[i % G_N_ELEMENTS (types)]);
+        xaccAccountSetCommodity (acc, bb.currency);
+        xaccAccountSetPlaceholder (acc, TRUE);
+        gnc_account_append_child (bb.root, acc);
+        xaccAccountCommitEdit (acc);
+        parents.push_back (acc);
+    }
+    for (int i = n_parents; i < scale.accounts; ++i)
+    {
+        auto parent = parents[i % n_parents];
+        auto acc = xaccMallocAccount (bb.book);
+        xaccAccountBeginEdit (acc);
+        xaccAccountSetName (acc, ("Account " + std::to_string (i)).c_str());
+        xaccAccountSetType (acc, xaccAccountGetType (parent));
+        xaccAccountSetCommodity (acc, bb.currency);
+        gnc_account_append_child (parent, acc);
+        xaccAccountCommitEdit (acc);
+        bb.leaves.push_back (acc);
+    }
+    if (bb.leaves.size() < 2)
+        return bb;
+
+    /* Defer the balance recomputation to one pass per account. */
+    for (auto acc : bb.leaves)
+        xaccAccountBeginEdit (acc);
+    for (int i = 0; i < scale.transactions; ++i)
+    {
+        auto from = bb.leaves[uniform (0, bb.leaves.size() - 1)];
+        auto to = bb.leaves[uniform (0, bb.leaves.size() - 1)];
+        auto amount = gnc_numeric_create (uniform (1, 1000000), 100);
+        std::string desc = std::string (words[uniform (0, G_N_ELEMENTS (words) - 1)])
+            + " " + words[uniform (0, G_N_ELEMENTS (words) - 1)];
+
+        auto trans = xaccMallocTransaction (bb.book);
+        xaccTransBeginEdit (trans);
+        xaccTransSetCurrency (trans, bb.currency);
+        xaccTransSetDatePostedSecsNormalized (trans, start_date + uniform (0, date_range));
+        xaccTransSetDescription (trans, desc.c_str());
+
+        auto split = xaccMallocSplit (bb.book);
+        xaccSplitSetParent (split, trans);
+        xaccSplitSetAccount (split, from);
+        xaccSplitSetAmount (split, gnc_numeric_neg (amount));
+        xaccSplitSetValue (split, gnc_numeric_neg (amount));
+
+        split = xaccMallocSplit (bb.book);
+        xaccSplitSetParent (split, trans);
+        xaccSplitSetAccount (split, to);
+        xaccSplitSetAmount (split, amount);
+        xaccSplitSetValue (split, amount);
+        xaccTransCommitEdit (trans);
+        bb.transactions.push_back (trans);
+    }
+    for (auto acc : bb.leaves)
+        xaccAccountCommitEdit (acc);
+
+    auto pdb = gnc_pricedb_get_db (bb.book);
+    for (int i = 0; i < scale.prices && !bb.commodities.empty(); ++i)
+    {
+        auto price = gnc_price_create (bb.book);
+        gnc_price_begin_edit (price);
+        gnc_price_set_commodity (price, bb.commodities[uniform (0, bb.commodities.size() - 1)]);
+        gnc_price_set_currency (price, bb.currency);
+        gnc_price_set_time64 (price, start_date + uniform (0, date_range));
+        gnc_price_set_source (price, PRICE_SOURCE_FQ);
+        gnc_price_set_typestr (price, PRICE_TYPE_LAST);
+        gnc_price_set_value (price, gnc_numeric_create (uniform (1, 100000000), 10000));
+        gnc_price_commit_edit (price);
+        gnc_pricedb_add_price (pdb, price);
+        gnc_price_unref (price);
+    }
+    return bb;
+}
+
+static GList*
+description_tokens (Transaction *trans)
+{
+    GList *tokens = nullptr;
+    auto words = g_strsplit (xaccTransGetDescription (trans), " ", -1);
+    for (auto word = words; *word; ++word)
+        tokens = g_list_prepend (tokens, g_strdup (*word));
+    g_strfreev (words);
+    return tokens;
+}
+
+/* Run func iterations times and return the mean wall clock time. */
+static BenchResult
+run_benchmark (const char *name, int iterations, const std::function<void(int)>& func)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        func (i);
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    auto result = BenchResult{name, iterations, elapsed.count() / iterations};
+    fprintf (stderr, "%-32s %10d %16.0f ns\n", name, iterations, result.ns_per_iteration);
+    return result;
+}
+
+/* Save the session's book into a new file with the backend of scheme and
+ * load it back into a new book. */
+static void
+run_backend_benchmarks (QofSession *session, const char *scheme,
+                        const std::string& path, std::vector<BenchResult>& results)
+{
+    auto uri = std::string (scheme) + "://" + path;
+    auto name = std::string (scheme);
+
+    results.push_back (run_benchmark ((name + " save").c_str(), 1, [&](int)
+        {
+            qof_session_begin (session, uri.c_str(), SESSION_NEW_OVERWRITE);
+            qof_book_mark_session_dirty (qof_session_get_book (session));
+            qof_session_save (session, nullptr);
+        }));
+    auto err = qof_session_get_error (session);
+    qof_session_end (session);
+    if (err != ERR_BACKEND_NO_ERR)
+    {
+        fprintf (stderr, "Saving to %s failed with error %d.\n", uri.c_str(), err);
+        return;
+    }
+
+    QofSession *load_session = nullptr;
+    results.push_back (run_benchmark ((name + " load").c_str(), 1, [&](int)
+        {
+            load_session = qof_session_new (qof_book_new ());
+            qof_session_begin (load_session, uri.c_str(), SESSION_READ_ONLY);
+            qof_session_load (load_session, nullptr);
+        }));
+    err = qof_session_get_error (load_session);
+    if (err != ERR_BACKEND_NO_ERR)
+        fprintf (stderr, "Loading %s failed with error %d.\n", uri.c_str(), err);
+    qof_session_end (load_session);
+    qof_session_destroy (load_session);
+}
+
+static void
+remove_tmp_dir (const char *dir)
+{
+    auto gdir = g_dir_open (dir, 0, nullptr);
+    if (gdir)
+    {
+        const char *entry;
+        while ((entry = g_dir_read_name (gdir)) != nullptr)
+        {
+            auto path = g_build_filename (dir, entry, nullptr);
+            g_unlink (path);
+            g_free (path);
+        }
+        g_dir_close (gdir);
+    }
+    g_rmdir (dir);
+}
+
+static void
+write_results (FILE *out, const BookScale& scale, const std::vector<BenchResult>& results)
+{
+    fprintf (out, "{\n  \"context\": {\n");
+    fprintf (out, "    \"executable\": \"benchmark-engine\",\n");
+    fprintf (out, "    \"accounts\": %d,\n    \"transactions\": %d,\n", scale.accounts, scale.transactions);
+    fprintf (out, "    \"prices\": %d,\n    \"commodities\": %d,\n", scale.prices, scale.commodities);
+    fprintf (out, "    \"seed\": %u\n  },\n  \"benchmarks\": [", scale.seed);
+    const char *sep = "";
+    for (const auto& result : results)
+    {
+        fprintf (out, "%s\n    {\"name\": \"%s\", \"iterations\": %d, "
+                 "\"real_time\": %.1f, \"time_unit\": \"ns\"}",
+                 sep, result.name.c_str(), result.iterations, result.ns_per_iteration);
+        sep = ",";
+    }
+    fprintf (out, "\n  ]\n}\n");
+}
+
+static void
+usage (const char *prog)
+{
+    fprintf (stderr, "Usage: %s [--accounts N] [--transactions N] [--prices N] "
+             "[--commodities N] [--seed N] [--output FILE]\n", prog);
+    exit (1);
+}
+
+int
+main (int argc, char **argv)
+{
+    BookScale scale;
+    const char *output = nullptr;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (i + 1 >= argc)
+            usage (argv[0]);
+        auto value = argv[++i];
+        if (!strcmp (argv[i - 1], "--accounts"))
+            scale.accounts = atoi (value);
+        else if (!strcmp (argv[i - 1], "--transactions"))
+            scale.transactions = atoi (value);
+        else if (!strcmp (argv[i - 1], "--prices"))
+            scale.prices = atoi (value);
+        else if (!strcmp (argv[i - 1], "--commodities"))
+            scale.commodities = atoi (value);
+        else if (!strcmp (argv[i - 1], "--seed"))
+            scale.seed = strtoul (value, nullptr, 10);
+        else if (!strcmp (argv[i - 1], "--output"))
+            output = value;
+        else
+            usage (argv[0]);
+    }
+
+    qof_init ();
+    if (!cashobjects_register ())
+    {
+        fprintf (stderr, "Can't register the engine objects.\n");
+        return 1;
+    }
+    xaccLogDisable ();
+
+    std::vector<BenchResult> results;
+    BenchBook bb;
+    results.push_back (run_benchmark ("generate book", 1,
+                                      [&](int) { bb = generate_book (scale); }));
+
+    std::mt19937 gen{scale.seed};
+    auto uniform = [&gen](int lo, int hi)
+        { return std::uniform_int_distribution<int>{lo, hi}(gen); };
+
+    if (!bb.leaves.empty())
+    {
+        results.push_back (run_benchmark ("recompute balances", 10, [&](int)
+            {
+                for (auto acc : bb.leaves)
+                    xaccAccountRecomputeBalance (acc);
+            }));
+
+        results.push_back (run_benchmark ("query splits by account and date", 100, [&](int)
+            {
+                auto query = qof_query_create_for (GNC_ID_SPLIT);
+                qof_query_set_book (query, bb.book);
+                xaccQueryAddSingleAccountMatch (query, bb.leaves[uniform (0, bb.leaves.size() - 1)],
+                                                QOF_QUERY_AND);
+                auto from = start_date + uniform (0, date_range / 2);
+                xaccQueryAddDateMatchTT (query, TRUE, from, TRUE, from + date_range / 4,
+                                         QOF_QUERY_AND);
+                qof_query_run (query);
+                qof_query_destroy (query);
+            }));
+    }
+
+    if (!bb.commodities.empty())
+    {
+        auto pdb = gnc_pricedb_get_db (bb.book);
+        results.push_back (run_benchmark ("price lookup nearest in time", 10000, [&](int)
+            {
+                auto comm = bb.commodities[uniform (0, bb.commodities.size() - 1)];
+                auto price = gnc_pricedb_lookup_nearest_in_time64
+                    (pdb, comm, bb.currency, start_date + uniform (0, date_range));
+                gnc_price_unref (price);
+            }));
+    }
+
+    if (!bb.transactions.empty())
+    {
+        /* Train the map of one account on the descriptions of its
+         * transactions, as the importer would, then match random ones. */
+        auto imap = gnc_account_imap_create_imap (bb.leaves.front());
+        auto n_train = std::min<int> (bb.transactions.size(), 10000);
+        results.push_back (run_benchmark ("bayes train", n_train, [&](int i)
+            {
+                auto trans = bb.transactions[i];
+                auto tokens = description_tokens (trans);
+                gnc_account_imap_add_account_bayes
+                    (imap, tokens, xaccSplitGetAccount (xaccTransGetSplit (trans, 1)));
+                g_list_free_full (tokens, g_free);
+            }));
+        results.push_back (run_benchmark ("bayes match", 1000, [&](int)
+            {
+                auto trans = bb.transactions[uniform (0, bb.transactions.size() - 1)];
+                auto tokens = description_tokens (trans);
+                gnc_account_imap_find_account_bayes (imap, tokens);
+                g_list_free_full (tokens, g_free);
+            }));
+        g_free (imap);
+
+        results.push_back (run_benchmark ("scrub imbalance", 1, [&](int)
+            {
+                xaccAccountTreeScrubImbalance (bb.root, [](const char*, double) {});
+            }));
+    }
+
+    /* The session takes the book over, so this runs last. */
+    auto session = qof_session_new (bb.book);
+    auto tmp_dir = g_dir_make_tmp ("benchmark-engine-XXXXXX", nullptr);
+    if (tmp_dir)
+    {
+        if (qof_load_backend_library ("", "gncmod-backend-xml"))
+            run_backend_benchmarks (session, "xml",
+                                    std::string (tmp_dir) + "/book.gnucash", results);
+        else
+            fprintf (stderr, "Can't load the XML backend, skipping it.\n");
+#ifdef HAVE_DBI_DBI_H
+        if (qof_load_backend_library ("", "gncmod-backend-dbi"))
+            run_backend_benchmarks (session, "sqlite3",
+                                    std::string (tmp_dir) + "/book.sqlite", results);
+        else
+            fprintf (stderr, "Can't load the DBI backend, skipping SQLite.\n");
+#endif
+        remove_tmp_dir (tmp_dir);
+        g_free (tmp_dir);
+    }
+
+    auto out = output ? fopen (output, "w") : stdout;
+    if (!out)
+    {
+        fprintf (stderr, "Can't open %s for writing.\n", output);
+        return 1;
+    }
+    write_results (out, scale, results);
+    if (out != stdout)
+        fclose (out);
+
+    qof_session_destroy (session);
+    qof_close ();
+    return 0;
+}
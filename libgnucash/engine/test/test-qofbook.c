@@ -292,6 +292,19 @@ test_book_session_not_saved( Fixture *fixture, gconstpointer pData )
     g_assert( qof_book_session_not_saved( fixture->book ) );
 }
 
+static void
+test_book_change_generation( Fixture *fixture, gconstpointer pData )
+{
+    gint64 generation = qof_book_get_change_generation( fixture->book );
+
+    qof_book_mark_session_dirty( fixture-> book );
+    qof_book_mark_session_dirty( fixture-> book );
+    g_assert_cmpint( qof_book_get_change_generation( fixture->book ), ==, generation + 2 );
+    qof_book_mark_session_saved( fixture->book );
+    g_assert_cmpint( qof_book_get_change_generation( fixture->book ), ==, generation + 2 );
+    g_assert_cmpint( qof_book_get_change_generation( NULL ), ==, 0 );
+}
+
 static void
 test_book_mark_session_saved( Fixture *fixture, gconstpointer pData )
 {
@@ -926,6 +939,7 @@ test_suite_qofbook ( void )
     GNC_TEST_ADD( suitename, "get string option", Fixture, NULL, setup, test_book_get_string_option, teardown );
     GNC_TEST_ADD( suitename, "set string option", Fixture, NULL, setup, test_book_set_string_option, teardown );
     GNC_TEST_ADD( suitename, "session not saved", Fixture, NULL, setup, test_book_session_not_saved, teardown );
+    GNC_TEST_ADD( suitename, "change generation", Fixture, NULL, setup, test_book_change_generation, teardown );
     GNC_TEST_ADD( suitename, "session mark saved", Fixture, NULL, setup, test_book_mark_session_saved, teardown );
     GNC_TEST_ADD( suitename, "get counter", Fixture, NULL, setup, test_book_get_counter, teardown );
     GNC_TEST_ADD( suitename, "get counter format", Fixture, NULL, setup, test_book_get_counter_format, teardown );
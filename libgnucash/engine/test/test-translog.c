@@ -0,0 +1,281 @@
+/********************************************************************\
+ * test-translog.c: GLib g_test test suite for TransLog.c.          *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+#include <config.h>
+#include <string.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <unittest-support.h>
+#include "qof.h"
+#include "Account.h"
+#include "Transaction.h"
+#include "TransLog.h"
+
+static const gchar *suitename = "/engine/TransLog";
+void test_suite_translog (void);
+
+typedef struct
+{
+    QofBook *book;
+    GList *transactions;
+    gchar *dir;
+} Fixture;
+
+static void
+setup (Fixture *fixture, gconstpointer pData)
+{
+    gnc_commodity *curr;
+    Account *bank, *expense;
+    int i;
+
+    fixture->book = qof_book_new ();
+    fixture->transactions = NULL;
+    fixture->dir = g_dir_make_tmp ("translog-XXXXXX", NULL);
+    g_assert (fixture->dir != NULL);
+
+    curr = gnc_commodity_new (fixture->book, "Gnu Rand", "CURRENCY", "GNR",
+                              "", 100);
+    bank = xaccMallocAccount (fixture->book);
+    expense = xaccMallocAccount (fixture->book);
+    xaccAccountSetName (bank, "Bank");
+    xaccAccountSetName (expense, "Groceries");
+    xaccAccountSetCommodity (bank, curr);
+    xaccAccountSetCommodity (expense, curr);
+
+    for (i = 1; i <= 3; i++)
+    {
+        Transaction *txn = xaccMallocTransaction (fixture->book);
+        Split *from = xaccMallocSplit (fixture->book);
+        Split *to = xaccMallocSplit (fixture->book);
+        gnc_numeric amount = gnc_numeric_create (1234 * i, 100);
+        gchar *num = g_strdup_printf ("%d", i);
+
+        xaccTransBeginEdit (txn);
+        xaccTransSetCurrency (txn, curr);
+        xaccTransSetDatePostedSecs (txn, 1500000000 + i * 86400);
+        xaccTransSetNum (txn, num);
+        xaccTransSetDescription (txn, "Shopping");
+        if (i == 2)
+            xaccTransSetNotes (txn, "With notes");
+        xaccSplitSetParent (from, txn);
+        xaccSplitSetParent (to, txn);
+        xaccSplitSetAccount (from, bank);
+        xaccSplitSetAccount (to, expense);
+        xaccSplitSetMemo (to, "Bread");
+        xaccSplitSetAction (from, "Debit card");
+        xaccSplitSetAmount (from, gnc_numeric_neg (amount));
+        xaccSplitSetValue (from, gnc_numeric_neg (amount));
+        xaccSplitSetAmount (to, amount);
+        xaccSplitSetValue (to, amount);
+        xaccSplitSetReconcile (from, YREC);
+        xaccSplitSetDateReconciledSecs (from, 1500000000 + i * 86400);
+        xaccTransCommitEdit (txn);
+        g_free (num);
+
+        fixture->transactions = g_list_append (fixture->transactions, txn);
+    }
+}
+
+static void
+teardown (Fixture *fixture, gconstpointer pData)
+{
+    GDir *dir = g_dir_open (fixture->dir, 0, NULL);
+    const gchar *name;
+
+    while ((name = g_dir_read_name (dir)))
+    {
+        gchar *path = g_build_filename (fixture->dir, name, NULL);
+        g_remove (path);
+        g_free (path);
+    }
+    g_dir_close (dir);
+    g_rmdir (fixture->dir);
+    g_free (fixture->dir);
+    g_list_free (fixture->transactions);
+    qof_book_destroy (fixture->book);
+}
+
+/* Write the fixture's transactions to a new log and return its path. */
+static gchar *
+write_log (Fixture *fixture, const gchar *base, gboolean binary)
+{
+    gchar *basepath = g_build_filename (fixture->dir, base, NULL);
+    GDir *dir;
+    const gchar *name;
+    gchar *path = NULL;
+    GList *node;
+
+    xaccLogEnable ();
+    xaccLogSetBinary (binary);
+    xaccLogSetBaseName (basepath);
+    xaccOpenLog ();
+    for (node = fixture->transactions; node; node = node->next)
+        xaccTransWriteLog (node->data, 'C');
+    xaccCloseLog ();
+    xaccLogSetBinary (FALSE);
+    xaccLogDisable ();
+    g_free (basepath);
+
+    dir = g_dir_open (fixture->dir, 0, NULL);
+    while ((name = g_dir_read_name (dir)))
+        if (g_str_has_prefix (name, base))
+            path = g_build_filename (fixture->dir, name, NULL);
+    g_dir_close (dir);
+    g_assert (path != NULL);
+    return path;
+}
+
+/* Convert the binary log at path and return the text. */
+static gchar *
+convert_log (const gchar *path, gboolean expect_ok)
+{
+    FILE *in = g_fopen (path, "rb");
+    FILE *out = tmpfile ();
+    long len;
+    gchar *text;
+
+    g_assert (in && out);
+    g_assert_cmpint (xaccLogConvertToText (in, out), ==, expect_ok);
+    len = ftell (out);
+    rewind (out);
+    text = g_malloc0 (len + 1);
+    g_assert_cmpint (fread (text, 1, len, out), ==, len);
+    fclose (in);
+    fclose (out);
+    return text;
+}
+
+/* Blank the time_now field, the time the record was written. */
+static gchar *
+mask_time_now (const gchar *log)
+{
+    gchar **lines = g_strsplit (log, "\n", -1);
+    gchar **line;
+    gchar *result;
+
+    for (line = lines; *line; line++)
+    {
+        gchar **fields = g_strsplit (*line, "\t", -1);
+        if (g_strv_length (fields) > 3)
+        {
+            g_free (fields[3]);
+            fields[3] = g_strdup ("");
+            g_free (*line);
+            *line = g_strjoinv ("\t", fields);
+        }
+        g_strfreev (fields);
+    }
+    result = g_strjoinv ("\n", lines);
+    g_strfreev (lines);
+    return result;
+}
+
+static void
+test_binary_round_trip (Fixture *fixture, gconstpointer pData)
+{
+    gchar *text_path = write_log (fixture, "text", FALSE);
+    gchar *binary_path = write_log (fixture, "binary", TRUE);
+    gchar *text, *converted, *expected, *actual;
+
+    g_assert (g_file_get_contents (text_path, &text, NULL, NULL));
+    converted = convert_log (binary_path, TRUE);
+    expected = mask_time_now (text);
+    actual = mask_time_now (converted);
+    g_assert_cmpstr (actual, ==, expected);
+    g_assert (strstr (converted, "With notes") != NULL);
+
+    g_free (expected);
+    g_free (actual);
+    g_free (converted);
+    g_free (text);
+    g_free (binary_path);
+    g_free (text_path);
+}
+
+static void
+test_binary_truncated (Fixture *fixture, gconstpointer pData)
+{
+    gchar *binary_path = write_log (fixture, "binary", TRUE);
+    gchar *cut_path = g_build_filename (fixture->dir, "cut.log", NULL);
+    gchar *contents, *full, *converted, *last;
+    gsize len;
+    gchar *msg = "[xaccLogConvertToText()] Ignoring a truncated record at the end of the log";
+    GLogLevelFlags loglevel = G_LOG_LEVEL_WARNING;
+    TestErrorStruct check = { loglevel, "gnc.translog", msg, 0 };
+    GLogFunc oldlogger;
+
+    /* A crash while writing the last record. */
+    g_assert (g_file_get_contents (binary_path, &contents, &len, NULL));
+    g_assert (g_file_set_contents (cut_path, contents, len - 5, NULL));
+    full = convert_log (binary_path, TRUE);
+
+    oldlogger = g_log_set_default_handler ((GLogFunc)test_null_handler, &check);
+    g_test_log_set_fatal_handler ((GTestLogFatalFunc)test_checked_handler, &check);
+    converted = convert_log (cut_path, TRUE);
+    g_log_set_default_handler (oldlogger, NULL);
+    g_test_log_set_fatal_handler (NULL, NULL);
+    g_assert_cmpint (check.hits, ==, 1);
+
+    /* Everything but the last record survives. */
+    last = g_strrstr (full, "===== START\n");
+    g_assert (last != NULL);
+    *last = '\0';
+    g_assert_cmpstr (converted, ==, full);
+
+    g_free (converted);
+    g_free (full);
+    g_free (contents);
+    g_free (cut_path);
+    g_free (binary_path);
+}
+
+static void
+test_convert_text_log (Fixture *fixture, gconstpointer pData)
+{
+    gchar *text_path = write_log (fixture, "text", FALSE);
+    gchar *converted;
+    gchar *msg = "[xaccLogConvertToText()] Not a binary transaction log";
+    GLogLevelFlags loglevel = G_LOG_LEVEL_CRITICAL;
+    TestErrorStruct check = { loglevel, "gnc.translog", msg, 0 };
+    GLogFunc oldlogger;
+
+    oldlogger = g_log_set_default_handler ((GLogFunc)test_null_handler, &check);
+    g_test_log_set_fatal_handler ((GTestLogFatalFunc)test_checked_handler, &check);
+    converted = convert_log (text_path, FALSE);
+    g_log_set_default_handler (oldlogger, NULL);
+    g_test_log_set_fatal_handler (NULL, NULL);
+    g_assert_cmpint (check.hits, ==, 1);
+    g_assert_cmpstr (converted, ==, "");
+
+    g_free (converted);
+    g_free (text_path);
+}
+
+void
+test_suite_translog (void)
+{
+    GNC_TEST_ADD (suitename, "binary round trip", Fixture, NULL, setup,
+                  test_binary_round_trip, teardown);
+    GNC_TEST_ADD (suitename, "binary truncated", Fixture, NULL, setup,
+                  test_binary_truncated, teardown);
+    GNC_TEST_ADD (suitename, "convert text log", Fixture, NULL, setup,
+                  test_convert_text_log, teardown);
+}
@@ -25,6 +25,7 @@
 #include <unittest-support.h>
 #include <gnc-event.h>
 /* Add specific headers for this class */
+#include <qofinstance-p.h>
 #include "gnc-budget.h"
 
 static const gchar *suitename = "/engine/Budget";
@@ -156,6 +157,70 @@ test_gnc_set_budget_account_period_value()
     qof_book_destroy(book);
 }
 
+static void
+test_gnc_unset_budget_account_period_value()
+{
+    QofBook *book = qof_book_new();
+    GncBudget* budget = gnc_budget_new(book);
+    Account *acc = gnc_account_create_root(book);
+    gnc_numeric val;
+
+    gnc_budget_set_account_period_value(budget, acc, 3, gnc_numeric_create(50,1));
+    gnc_budget_set_account_period_value(budget, acc, 4, gnc_numeric_create(60,1));
+    gnc_budget_unset_account_period_value(budget, acc, 3);
+    g_assert(!gnc_budget_is_account_period_value_set(budget, acc, 3));
+    val = gnc_budget_get_account_period_value(budget, acc, 3);
+    g_assert (gnc_numeric_zero_p (val));
+    g_assert(gnc_budget_is_account_period_value_set(budget, acc, 4));
+
+    /* Changing the number of periods keeps the amounts of the periods
+     * that still exist. */
+    gnc_budget_set_num_periods(budget, 24);
+    g_assert(gnc_budget_is_account_period_value_set(budget, acc, 4));
+    gnc_budget_set_account_period_value(budget, acc, 20, gnc_numeric_create(70,1));
+    val = gnc_budget_get_account_period_value(budget, acc, 20);
+    g_assert (gnc_numeric_equal (val, gnc_numeric_create (70, 1)));
+    val = gnc_budget_get_account_period_value(budget, acc, 4);
+    g_assert (gnc_numeric_equal (val, gnc_numeric_create (60, 1)));
+
+    gnc_budget_destroy(budget);
+    qof_book_destroy(book);
+}
+
+static void
+test_gnc_budget_account_period_value_from_kvp()
+{
+    QofBook *book = qof_book_new();
+    GncBudget* budget = gnc_budget_new(book);
+    Account *acc = gnc_account_create_root(book);
+    gchar guid_str[GUID_ENCODING_LENGTH + 1];
+    gnc_numeric amount = gnc_numeric_create (80, 1);
+    GValue v = G_VALUE_INIT;
+    gnc_numeric val;
+
+    gnc_budget_set_account_period_value(budget, acc, 2, gnc_numeric_create(50,1));
+    g_assert(!gnc_budget_is_account_period_value_set(budget, acc, 5));
+
+    /* Backends write the amounts into the KVP directly; they're seen once
+     * the budget's edit is committed. */
+    guid_to_string_buff (xaccAccountGetGUID (acc), guid_str);
+    g_value_init (&v, GNC_TYPE_NUMERIC);
+    g_value_set_boxed (&v, &amount);
+    gnc_budget_begin_edit(budget);
+    qof_instance_set_kvp (QOF_INSTANCE (budget), &v, 2, guid_str, "5");
+    qof_instance_set_kvp (QOF_INSTANCE (budget), NULL, 2, guid_str, "2");
+    gnc_budget_commit_edit(budget);
+    g_value_unset (&v);
+
+    g_assert(gnc_budget_is_account_period_value_set(budget, acc, 5));
+    val = gnc_budget_get_account_period_value(budget, acc, 5);
+    g_assert (gnc_numeric_equal (val, amount));
+    g_assert(!gnc_budget_is_account_period_value_set(budget, acc, 2));
+
+    gnc_budget_destroy(budget);
+    qof_book_destroy(book);
+}
+
 void
 test_suite_budget(void)
 {
@@ -165,5 +230,7 @@ test_suite_budget(void)
     GNC_TEST_ADD_FUNC(suitename, "gnc_budget_set_num_periods()", test_gnc_set_budget_num_periods);
     GNC_TEST_ADD_FUNC(suitename, "gnc_budget_set_recurrence()", test_gnc_set_budget_recurrence);
     GNC_TEST_ADD_FUNC(suitename, "gnc_budget_set_account_period_value()", test_gnc_set_budget_account_period_value);
+    GNC_TEST_ADD_FUNC(suitename, "gnc_budget_unset_account_period_value()", test_gnc_unset_budget_account_period_value);
+    GNC_TEST_ADD_FUNC(suitename, "gnc_budget_get_account_period_value() from KVP", test_gnc_budget_account_period_value_from_kvp);
 
 }